@@ -54,6 +54,10 @@ void GaggiMateController::setup() {
 
     String systemInfo = make_system_info(_config, _version);
     _ble.initServer(systemInfo);
+    if (_config.capabilites.pressure) {
+        // Sample at the 30ms control rate, set before the pump task starts. sendSensorData() ships the buffered cycles.
+        static_cast<DimmedPump *>(pump)->setCycleCallback([this]() { captureSensorSample(); });
+    }
 
     if (_config.capabilites.ledControls) {
         this->ledController->setup();
@@ -199,13 +203,23 @@ void GaggiMateController::thermalRunawayShutdown() {
     _ble.sendError(ERROR_CODE_RUNAWAY);
 }
 
-void GaggiMateController::sendSensorData() {
+void GaggiMateController::captureSensorSample() {
     if (_config.capabilites.pressure) {
         auto dimmedPump = static_cast<DimmedPump *>(pump);
-        _ble.sendSensorData(this->thermocouple->read(), this->pressureSensor->getPressure(), dimmedPump->getPuckFlow(),
-                            dimmedPump->getPumpFlow(), dimmedPump->getPuckResistance());
-        _ble.sendVolumetricMeasurement(dimmedPump->getCoffeeVolume());
+        _ble.queueSensorSample(this->thermocouple->read(), this->pressureSensor->getPressure(), dimmedPump->getPuckFlow(),
+                               dimmedPump->getPumpFlow(), dimmedPump->getPuckResistance());
     } else {
-        _ble.sendSensorData(this->thermocouple->read(), 0.0f, 0.0f, 0.0f, 0.0f);
+        _ble.queueSensorSample(this->thermocouple->read(), 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+void GaggiMateController::sendSensorData() {
+    if (!_config.capabilites.pressure) {
+        // Nothing runs faster than this loop without a pump controller
+        captureSensorSample();
+    }
+    _ble.flushSensorSamples();
+    if (_config.capabilites.pressure) {
+        _ble.sendVolumetricMeasurement(static_cast<DimmedPump *>(pump)->getCoffeeVolume());
     }
 }
@@ -33,6 +33,7 @@ class GaggiMateController {
     void thermalRunawayShutdown(void);
     void startPidAutotune(void);
     void stopPidAutotune(void);
+    void captureSensorSample(void);
     void sendSensorData(void);
 
     ControllerConfig _config = ControllerConfig{};
@@ -21,6 +21,9 @@ void DimmedPump::loop() {
     updatePower();
     // _currentFlow = 0.1f * _pressureController.getPumpFlowRate() + 0.9f * _currentFlow;
     _currentFlow = _pressureController.getPumpFlowRate();
+    if (_cycleCallback) {
+        _cycleCallback();
+    }
 }
 
 void DimmedPump::setPower(float setpoint) {
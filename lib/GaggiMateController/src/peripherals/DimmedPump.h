@@ -5,6 +5,9 @@
 #include "PressureSensor.h"
 #include "Pump.h"
 #include <Arduino.h>
+#include <functional>
+
+using pump_cycle_callback_t = std::function<void()>;
 
 class DimmedPump : public Pump {
   public:
@@ -30,6 +33,8 @@ class DimmedPump : public Pump {
     void stop();
     void fullPower();
     void setValveState(bool open);
+    // Runs on the pump task after every control cycle, keep it short
+    void setCycleCallback(const pump_cycle_callback_t &callback) { _cycleCallback = callback; }
 
   private:
     uint8_t _ssr_pin;
@@ -51,6 +56,7 @@ class DimmedPump : public Pump {
     int _cps = MAX_FREQ;
 
     float _opvPressure = 0.0f;
+    pump_cycle_callback_t _cycleCallback;
 
     static constexpr float BASE_FLOW_RATE = 0.25f;
     static constexpr float MAX_PRESSURE = 15.0f;
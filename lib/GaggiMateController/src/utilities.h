@@ -3,6 +3,9 @@
 #include "ControllerConfig.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <ClockSync.h>
+#include <ControlFrame.h>
+#include <SensorFrame.h>
 
 inline String make_system_info(ControllerConfig config, String version) {
     JsonDocument doc;
@@ -13,6 +16,10 @@ inline String make_system_info(ControllerConfig config, String version) {
     capabilities["dm"] = config.capabilites.dimming;
     capabilities["led"] = config.capabilites.ledControls;
     capabilities["tof"] = config.capabilites.tof;
+    capabilities["sf"] = SENSOR_FRAME_VERSION;
+    capabilities["sb"] = SENSOR_BATCH_VERSION;
+    capabilities["cf"] = CONTROL_FRAME_VERSION;
+    capabilities["cs"] = CLOCK_SYNC_VERSION;
     doc["cp"] = capabilities;
     return doc.as<String>();
 }
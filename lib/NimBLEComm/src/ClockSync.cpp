@@ -0,0 +1,167 @@
+#include "ClockSync.h"
+
+#include "FixedPoint.h"
+
+#include <cmath>
+
+using namespace fixed_point;
+
+namespace {
+constexpr float MAX_DRIFT = 500e-6f;     // far beyond any crystal, larger fits come from outliers
+constexpr float MEAN_RTT_WEIGHT = 0.125f; // like the RTT average of TCP
+constexpr uint16_t RTT_TOLERANCE_MS = 2;  // exchanges this close to the fastest one are as good as it
+constexpr size_t MIN_DRIFT_EXCHANGES = 4; // a line through fewer is mostly noise
+constexpr uint32_t MIN_DRIFT_SPAN_MS = 20000;
+constexpr uint32_t ANCHOR_SPAN_MS = 120000; // drift is measured against the anchor from here on
+
+uint16_t clampRtt(int32_t rtt) { return rtt < 0 ? 0 : rtt > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(rtt); }
+} // namespace
+
+size_t encodeClockSyncRequest(const ClockSyncRequest &request, uint8_t *buffer, size_t size) {
+    if (size < CLOCK_SYNC_REQUEST_SIZE) {
+        return 0;
+    }
+    buffer[0] = CLOCK_SYNC_VERSION;
+    putU16(buffer + 1, request.sequence);
+    putU32(buffer + 3, request.sent);
+    return CLOCK_SYNC_REQUEST_SIZE;
+}
+
+bool decodeClockSyncRequest(const uint8_t *data, size_t length, ClockSyncRequest &request) {
+    if (data == nullptr || length < CLOCK_SYNC_REQUEST_SIZE || data[0] != CLOCK_SYNC_VERSION) {
+        return false;
+    }
+    request.sequence = getU16(data + 1);
+    request.sent = getU32(data + 3);
+    return true;
+}
+
+size_t encodeClockSyncReply(const ClockSyncReply &reply, uint8_t *buffer, size_t size) {
+    if (size < CLOCK_SYNC_REPLY_SIZE) {
+        return 0;
+    }
+    buffer[0] = CLOCK_SYNC_VERSION;
+    putU16(buffer + 1, reply.sequence);
+    putU32(buffer + 3, reply.sent);
+    putU32(buffer + 7, reply.received);
+    putU32(buffer + 11, reply.replied);
+    return CLOCK_SYNC_REPLY_SIZE;
+}
+
+bool decodeClockSyncReply(const uint8_t *data, size_t length, ClockSyncReply &reply) {
+    if (data == nullptr || length < CLOCK_SYNC_REPLY_SIZE || data[0] != CLOCK_SYNC_VERSION) {
+        return false;
+    }
+    reply.sequence = getU16(data + 1);
+    reply.sent = getU32(data + 3);
+    reply.received = getU32(data + 7);
+    reply.replied = getU32(data + 11);
+    return true;
+}
+
+void ClockSync::reset() {
+    count = 0;
+    next = 0;
+    baseOffset = 0;
+    reference = 0;
+    intercept = 0.0f;
+    slope = 0.0f;
+    meanRtt = 0.0f;
+    anchored = false;
+    stats = ClockSyncStats{};
+}
+
+void ClockSync::addExchange(uint32_t sent, uint32_t received, uint32_t replied, uint32_t arrived) {
+    // Everything modulo 2^32 so either clock may wrap. The offset is the mean of the two one-way differences, written
+    // so the sum cannot overflow.
+    const uint32_t outbound = received - sent;
+    const uint32_t inbound = replied - arrived;
+    const int32_t rtt = static_cast<int32_t>(arrived - sent) - static_cast<int32_t>(replied - received);
+
+    Exchange &exchange = exchanges[next];
+    exchange.at = sent + (arrived - sent) / 2;
+    exchange.offset = outbound + static_cast<int32_t>(inbound - outbound) / 2;
+    exchange.rtt = clampRtt(rtt);
+    next = (next + 1) % CLOCK_SYNC_WINDOW;
+    count = count < CLOCK_SYNC_WINDOW ? count + 1 : count;
+
+    meanRtt = stats.exchanges == 0 ? exchange.rtt : meanRtt + MEAN_RTT_WEIGHT * (exchange.rtt - meanRtt);
+    stats.exchanges++;
+    stats.rttMs = exchange.rtt;
+    stats.meanRttMs = static_cast<uint16_t>(std::lround(meanRtt));
+    fit();
+    stats.offsetMs = static_cast<int32_t>(toRemote(arrived) - arrived);
+    stats.driftPpm = slope * 1e6f;
+}
+
+void ClockSync::fit() {
+    const Exchange *fastest = &exchanges[0];
+    stats.minRttMs = UINT16_MAX;
+    stats.maxRttMs = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (exchanges[i].rtt < fastest->rtt) {
+            fastest = &exchanges[i];
+        }
+        stats.minRttMs = exchanges[i].rtt < stats.minRttMs ? exchanges[i].rtt : stats.minRttMs;
+        stats.maxRttMs = exchanges[i].rtt > stats.maxRttMs ? exchanges[i].rtt : stats.maxRttMs;
+    }
+    baseOffset = fastest->offset;
+    reference = exchanges[(next + CLOCK_SYNC_WINDOW - 1) % CLOCK_SYNC_WINDOW].at;
+    stats.oneWayMs = fastest->rtt / 2;
+
+    // Longer round trips mostly mean one direction waited for a connection event, leave those out
+    auto usable = [&](const Exchange &exchange) { return exchange.rtt <= fastest->rtt + RTT_TOLERANCE_MS; };
+    float sumX = 0.0f, sumY = 0.0f;
+    int32_t first = 0, last = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!usable(exchanges[i])) {
+            continue;
+        }
+        auto x = static_cast<int32_t>(exchanges[i].at - reference);
+        first = used == 0 || x < first ? x : first;
+        last = used == 0 || x > last ? x : last;
+        sumX += x;
+        sumY += static_cast<int32_t>(exchanges[i].offset - baseOffset);
+        used++;
+    }
+    const float meanX = sumX / used;
+    const float meanY = sumY / used;
+
+    // Drift comes from a line through the window at first. Once the fastest exchange of the first full window is old
+    // enough, how far the offset moved since then is far less noisy. That averages drift over the whole connection,
+    // which is fine since the offset itself is still fitted to the window.
+    if (count == CLOCK_SYNC_WINDOW && !anchored) {
+        anchor = *fastest;
+        anchored = true;
+    }
+    slope = 0.0f;
+    if (anchored && fastest->at - anchor.at >= ANCHOR_SPAN_MS) {
+        slope = static_cast<float>(static_cast<int32_t>(fastest->offset - anchor.offset)) / (fastest->at - anchor.at);
+    } else if (used >= MIN_DRIFT_EXCHANGES && static_cast<uint32_t>(last - first) >= MIN_DRIFT_SPAN_MS) {
+        float sxy = 0.0f, sxx = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            if (!usable(exchanges[i])) {
+                continue;
+            }
+            float dx = static_cast<int32_t>(exchanges[i].at - reference) - meanX;
+            sxy += dx * (static_cast<int32_t>(exchanges[i].offset - baseOffset) - meanY);
+            sxx += dx * dx;
+        }
+        slope = sxy / sxx;
+    }
+    slope = std::fmax(-MAX_DRIFT, std::fmin(MAX_DRIFT, slope));
+    intercept = meanY - slope * meanX;
+}
+
+float ClockSync::correction(uint32_t local) const { return intercept + slope * static_cast<int32_t>(local - reference); }
+
+uint32_t ClockSync::toRemote(uint32_t local) const {
+    return local + baseOffset + static_cast<int32_t>(std::lround(correction(local)));
+}
+
+uint32_t ClockSync::toLocal(uint32_t remote) const {
+    // The correction barely moves within the offset, evaluating it at the uncorrected guess is close enough
+    const uint32_t guess = remote - baseOffset;
+    return guess - static_cast<int32_t>(std::lround(correction(guess)));
+}
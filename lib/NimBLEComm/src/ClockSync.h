@@ -0,0 +1,93 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <cstddef>
+#include <cstdint>
+
+// NTP-style exchange on PING_CHAR_UUID, announced as "cs" in the controller's info capabilities. The display writes a
+// request, which also counts as a ping, and the controller answers with a notification on the same characteristic.
+// Little endian:
+//
+//   request             reply
+//   0  u8   version     0  u8   version
+//   1  u16  sequence    1  u16  sequence of the request
+//   3  u32  sent        3  u32  sent, echoed
+//                       7  u32  controller millis() when the request arrived
+//                       11 u32  controller millis() when the reply went out
+//
+// Plain pings are a single ASCII byte and never decode as a request.
+constexpr uint8_t CLOCK_SYNC_VERSION = 1;
+constexpr size_t CLOCK_SYNC_REQUEST_SIZE = 7;
+constexpr size_t CLOCK_SYNC_REPLY_SIZE = 15;
+
+constexpr unsigned long CLOCK_SYNC_INTERVAL_MS = 4000;
+constexpr size_t CLOCK_SYNC_WINDOW = 16; // exchanges the offset is fitted to, about a minute
+
+struct ClockSyncRequest {
+    uint16_t sequence;
+    uint32_t sent;
+};
+
+struct ClockSyncReply {
+    uint16_t sequence;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t replied;
+};
+
+size_t encodeClockSyncRequest(const ClockSyncRequest &request, uint8_t *buffer, size_t size);
+bool decodeClockSyncRequest(const uint8_t *data, size_t length, ClockSyncRequest &request);
+size_t encodeClockSyncReply(const ClockSyncReply &reply, uint8_t *buffer, size_t size);
+bool decodeClockSyncReply(const uint8_t *data, size_t length, ClockSyncReply &reply);
+
+// Link timing as seen by the display. Round trips exclude the time the controller took to answer, one-way latency
+// assumes both directions take equally long.
+struct ClockSyncStats {
+    int32_t offsetMs;   // controller millis() minus ours, right now
+    float driftPpm;     // how much faster the controller clock runs
+    uint32_t exchanges; // replies received since the connection started
+    uint16_t rttMs;     // last round trip
+    uint16_t minRttMs;  // over the window
+    uint16_t maxRttMs;  // over the window
+    uint16_t meanRttMs; // moving average
+    uint16_t oneWayMs;  // half the round trip of the exchange the offset is based on
+};
+
+// Offset and drift between our millis() and the controller's, fitted through the exchanges with the shortest round
+// trips of the last CLOCK_SYNC_WINDOW. Drift is refined against an older exchange once the link has been up for a few
+// minutes. Not thread safe, feed and query it from one task.
+class ClockSync {
+  public:
+    void reset();
+    // sent and arrived are our clock, received and replied the controller's
+    void addExchange(uint32_t sent, uint32_t received, uint32_t replied, uint32_t arrived);
+
+    bool isSynced() const { return count > 0; }
+    uint32_t toLocal(uint32_t remote) const;
+    uint32_t toRemote(uint32_t local) const;
+    const ClockSyncStats &getStats() const { return stats; }
+
+  private:
+    struct Exchange {
+        uint32_t at;     // our clock halfway through the round trip
+        uint32_t offset; // controller minus ours, modulo 2^32
+        uint16_t rtt;
+    };
+
+    void fit();
+    float correction(uint32_t local) const;
+
+    Exchange exchanges[CLOCK_SYNC_WINDOW] = {};
+    size_t count = 0;
+    size_t next = 0;
+    uint32_t baseOffset = 0; // offset of the fastest exchange, the fit is relative to it
+    uint32_t reference = 0;  // our clock at the newest exchange
+    float intercept = 0.0f;  // ms on top of baseOffset at reference
+    float slope = 0.0f;      // ms of offset per ms
+    float meanRtt = 0.0f;
+    Exchange anchor{}; // fastest exchange of the first full window
+    bool anchored = false;
+    ClockSyncStats stats{};
+};
+
+#endif // CLOCKSYNC_H
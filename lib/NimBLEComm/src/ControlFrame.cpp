@@ -0,0 +1,43 @@
+#include "ControlFrame.h"
+
+#include "FixedPoint.h"
+
+using namespace fixed_point;
+
+namespace {
+constexpr float TEMPERATURE_SCALE = 100.0f;
+constexpr float POWER_SCALE = 100.0f;
+constexpr float PRESSURE_SCALE = 1000.0f;
+constexpr float FLOW_SCALE = 1000.0f;
+constexpr uint8_t FLAG_VALVE = 0x01;
+} // namespace
+
+size_t encodeControlFrame(const ControlFrame &frame, uint8_t *buffer, size_t size) {
+    if (size < CONTROL_FRAME_SIZE) {
+        return 0;
+    }
+    buffer[0] = CONTROL_FRAME_VERSION;
+    buffer[1] = static_cast<uint8_t>(frame.mode);
+    buffer[2] = frame.valve ? FLAG_VALVE : 0;
+    putU16(buffer + 3, frame.sequence);
+    putU16(buffer + 5, toFixed16(frame.boilerSetpoint, TEMPERATURE_SCALE));
+    putU16(buffer + 7, toFixed16(frame.pumpSetpoint, POWER_SCALE));
+    putU16(buffer + 9, toFixed16(frame.pressure, PRESSURE_SCALE));
+    putU16(buffer + 11, toFixed16(frame.flow, FLOW_SCALE));
+    return CONTROL_FRAME_SIZE;
+}
+
+bool decodeControlFrame(const uint8_t *data, size_t length, ControlFrame &frame) {
+    if (data == nullptr || length < CONTROL_FRAME_SIZE || data[0] != CONTROL_FRAME_VERSION ||
+        data[1] > static_cast<uint8_t>(OutputMode::FLOW)) {
+        return false;
+    }
+    frame.mode = static_cast<OutputMode>(data[1]);
+    frame.valve = (data[2] & FLAG_VALVE) != 0;
+    frame.sequence = getU16(data + 3);
+    frame.boilerSetpoint = fromFixed16(static_cast<int16_t>(getU16(data + 5)), TEMPERATURE_SCALE);
+    frame.pumpSetpoint = fromFixed16(static_cast<int16_t>(getU16(data + 7)), POWER_SCALE);
+    frame.pressure = fromFixed16(static_cast<int16_t>(getU16(data + 9)), PRESSURE_SCALE);
+    frame.flow = fromFixed16(static_cast<int16_t>(getU16(data + 11)), FLOW_SCALE);
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef CONTROLFRAME_H
+#define CONTROLFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary output command on CONTROL_FRAME_UUID, replacing the CSV on OUTPUT_CONTROL_UUID for controllers that announce
+// the version as "cf" in their info capabilities. Little endian:
+//
+//   0  u8   version
+//   1  u8   OutputMode
+//   2  u8   flags, bit 0 opens the valve
+//   3  u16  sequence, bumped for every changed command and skipping 0
+//   5  i16  boiler setpoint in 0.01 °C
+//   7  i16  pump power in 0.01 %, power mode only
+//   9  i16  pressure in 0.001 bar, target or limit
+//   11 i16  flow in 0.001 ml/s, target or limit
+//
+// Repeated commands keep their sequence. The controller echoes the sequence of the last command it applied in its
+// sensor frames and batches.
+constexpr uint8_t CONTROL_FRAME_VERSION = 1;
+constexpr size_t CONTROL_FRAME_SIZE = 13;
+
+enum class OutputMode : uint8_t { POWER = 0, PRESSURE = 1, FLOW = 2 };
+
+struct ControlFrame {
+    uint16_t sequence;
+    OutputMode mode;
+    bool valve;
+    float boilerSetpoint;
+    float pumpSetpoint; // percent
+    float pressure;     // bar
+    float flow;         // ml/s
+};
+
+// Returns the number of bytes written, 0 if the buffer is too small
+size_t encodeControlFrame(const ControlFrame &frame, uint8_t *buffer, size_t size);
+
+// Rejects frames that are too short, of an unknown version or with an unknown mode
+bool decodeControlFrame(const uint8_t *data, size_t length, ControlFrame &frame);
+
+#endif // CONTROLFRAME_H
@@ -0,0 +1,66 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <cmath>
+#include <cstdint>
+
+// Little endian fixed point helpers shared by the binary BLE codecs
+namespace fixed_point {
+constexpr int16_t FIXED16_NAN = INT16_MIN;
+constexpr uint32_t FIXED32_INFINITE = UINT32_MAX;
+
+inline void putU16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+inline void putU32(uint8_t *out, uint32_t value) {
+    putU16(out, value & 0xFFFF);
+    putU16(out + 2, value >> 16);
+}
+
+inline uint16_t getU16(const uint8_t *in) { return in[0] | (in[1] << 8); }
+
+inline uint32_t getU32(const uint8_t *in) { return getU16(in) | (static_cast<uint32_t>(getU16(in + 2)) << 16); }
+
+inline int16_t saturate16(int32_t value) {
+    return value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : static_cast<int16_t>(value);
+}
+
+// NaN maps to the lowest value, everything else saturates above it
+inline int16_t toFixed16(float value, float scale) {
+    if (std::isnan(value)) {
+        return FIXED16_NAN;
+    }
+    float scaled = std::round(value * scale);
+    if (scaled >= INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (scaled <= FIXED16_NAN + 1) {
+        return FIXED16_NAN + 1;
+    }
+    return static_cast<int16_t>(scaled);
+}
+
+inline float fromFixed16(int16_t value, float scale) { return value == FIXED16_NAN ? NAN : value / scale; }
+
+// NaN and values beyond the range map to the highest value, which decodes as infinity
+inline uint32_t toFixedU32(float value, float scale) {
+    if (std::isnan(value)) {
+        return FIXED32_INFINITE;
+    }
+    float scaled = std::round(value * scale);
+    if (scaled <= 0.0f) {
+        return 0;
+    }
+    // UINT32_MAX is not representable as float, the comparison runs against 2^32
+    if (scaled >= static_cast<float>(FIXED32_INFINITE)) {
+        return FIXED32_INFINITE;
+    }
+    return static_cast<uint32_t>(scaled);
+}
+
+inline float fromFixedU32(uint32_t value, float scale) { return value == FIXED32_INFINITE ? INFINITY : value / scale; }
+} // namespace fixed_point
+
+#endif // FIXEDPOINT_H
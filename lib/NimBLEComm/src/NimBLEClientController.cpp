@@ -40,6 +40,12 @@ void NimBLEClientController::registerSteamBtnCallback(const brew_callback_t &cal
 
 void NimBLEClientController::registerSensorCallback(const sensor_read_callback_t &callback) { sensorCallback = callback; }
 
+void NimBLEClientController::registerSensorBatchCallback(const sensor_batch_callback_t &callback) {
+    sensorBatchCallback = callback;
+}
+
+void NimBLEClientController::registerClockSyncCallback(const clock_sync_callback_t &callback) { clockSyncCallback = callback; }
+
 void NimBLEClientController::registerAutotuneResultCallback(const pid_control_callback_t &callback) {
     autotuneResultCallback = callback;
 }
@@ -76,6 +82,7 @@ bool NimBLEClientController::connectToServer() {
 
         delay(500); // Add a small delay to avoid busy-waiting
     }
+    // Short interval for service discovery, owners of the client may relax it once connected
     client->updateConnParams(6, 8, 0, 400);
 
     ESP_LOGI(LOG_TAG, "Successfully connected to BLE server");
@@ -89,9 +96,13 @@ bool NimBLEClientController::connectToServer() {
 
     // Obtain the remote write characteristics
     outputControlChar = pRemoteService->getCharacteristic(NimBLEUUID(OUTPUT_CONTROL_UUID));
+    controlFrameChar = pRemoteService->getCharacteristic(NimBLEUUID(CONTROL_FRAME_UUID));
+    controlFrames = false;
     altControlChar = pRemoteService->getCharacteristic(NimBLEUUID(ALT_CONTROL_CHAR_UUID));
     autotuneChar = pRemoteService->getCharacteristic(NimBLEUUID(AUTOTUNE_CHAR_UUID));
     pingChar = pRemoteService->getCharacteristic(NimBLEUUID(PING_CHAR_UUID));
+    clockSyncEnabled = false;
+    clockSync.reset();
     pidControlChar = pRemoteService->getCharacteristic(NimBLEUUID(PID_CONTROL_CHAR_UUID));
     pumpModelCoeffsChar = pRemoteService->getCharacteristic(NimBLEUUID(PUMP_MODEL_COEFFS_CHAR_UUID));
     infoChar = pRemoteService->getCharacteristic(NimBLEUUID(INFO_UUID));
@@ -131,6 +142,10 @@ bool NimBLEClientController::connectToServer() {
                                               std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
     }
 
+    sensorFrameChar = pRemoteService->getCharacteristic(NimBLEUUID(SENSOR_FRAME_UUID));
+    sensorBatchChar = pRemoteService->getCharacteristic(NimBLEUUID(SENSOR_BATCH_UUID));
+    lastSensorSequence = -1;
+
     volumetricMeasurementChar = pRemoteService->getCharacteristic(NimBLEUUID(VOLUMETRIC_MEASUREMENT_UUID));
     if (volumetricMeasurementChar != nullptr && volumetricMeasurementChar->canNotify()) {
         volumetricMeasurementChar->subscribe(true,
@@ -152,22 +167,71 @@ bool NimBLEClientController::connectToServer() {
 
 void NimBLEClientController::sendAdvancedOutputControl(bool valve, float boilerSetpoint, bool pressureTarget, float pressure,
                                                        float flow) {
-    if (client->isConnected() && outputControlChar != nullptr) {
+    if (controlFrames && client->isConnected()) {
+        ControlFrame frame{0, pressureTarget ? OutputMode::PRESSURE : OutputMode::FLOW, valve, boilerSetpoint, 100.0f,
+                           pressure, flow};
+        writeControlFrame(frame);
+    } else if (client->isConnected() && outputControlChar != nullptr) {
         char str[30];
         snprintf(str, sizeof(str), "%d,%d,%.1f,%.1f,%d,%.2f,%.2f", 1, valve ? 1 : 0, 100.0f, boilerSetpoint,
                  pressureTarget ? 1 : 0, pressure, flow);
-        _lastOutputControl = String(str);
-        outputControlChar->writeValue(_lastOutputControl, false);
+        writeOutputControl(str);
     }
 }
 
 void NimBLEClientController::sendOutputControl(bool valve, float pumpSetpoint, float boilerSetpoint) {
-    if (client->isConnected() && outputControlChar != nullptr) {
+    if (controlFrames && client->isConnected()) {
+        ControlFrame frame{0, OutputMode::POWER, valve, boilerSetpoint, pumpSetpoint, 0.0f, 0.0f};
+        writeControlFrame(frame);
+    } else if (client->isConnected() && outputControlChar != nullptr) {
         char str[30];
         snprintf(str, sizeof(str), "%d,%d,%.1f,%.1f", 0, valve ? 1 : 0, pumpSetpoint, boilerSetpoint);
-        _lastOutputControl = String(str);
-        outputControlChar->writeValue(_lastOutputControl, false);
+        writeOutputControl(str);
+    }
+}
+
+void NimBLEClientController::writeOutputControl(const char *command) {
+    unsigned long now = millis();
+    bool stale = outputsStale.exchange(false);
+    if (!stale && _lastOutputControl == command && now - lastOutputControlWrite < OUTPUT_CONTROL_HEARTBEAT_MS) {
+        return;
+    }
+    _lastOutputControl = command;
+    lastOutputControlWrite = now;
+    outputControlChar->writeValue(_lastOutputControl, false);
+}
+
+void NimBLEClientController::writeControlFrame(ControlFrame &frame) {
+    // Encoded with the current sequence first, so an unchanged command produces the bytes that went out last time
+    frame.sequence = controlSequence;
+    uint8_t data[CONTROL_FRAME_SIZE];
+    size_t length = encodeControlFrame(frame, data, sizeof(data));
+    unsigned long now = millis();
+    bool stale = outputsStale.exchange(false);
+    bool changed = memcmp(data, lastControlFrame, length) != 0;
+    if (!stale && !changed && now - lastOutputControlWrite < OUTPUT_CONTROL_HEARTBEAT_MS) {
+        return;
+    }
+    if (changed) {
+        controlSequence = controlSequence == UINT16_MAX ? 1 : controlSequence + 1;
+        frame.sequence = controlSequence;
+        length = encodeControlFrame(frame, data, sizeof(data));
+        lastControlSent.store(static_cast<uint32_t>(controlSequence) << 16 | (now & 0xFFFF), std::memory_order_release);
+    }
+    memcpy(lastControlFrame, data, length);
+    lastOutputControlWrite = now;
+    controlFrameChar->writeValue(data, length, false);
+}
+
+bool NimBLEClientController::getControlSendTime(uint16_t sequence, uint32_t &sentAt) const {
+    uint32_t sent = lastControlSent.load(std::memory_order_acquire);
+    if (sequence == 0 || sent >> 16 != sequence) {
+        return false;
     }
+    // Only the low half of the send time is kept, good for the last minute
+    uint32_t now = millis();
+    sentAt = now - static_cast<uint16_t>(now - (sent & 0xFFFF));
+    return true;
 }
 
 void NimBLEClientController::sendPidSettings(const String &pid) {
@@ -196,6 +260,12 @@ void NimBLEClientController::sendLedControl(uint8_t channel, uint8_t brightness)
 
 void NimBLEClientController::sendAltControl(bool pinState) {
     if (altControlChar != nullptr && client->isConnected()) {
+        unsigned long now = millis();
+        if (pinState == lastAltControl && now - lastAltControlWrite < OUTPUT_CONTROL_HEARTBEAT_MS && !outputsStale) {
+            return;
+        }
+        lastAltControl = pinState ? 1 : 0;
+        lastAltControlWrite = now;
         altControlChar->writeValue(pinState ? "1" : "0");
     }
 }
@@ -214,6 +284,78 @@ void NimBLEClientController::sendAutotune(int testTime, int samples) {
     }
 }
 
+bool NimBLEClientController::useSensorFrames() {
+    if (sensorFrameChar == nullptr || !sensorFrameChar->canNotify() || !client->isConnected()) {
+        return false;
+    }
+    if (!sensorFrameChar->subscribe(true, std::bind(&NimBLEClientController::notifyCallback, this, std::placeholders::_1,
+                                                    std::placeholders::_2, std::placeholders::_3, std::placeholders::_4))) {
+        ESP_LOGE(LOG_TAG, "Failed to subscribe to sensor frames");
+        return false;
+    }
+    if (sensorChar != nullptr) {
+        sensorChar->unsubscribe();
+    }
+    ESP_LOGI(LOG_TAG, "Receiving sensor data as binary frames");
+    return true;
+}
+
+bool NimBLEClientController::useControlFrames() {
+    if (controlFrameChar == nullptr || !controlFrameChar->canWrite() || !client->isConnected()) {
+        return false;
+    }
+    controlFrames = true;
+    outputsStale = true; // send the current outputs in the new format right away
+    ESP_LOGI(LOG_TAG, "Sending output commands as binary frames");
+    return true;
+}
+
+bool NimBLEClientController::useClockSync() {
+    if (pingChar == nullptr || !pingChar->canNotify() || !client->isConnected()) {
+        return false;
+    }
+    if (!pingChar->subscribe(true, std::bind(&NimBLEClientController::notifyCallback, this, std::placeholders::_1,
+                                             std::placeholders::_2, std::placeholders::_3, std::placeholders::_4))) {
+        ESP_LOGE(LOG_TAG, "Failed to subscribe to clock sync replies");
+        return false;
+    }
+    clockSyncEnabled = true;
+    ESP_LOGI(LOG_TAG, "Synchronizing clocks with the controller");
+    return true;
+}
+
+void NimBLEClientController::sendClockSync() {
+    if (!clockSyncEnabled || pingChar == nullptr || !client->isConnected()) {
+        return;
+    }
+    ClockSyncRequest request{static_cast<uint16_t>(clockSyncSequence + 1), 0};
+    clockSyncSequence = request.sequence;
+    uint8_t data[CLOCK_SYNC_REQUEST_SIZE];
+    request.sent = millis();
+    pingChar->writeValue(data, encodeClockSyncRequest(request, data, sizeof(data)));
+}
+
+bool NimBLEClientController::useSensorBatches() {
+    if (sensorBatchChar == nullptr || !sensorBatchChar->canNotify() || !client->isConnected()) {
+        return false;
+    }
+    uint16_t mtu = client->getMTU();
+    if (mtu < 3 + SENSOR_BATCH_HEADER_SIZE + SENSOR_BATCH_SAMPLE_SIZE) {
+        ESP_LOGW(LOG_TAG, "MTU %u is too small for sensor batches", mtu);
+        return false;
+    }
+    if (!sensorBatchChar->subscribe(true, std::bind(&NimBLEClientController::notifyCallback, this, std::placeholders::_1,
+                                                    std::placeholders::_2, std::placeholders::_3, std::placeholders::_4))) {
+        ESP_LOGE(LOG_TAG, "Failed to subscribe to sensor batches");
+        return false;
+    }
+    if (sensorChar != nullptr) {
+        sensorChar->unsubscribe();
+    }
+    ESP_LOGI(LOG_TAG, "Receiving batched sensor data at MTU %u", mtu);
+    return true;
+}
+
 bool NimBLEClientController::isReadyForConnection() const { return readyForConnection; }
 
 bool NimBLEClientController::isConnected() { return client->isConnected(); }
@@ -236,12 +378,15 @@ void NimBLEClientController::onResult(NimBLEAdvertisedDevice *advertisedDevice)
 
 void NimBLEClientController::onDisconnect(NimBLEClient *pServer) {
     ESP_LOGI(LOG_TAG, "Disconnected from server, trying to reconnect...");
+    outputsStale = true;
     scan();
 }
 
 // Notification callback
-void NimBLEClientController::notifyCallback(NimBLERemoteCharacteristic *pRemoteCharacteristic, uint8_t *pData, size_t,
-                                            bool) const {
+void NimBLEClientController::notifyCallback(NimBLERemoteCharacteristic *pRemoteCharacteristic, uint8_t *pData, size_t length,
+                                            bool) {
+    linkCounters.notifications.fetch_add(1, std::memory_order_relaxed);
+    linkCounters.bytes.fetch_add(length, std::memory_order_relaxed);
     if (pRemoteCharacteristic->getUUID().equals(NimBLEUUID(ERROR_CHAR_UUID))) {
         int errorCode = atoi((char *)pData);
         ESP_LOGV(LOG_TAG, "Error read: %d", errorCode);
@@ -278,6 +423,71 @@ void NimBLEClientController::notifyCallback(NimBLERemoteCharacteristic *pRemoteC
             sensorCallback(temperature, pressure, puckFlow, pumpFlow, puckResistance);
         }
     }
+    if (pRemoteCharacteristic->getUUID().equals(NimBLEUUID(SENSOR_FRAME_UUID))) {
+        SensorFrame frame;
+        if (!decodeSensorFrame(pData, length, frame)) {
+            ESP_LOGW(LOG_TAG, "Dropping sensor frame of %u bytes, version %u", static_cast<unsigned>(length),
+                     length > 0 ? pData[0] : 0);
+            return;
+        }
+        if (lastSensorSequence >= 0 && frame.sequence != static_cast<uint16_t>(lastSensorSequence + 1)) {
+            const auto missed = static_cast<uint16_t>(frame.sequence - lastSensorSequence - 1);
+            linkCounters.missed.fetch_add(missed, std::memory_order_relaxed);
+            ESP_LOGD(LOG_TAG, "Missed %u sensor frames", missed);
+        }
+        lastSensorSequence = frame.sequence;
+        ESP_LOGV(LOG_TAG, "Received sensor frame %u at %u", frame.sequence, static_cast<unsigned>(frame.timestamp));
+        // A frame is a batch of one to consumers that want the controller timestamps and the control echo
+        if (sensorBatchCallback != nullptr) {
+            sensorBatchCallback(&frame, 1);
+        } else if (sensorCallback != nullptr) {
+            sensorCallback(frame.temperature, frame.pressure, frame.puckFlow, frame.pumpFlow, frame.puckResistance);
+        }
+    }
+    if (pRemoteCharacteristic->getUUID().equals(NimBLEUUID(SENSOR_BATCH_UUID))) {
+        SensorFrame samples[SENSOR_BATCH_MAX_SAMPLES];
+        size_t count = decodeSensorBatch(pData, length, samples, SENSOR_BATCH_MAX_SAMPLES);
+        if (count == 0 && decodeSensorFrame(pData, length, samples[0])) {
+            count = 1; // the controller falls back to single frames when a batch does not fit the MTU
+        }
+        if (count == 0) {
+            ESP_LOGW(LOG_TAG, "Dropping sensor batch of %u bytes, version %u", static_cast<unsigned>(length),
+                     length > 0 ? pData[0] : 0);
+            return;
+        }
+        if (lastSensorSequence >= 0 && samples[0].sequence != static_cast<uint16_t>(lastSensorSequence + 1)) {
+            const auto missed = static_cast<uint16_t>(samples[0].sequence - lastSensorSequence - 1);
+            linkCounters.missed.fetch_add(missed, std::memory_order_relaxed);
+            ESP_LOGD(LOG_TAG, "Missed %u sensor samples", missed);
+        }
+        const SensorFrame &latest = samples[count - 1];
+        lastSensorSequence = latest.sequence;
+        ESP_LOGV(LOG_TAG, "Received %u sensor samples up to %u", static_cast<unsigned>(count), latest.sequence);
+        if (sensorBatchCallback != nullptr) {
+            sensorBatchCallback(samples, count);
+        } else if (sensorCallback != nullptr) {
+            sensorCallback(latest.temperature, latest.pressure, latest.puckFlow, latest.pumpFlow, latest.puckResistance);
+        }
+    }
+    if (pRemoteCharacteristic->getUUID().equals(NimBLEUUID(PING_CHAR_UUID))) {
+        const uint32_t arrived = millis();
+        ClockSyncReply reply;
+        if (!decodeClockSyncReply(pData, length, reply)) {
+            ESP_LOGW(LOG_TAG, "Dropping clock sync reply of %u bytes", static_cast<unsigned>(length));
+            return;
+        }
+        if (reply.sequence != clockSyncSequence) {
+            ESP_LOGD(LOG_TAG, "Ignoring late clock sync reply %u", reply.sequence);
+            return;
+        }
+        clockSync.addExchange(reply.sent, reply.received, reply.replied, arrived);
+        const ClockSyncStats &stats = clockSync.getStats();
+        ESP_LOGV(LOG_TAG, "Clock offset %d ms, drift %.1f ppm, rtt %u ms", static_cast<int>(stats.offsetMs), stats.driftPpm,
+                 stats.rttMs);
+        if (clockSyncCallback != nullptr) {
+            clockSyncCallback(stats);
+        }
+    }
     if (pRemoteCharacteristic->getUUID().equals(NimBLEUUID(AUTOTUNE_RESULT_UUID))) {
         String settings = String((char *)pData);
         ESP_LOGV(LOG_TAG, "autotune result: %s", settings.c_str());
@@ -3,6 +3,11 @@
 
 #include "NimBLEComm.h"
 #include "cstring"
+#include <atomic>
+
+// Unchanged output commands are repeated at this rate only. The controller treats them as keepalive, so this has to
+// stay well below its PING_TIMEOUT_SECONDS.
+constexpr unsigned long OUTPUT_CONTROL_HEARTBEAT_MS = 2000;
 
 class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLEClientCallbacks {
   public:
@@ -20,6 +25,20 @@ class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLECli
     void sendPumpModelCoeffs(const String &pumpModelCoeffs);
     void setPressureScale(float scale);
     void sendLedControl(uint8_t channel, uint8_t brightness);
+    // Switches sensor notifications to binary frames, call once the controller announced support in its info
+    bool useSensorFrames();
+    // Switches to batched control cycles, needs an MTU that fits at least one sample
+    bool useSensorBatches();
+    // Sends output commands as binary control frames, call once the controller announced support in its info
+    bool useControlFrames();
+    // When the control frame with this sequence went out, false if a newer one was sent since
+    bool getControlSendTime(uint16_t sequence, uint32_t &sentAt) const;
+    // Subscribes to clock sync replies, call once the controller announced support in its info
+    bool useClockSync();
+    // One exchange, the estimate gets better the more often this is called. Does nothing before useClockSync().
+    void sendClockSync();
+    // Only consistent from callbacks registered here, they all run on the BLE host task that feeds it
+    const ClockSync &getClockSync() const { return clockSync; }
     bool isReadyForConnection() const;
     bool isConnected();
     void scan();
@@ -28,11 +47,15 @@ class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLECli
     void registerBrewBtnCallback(const brew_callback_t &callback);
     void registerSteamBtnCallback(const steam_callback_t &callback);
     void registerSensorCallback(const sensor_read_callback_t &callback);
+    // Also receives binary sensor frames, as batches of one, once registered
+    void registerSensorBatchCallback(const sensor_batch_callback_t &callback);
+    void registerClockSyncCallback(const clock_sync_callback_t &callback);
     void registerAutotuneResultCallback(const pid_control_callback_t &callback);
     void registerVolumetricMeasurementCallback(const float_callback_t &callback);
     void registerTofMeasurementCallback(const int_callback_t &callback);
     std::string readInfo() const;
     NimBLEClient *getClient() const { return client; };
+    const LinkCounters &getLinkCounters() const { return linkCounters; }
 
   private:
     NimBLEClient *client;
@@ -52,7 +75,10 @@ class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLECli
     NimBLERemoteCharacteristic *steamBtnChar = nullptr;
     NimBLERemoteCharacteristic *infoChar = nullptr;
     NimBLERemoteCharacteristic *sensorChar = nullptr;
+    NimBLERemoteCharacteristic *sensorFrameChar = nullptr;
+    NimBLERemoteCharacteristic *sensorBatchChar = nullptr;
     NimBLERemoteCharacteristic *outputControlChar = nullptr;
+    NimBLERemoteCharacteristic *controlFrameChar = nullptr;
     NimBLERemoteCharacteristic *pressureScaleChar = nullptr;
     NimBLERemoteCharacteristic *volumetricMeasurementChar = nullptr;
     NimBLERemoteCharacteristic *volumetricTareChar = nullptr;
@@ -66,10 +92,28 @@ class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLECli
     steam_callback_t steamBtnCallback = nullptr;
     pid_control_callback_t autotuneResultCallback = nullptr;
     sensor_read_callback_t sensorCallback = nullptr;
+    sensor_batch_callback_t sensorBatchCallback = nullptr;
+    clock_sync_callback_t clockSyncCallback = nullptr;
     float_callback_t volumetricMeasurementCallback = nullptr;
     int_callback_t tofMeasurementCallback = nullptr;
 
     String _lastOutputControl = "";
+    unsigned long lastOutputControlWrite = 0;
+    std::atomic<bool> controlFrames{false};
+    uint8_t lastControlFrame[CONTROL_FRAME_SIZE] = {};
+    uint16_t controlSequence = 0;
+    std::atomic<uint32_t> lastControlSent{0}; // sequence in the high half, low half of the send millis() below
+    int8_t lastAltControl = -1;
+    unsigned long lastAltControlWrite = 0;
+    std::atomic<bool> outputsStale{true}; // set on disconnect so the next commands go out unconditionally
+    int32_t lastSensorSequence = -1;
+    LinkCounters linkCounters;
+    std::atomic<bool> clockSyncEnabled{false};
+    std::atomic<uint16_t> clockSyncSequence{0}; // replies to older requests are ignored
+    ClockSync clockSync;
+
+    void writeOutputControl(const char *command);
+    void writeControlFrame(ControlFrame &frame);
 
     // BLEAdvertisedDeviceCallbacks override
     void onResult(NimBLEAdvertisedDevice *advertisedDevice) override;
@@ -78,7 +122,7 @@ class NimBLEClientController : public NimBLEAdvertisedDeviceCallbacks, NimBLECli
     void onDisconnect(NimBLEClient *pServer) override;
 
     // Notification callback
-    void notifyCallback(NimBLERemoteCharacteristic *pRemoteCharacteristic, uint8_t *pData, size_t length, bool isNotify) const;
+    void notifyCallback(NimBLERemoteCharacteristic *pRemoteCharacteristic, uint8_t *pData, size_t length, bool isNotify);
 
     const char *LOG_TAG = "NimBLEClientController";
 };
@@ -1,8 +1,12 @@
 #ifndef NIMBLECOMM_H
 #define NIMBLECOMM_H
 
+#include "ClockSync.h"
+#include "ControlFrame.h"
+#include "SensorFrame.h"
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <atomic>
 
 // UUIDs for BLE services and characteristics
 #define SERVICE_UUID "e75bc5b6-ff6e-4337-9d31-0c128f2e6e68"
@@ -19,7 +23,10 @@
 
 #define PRESSURE_SCALE_UUID "3aa65ab6-2dda-4c95-9cf3-58b2a0480623"
 #define SENSOR_DATA_UUID "62b69e72-ac19-4d4b-bd53-2edd65330c93"
+#define SENSOR_FRAME_UUID "00da3b3b-79bb-4e33-af70-c58d1f9e9a22"
+#define SENSOR_BATCH_UUID "5b0b6a5e-2f4c-4d1e-9a7e-3c1f2b8d6e41"
 #define OUTPUT_CONTROL_UUID "77fbb08f-c29c-4f2e-8e1d-ed0a9afa5e1a"
+#define CONTROL_FRAME_UUID "c3e2a4f1-6b8d-4e0a-9f57-2d1b8c4a7e90"
 #define VOLUMETRIC_MEASUREMENT_UUID "b0080557-3865-4a9c-be37-492d77ee5951"
 #define VOLUMETRIC_TARE_UUID "a8bd52e0-77c3-412c-847c-4e802c3982f9"
 #define TOF_MEASUREMENT_UUID "7282c525-21a0-416a-880d-21fe98602533"
@@ -50,6 +57,8 @@ using advanced_output_callback_t =
     std::function<void(bool valve, float boilerSetpoint, bool pressureTarget, float pumpPressure, float pumpFlow)>;
 using sensor_read_callback_t =
     std::function<void(float temperature, float pressure, float puckFlow, float pumpFlow, float puckResistance)>;
+using sensor_batch_callback_t = std::function<void(const SensorFrame *samples, size_t count)>;
+using clock_sync_callback_t = std::function<void(const ClockSyncStats &stats)>;
 using led_control_callback_t = std::function<void(uint8_t channel, uint8_t brightness)>;
 
 struct SystemCapabilities {
@@ -57,6 +66,17 @@ struct SystemCapabilities {
     bool pressure;
     bool ledControl;
     bool tof;
+    uint8_t sensorFrame;  // SensorFrame version the controller sends, 0 for CSV only
+    uint8_t sensorBatch;  // sensor batch version, 0 when the controller does not batch
+    uint8_t controlFrame; // ControlFrame version the controller accepts, 0 for CSV only
+    uint8_t clockSync;    // clock sync version the controller answers on the ping characteristic, 0 for none
+};
+
+// Running totals of one BLE link, bumped by its notification callback and read from any task
+struct LinkCounters {
+    std::atomic<uint32_t> notifications{0};
+    std::atomic<uint32_t> bytes{0};
+    std::atomic<uint32_t> missed{0}; // notifications the sender numbered but never arrived
 };
 
 struct SystemInfo {
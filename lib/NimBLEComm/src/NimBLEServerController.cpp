@@ -18,13 +18,16 @@ void NimBLEServerController::initServer(const String infoString) {
     // Output Control Characteristic (Client writes setpoints)
     outputControlChar = pService->createCharacteristic(OUTPUT_CONTROL_UUID, NIMBLE_PROPERTY::WRITE);
     outputControlChar->setCallbacks(this); // Use this class as the callback handler
+    controlFrameChar =
+        pService->createCharacteristic(CONTROL_FRAME_UUID, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR);
+    controlFrameChar->setCallbacks(this);
 
     // Alt Control Characteristic (Client writes pin state)
     altControlChar = pService->createCharacteristic(ALT_CONTROL_CHAR_UUID, NIMBLE_PROPERTY::WRITE);
     altControlChar->setCallbacks(this); // Use this class as the callback handler
 
-    // Ping Characteristic (Client writes ping, Server reads)
-    pingChar = pService->createCharacteristic(PING_CHAR_UUID, NIMBLE_PROPERTY::WRITE);
+    // Ping Characteristic (Client writes ping, Server reads). Clock sync requests are answered with a notification.
+    pingChar = pService->createCharacteristic(PING_CHAR_UUID, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
     pingChar->setCallbacks(this); // Use this class as the callback handler
 
     // PID control Characteristic (Client writes PID settings, Server reads)
@@ -54,6 +57,11 @@ void NimBLEServerController::initServer(const String infoString) {
 
     // Pressure Read Characteristic (Server notifies client of pressure)
     sensorChar = pService->createCharacteristic(SENSOR_DATA_UUID, NIMBLE_PROPERTY::NOTIFY);
+    // Binary sensor frames, displays that know the version from the info capabilities subscribe here instead
+    sensorFrameChar = pService->createCharacteristic(SENSOR_FRAME_UUID, NIMBLE_PROPERTY::NOTIFY);
+    // Batched control cycles, preferred over single frames by displays that know the batch version
+    sensorBatchChar = pService->createCharacteristic(SENSOR_BATCH_UUID, NIMBLE_PROPERTY::NOTIFY);
+    sensorSamples = xQueueCreate(SENSOR_SAMPLE_QUEUE_LENGTH, sizeof(SensorFrame));
 
     // PID control Characteristic (Client writes pressure settings, Server reads)
     pressureScaleChar = pService->createCharacteristic(PRESSURE_SCALE_UUID, NIMBLE_PROPERTY::WRITE);
@@ -81,14 +89,123 @@ void NimBLEServerController::initServer(const String infoString) {
 
 void NimBLEServerController::sendSensorData(float temperature, float pressure, float puckFlow, float pumpFlow,
                                             float puckResistance) {
-    if (deviceConnected && sensorChar != nullptr) {
-        char str[30];
+    if (!deviceConnected) {
+        return;
+    }
+    if (sensorFrameChar != nullptr && sensorFrameChar->getSubscribedCount() > 0) {
+        SensorFrame frame{sensorSequence++, static_cast<uint32_t>(millis()), temperature, pressure, puckFlow, pumpFlow,
+                          puckResistance};
+        echoControl(frame);
+        uint8_t data[SENSOR_FRAME_SIZE];
+        sensorFrameChar->setValue(data, encodeSensorFrame(frame, data, sizeof(data)));
+        sensorFrameChar->notify();
+    }
+    if (sensorChar != nullptr && sensorChar->getSubscribedCount() > 0) {
+        char str[64];
         snprintf(str, sizeof(str), "%.3f,%.3f,%.3f,%.3f,%.3f", temperature, pressure, puckFlow, pumpFlow, puckResistance);
         sensorChar->setValue(str);
         sensorChar->notify();
     }
 }
 
+void NimBLEServerController::queueSensorSample(float temperature, float pressure, float puckFlow, float pumpFlow,
+                                               float puckResistance) {
+    if (sensorSamples == nullptr) {
+        return;
+    }
+    SensorFrame sample{0, static_cast<uint32_t>(millis()), temperature, pressure, puckFlow, pumpFlow, puckResistance};
+    if (xQueueSend(sensorSamples, &sample, 0) != pdTRUE) {
+        // Nobody flushed for a while, keep the most recent cycles
+        SensorFrame dropped;
+        xQueueReceive(sensorSamples, &dropped, 0);
+        xQueueSend(sensorSamples, &sample, 0);
+    }
+}
+
+void NimBLEServerController::flushSensorSamples() {
+    if (sensorSamples == nullptr) {
+        return;
+    }
+    SensorFrame samples[SENSOR_SAMPLE_QUEUE_LENGTH];
+    size_t count = 0;
+    while (count < SENSOR_SAMPLE_QUEUE_LENGTH && xQueueReceive(sensorSamples, &samples[count], 0) == pdTRUE) {
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+    const SensorFrame &latest = samples[count - 1];
+    sendSensorData(latest.temperature, latest.pressure, latest.puckFlow, latest.pumpFlow, latest.puckResistance);
+    if (!deviceConnected || sensorBatchChar == nullptr || sensorBatchChar->getSubscribedCount() == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        samples[i].sequence = batchSequence++;
+    }
+    echoControl(samples[count - 1]);
+    uint8_t data[SENSOR_BATCH_HEADER_SIZE + SENSOR_BATCH_MAX_SAMPLES * SENSOR_BATCH_SAMPLE_SIZE];
+    const size_t payload = peerMtu - 3; // ATT notification header
+    const size_t size = payload < sizeof(data) ? payload : sizeof(data);
+    for (size_t sent = 0; sent < count;) {
+        size_t encoded = 0;
+        size_t length = encodeSensorBatch(samples + sent, count - sent, data, size, encoded);
+        if (length == 0) {
+            // Not even one sample fits, send the latest as a single frame cut to the payload, the 23 byte default MTU
+            // leaves out the control echo
+            if (!batchFallbackLogged.exchange(true)) {
+                ESP_LOGW(LOG_TAG, "MTU %u is too small for sensor batches, sending single frames", peerMtu.load());
+            }
+            uint8_t frame[SENSOR_FRAME_SIZE];
+            encodeSensorFrame(samples[count - 1], frame, sizeof(frame));
+            sensorBatchChar->setValue(frame, size < SENSOR_FRAME_SIZE ? size : SENSOR_FRAME_SIZE);
+            sensorBatchChar->notify();
+            return;
+        }
+        sensorBatchChar->setValue(data, length);
+        sensorBatchChar->notify();
+        sent += encoded;
+    }
+}
+
+void NimBLEServerController::applyControlFrame(const ControlFrame &frame) {
+    ESP_LOGV(LOG_TAG, "Received control frame %u: mode=%u, valve=%d, boiler=%.1f, pump=%.1f, pressure=%.1f, flow=%.1f",
+             frame.sequence, static_cast<unsigned>(frame.mode), frame.valve, frame.boilerSetpoint, frame.pumpSetpoint,
+             frame.pressure, frame.flow);
+    if (frame.mode == OutputMode::POWER) {
+        if (outputControlCallback != nullptr) {
+            outputControlCallback(frame.valve, frame.pumpSetpoint, frame.boilerSetpoint);
+        }
+    } else if (advancedControlCallback != nullptr) {
+        advancedControlCallback(frame.valve, frame.boilerSetpoint, frame.mode == OutputMode::PRESSURE, frame.pressure,
+                                frame.flow);
+    }
+    // Heartbeats repeat the sequence, only a new one marks when the outputs changed
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (frame.sequence != appliedControlSequence) {
+        appliedControlSequence = frame.sequence;
+        appliedControlAt = millis();
+    }
+}
+
+void NimBLEServerController::answerClockSync(const ClockSyncRequest &request, uint32_t received) {
+    if (!deviceConnected || pingChar->getSubscribedCount() == 0) {
+        return;
+    }
+    ClockSyncReply reply{request.sequence, request.sent, received, 0};
+    uint8_t data[CLOCK_SYNC_REPLY_SIZE];
+    // Stamped last so the time spent here does not count as round trip
+    reply.replied = millis();
+    pingChar->setValue(data, encodeClockSyncReply(reply, data, sizeof(data)));
+    pingChar->notify();
+}
+
+void NimBLEServerController::echoControl(SensorFrame &frame) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    frame.controlSequence = appliedControlSequence;
+    frame.controlTimestamp = appliedControlAt;
+}
+
 void NimBLEServerController::sendError(int errorCode) {
     if (deviceConnected) {
         // Send temperature notification to the client
@@ -178,19 +295,35 @@ void NimBLEServerController::registerPumpModelCoeffsCallback(const pump_model_co
 void NimBLEServerController::onConnect(NimBLEServer *pServer) {
     ESP_LOGI(LOG_TAG, "Client connected.");
     deviceConnected = true;
+    batchFallbackLogged = false;
     pServer->stopAdvertising();
 }
 
 void NimBLEServerController::onDisconnect(NimBLEServer *pServer) {
     ESP_LOGI(LOG_TAG, "Client disconnected.");
     deviceConnected = false;
+    peerMtu = BLE_DEFAULT_MTU;
+    batchFallbackLogged = false;
     pServer->startAdvertising(); // Restart advertising so clients can reconnect
 }
 
+void NimBLEServerController::onMTUChange(uint16_t MTU, ble_gap_conn_desc *desc) {
+    ESP_LOGI(LOG_TAG, "MTU changed to %u", MTU);
+    peerMtu = MTU;
+}
+
 void NimBLEServerController::onWrite(NimBLECharacteristic *pCharacteristic) {
     ESP_LOGV(LOG_TAG, "Write received!");
 
-    if (pCharacteristic->getUUID().equals(NimBLEUUID(OUTPUT_CONTROL_UUID))) {
+    if (pCharacteristic->getUUID().equals(NimBLEUUID(CONTROL_FRAME_UUID))) {
+        auto value = pCharacteristic->getValue();
+        ControlFrame frame;
+        if (!decodeControlFrame(reinterpret_cast<const uint8_t *>(value.data()), value.length(), frame)) {
+            ESP_LOGW(LOG_TAG, "Dropping control frame of %u bytes", static_cast<unsigned>(value.length()));
+            return;
+        }
+        applyControlFrame(frame);
+    } else if (pCharacteristic->getUUID().equals(NimBLEUUID(OUTPUT_CONTROL_UUID))) {
         auto control = String(pCharacteristic->getValue().c_str());
         uint8_t type = get_token(control, 0, ',').toInt();
         uint8_t valve = get_token(control, 1, ',').toInt();
@@ -219,7 +352,13 @@ void NimBLEServerController::onWrite(NimBLECharacteristic *pCharacteristic) {
             altControlCallback(pinState);
         }
     } else if (pCharacteristic->getUUID().equals(NimBLEUUID(PING_CHAR_UUID))) {
+        const uint32_t received = millis();
         ESP_LOGV(LOG_TAG, "Received ping");
+        auto value = pCharacteristic->getValue();
+        ClockSyncRequest request;
+        if (decodeClockSyncRequest(reinterpret_cast<const uint8_t *>(value.data()), value.length(), request)) {
+            answerClockSync(request, received);
+        }
         if (pingCallback != nullptr) {
             pingCallback();
         }
@@ -3,13 +3,22 @@
 
 #include "NimBLEComm.h"
 #include "cstring"
+#include <atomic>
 #include <ble_ota_dfu.hpp>
+#include <mutex>
+
+constexpr UBaseType_t SENSOR_SAMPLE_QUEUE_LENGTH = 32; // control cycles kept between two flushes, oldest are dropped
+constexpr uint16_t BLE_DEFAULT_MTU = 23;
 
 class NimBLEServerController : public NimBLEServerCallbacks, public NimBLECharacteristicCallbacks {
   public:
     NimBLEServerController();
     void initServer(String infoString);
     void sendSensorData(float temperature, float pressure, float puckFlow, float pumpFlow, float puckResistance);
+    // Buffers one control cycle, safe to call from any task. flushSensorSamples() sends them in batches to displays
+    // that subscribed to SENSOR_BATCH_UUID and the newest one to all others.
+    void queueSensorSample(float temperature, float pressure, float puckFlow, float pumpFlow, float puckResistance);
+    void flushSensorSamples();
     void sendError(int errorCode);
     void sendBrewBtnState(bool brewButtonStatus);
     void sendSteamBtnState(bool steamButtonStatus);
@@ -30,8 +39,17 @@ class NimBLEServerController : public NimBLEServerCallbacks, public NimBLECharac
 
   private:
     bool deviceConnected = false;
+    uint16_t sensorSequence = 0;
+    uint16_t batchSequence = 0;
+    std::atomic<uint16_t> peerMtu{BLE_DEFAULT_MTU};
+    std::atomic<bool> batchFallbackLogged{false}; // warned once this connection that batches do not fit the MTU
+    QueueHandle_t sensorSamples = nullptr;
+    std::mutex controlMutex; // the control echo is written by the BLE host and read by the sensor loop
+    uint16_t appliedControlSequence = 0;
+    uint32_t appliedControlAt = 0;
     String infoString = "";
     NimBLECharacteristic *outputControlChar = nullptr;
+    NimBLECharacteristic *controlFrameChar = nullptr;
     NimBLECharacteristic *pressureScaleChar = nullptr;
     NimBLECharacteristic *altControlChar = nullptr;
     NimBLECharacteristic *pingChar = nullptr;
@@ -44,6 +62,8 @@ class NimBLEServerController : public NimBLEServerCallbacks, public NimBLECharac
     NimBLECharacteristic *steamBtnChar = nullptr;
     NimBLECharacteristic *infoChar = nullptr;
     NimBLECharacteristic *sensorChar = nullptr;
+    NimBLECharacteristic *sensorFrameChar = nullptr;
+    NimBLECharacteristic *sensorBatchChar = nullptr;
     NimBLECharacteristic *volumetricMeasurementChar = nullptr;
     NimBLECharacteristic *volumetricTareChar = nullptr;
     NimBLECharacteristic *tofMeasurementChar = nullptr;
@@ -63,6 +83,11 @@ class NimBLEServerController : public NimBLEServerCallbacks, public NimBLECharac
     // BLEServerCallbacks overrides
     void onConnect(NimBLEServer *pServer) override;
     void onDisconnect(NimBLEServer *pServer) override;
+    void onMTUChange(uint16_t MTU, ble_gap_conn_desc *desc) override;
+
+    void applyControlFrame(const ControlFrame &frame);
+    void echoControl(SensorFrame &frame);
+    void answerClockSync(const ClockSyncRequest &request, uint32_t received);
 
     // BLECharacteristicCallbacks overrides
     void onWrite(NimBLECharacteristic *pCharacteristic) override;
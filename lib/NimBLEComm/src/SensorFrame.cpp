@@ -0,0 +1,106 @@
+#include "SensorFrame.h"
+
+#include "FixedPoint.h"
+
+using namespace fixed_point;
+
+namespace {
+constexpr float TEMPERATURE_SCALE = 100.0f;
+constexpr float PRESSURE_SCALE = 1000.0f;
+constexpr float FLOW_SCALE = 1000.0f;
+constexpr float RESISTANCE_SCALE = 100.0f;
+
+void putChannels(uint8_t *out, const SensorFrame &frame) {
+    putU16(out, toFixed16(frame.temperature, TEMPERATURE_SCALE));
+    putU16(out + 2, toFixed16(frame.pressure, PRESSURE_SCALE));
+    putU16(out + 4, toFixed16(frame.puckFlow, FLOW_SCALE));
+    putU16(out + 6, toFixed16(frame.pumpFlow, FLOW_SCALE));
+    putU32(out + 8, toFixedU32(frame.puckResistance, RESISTANCE_SCALE));
+}
+
+void getChannels(const uint8_t *in, SensorFrame &frame) {
+    frame.temperature = fromFixed16(static_cast<int16_t>(getU16(in)), TEMPERATURE_SCALE);
+    frame.pressure = fromFixed16(static_cast<int16_t>(getU16(in + 2)), PRESSURE_SCALE);
+    frame.puckFlow = fromFixed16(static_cast<int16_t>(getU16(in + 4)), FLOW_SCALE);
+    frame.pumpFlow = fromFixed16(static_cast<int16_t>(getU16(in + 6)), FLOW_SCALE);
+    frame.puckResistance = fromFixedU32(getU32(in + 8), RESISTANCE_SCALE);
+}
+} // namespace
+
+size_t encodeSensorFrame(const SensorFrame &frame, uint8_t *buffer, size_t size) {
+    if (size < SENSOR_FRAME_SIZE) {
+        return 0;
+    }
+    buffer[0] = SENSOR_FRAME_VERSION;
+    putU16(buffer + 1, frame.sequence);
+    putU32(buffer + 3, frame.timestamp);
+    putChannels(buffer + 7, frame);
+    putU16(buffer + 19, frame.controlSequence);
+    putU16(buffer + 21, saturate16(static_cast<int32_t>(frame.controlTimestamp - frame.timestamp)));
+    return SENSOR_FRAME_SIZE;
+}
+
+bool decodeSensorFrame(const uint8_t *data, size_t length, SensorFrame &frame) {
+    if (data == nullptr || length < SENSOR_FRAME_MIN_SIZE || data[0] != SENSOR_FRAME_VERSION) {
+        return false;
+    }
+    frame.sequence = getU16(data + 1);
+    frame.timestamp = getU32(data + 3);
+    getChannels(data + 7, frame);
+    frame.controlSequence = 0;
+    frame.controlTimestamp = 0;
+    if (length >= SENSOR_FRAME_SIZE) {
+        frame.controlSequence = getU16(data + 19);
+        frame.controlTimestamp = frame.timestamp + static_cast<int16_t>(getU16(data + 21));
+    }
+    return true;
+}
+
+size_t encodeSensorBatch(const SensorFrame *samples, size_t count, uint8_t *buffer, size_t size, size_t &encoded) {
+    encoded = 0;
+    if (count == 0 || size < SENSOR_BATCH_HEADER_SIZE + SENSOR_BATCH_SAMPLE_SIZE) {
+        return 0;
+    }
+    size_t fit = (size - SENSOR_BATCH_HEADER_SIZE) / SENSOR_BATCH_SAMPLE_SIZE;
+    encoded = count < fit ? count : fit;
+    encoded = encoded < SENSOR_BATCH_MAX_SAMPLES ? encoded : SENSOR_BATCH_MAX_SAMPLES;
+
+    const uint32_t start = samples[0].timestamp;
+    const SensorFrame &last = samples[encoded - 1];
+    buffer[0] = SENSOR_BATCH_VERSION;
+    buffer[1] = static_cast<uint8_t>(encoded);
+    putU16(buffer + 2, samples[0].sequence);
+    putU32(buffer + 4, start);
+    putU16(buffer + 8, last.controlSequence);
+    putU16(buffer + 10, saturate16(static_cast<int32_t>(last.controlTimestamp - start)));
+    uint8_t *out = buffer + SENSOR_BATCH_HEADER_SIZE;
+    for (size_t i = 0; i < encoded; i++, out += SENSOR_BATCH_SAMPLE_SIZE) {
+        uint32_t offset = samples[i].timestamp - start;
+        putU16(out, offset < UINT16_MAX ? offset : UINT16_MAX);
+        putChannels(out + 2, samples[i]);
+    }
+    return SENSOR_BATCH_HEADER_SIZE + encoded * SENSOR_BATCH_SAMPLE_SIZE;
+}
+
+size_t decodeSensorBatch(const uint8_t *data, size_t length, SensorFrame *samples, size_t capacity) {
+    if (data == nullptr || length < SENSOR_BATCH_HEADER_SIZE || data[0] != SENSOR_BATCH_VERSION) {
+        return 0;
+    }
+    size_t count = data[1];
+    if (count == 0 || count > capacity || length < SENSOR_BATCH_HEADER_SIZE + count * SENSOR_BATCH_SAMPLE_SIZE) {
+        return 0;
+    }
+    const uint16_t sequence = getU16(data + 2);
+    const uint32_t start = getU32(data + 4);
+    const uint16_t controlSequence = getU16(data + 8);
+    const uint32_t controlTimestamp = start + static_cast<int16_t>(getU16(data + 10));
+    const uint8_t *in = data + SENSOR_BATCH_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++, in += SENSOR_BATCH_SAMPLE_SIZE) {
+        samples[i].sequence = static_cast<uint16_t>(sequence + i);
+        samples[i].timestamp = start + getU16(in);
+        getChannels(in + 2, samples[i]);
+        samples[i].controlSequence = controlSequence;
+        samples[i].controlTimestamp = controlTimestamp;
+    }
+    return count;
+}
@@ -0,0 +1,81 @@
+#ifndef SENSORFRAME_H
+#define SENSORFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary sensor notification on SENSOR_FRAME_UUID. The controller announces the version as "sf" in its info
+// capabilities, displays that know it subscribe here instead of the CSV characteristic. Little endian:
+//
+//   0  u8   version
+//   1  u16  sequence, wraps around
+//   3  u32  controller millis()
+//   7  i16  temperature in 0.01 °C
+//   9  i16  pressure in 0.001 bar
+//   11 i16  puck flow in 0.001 ml/s
+//   13 i16  pump flow in 0.001 ml/s
+//   15 u32  puck resistance in 0.01
+//   19 u16  sequence of the last control frame applied, 0 before the first
+//   21 i16  ms from the frame timestamp to when that control frame was applied, saturates
+//
+// Values outside a channel's range saturate. NaN is sent as the lowest i16, which decodes back to NaN. A puck
+// resistance that is NaN or beyond the u32 range decodes as infinity. Fields may be appended without a version bump,
+// decoders ignore extra bytes; the version only changes when existing fields do.
+constexpr uint8_t SENSOR_FRAME_VERSION = 1;
+constexpr size_t SENSOR_FRAME_SIZE = 23;
+constexpr size_t SENSOR_FRAME_MIN_SIZE = 19; // without the control echo
+
+struct SensorFrame {
+    uint16_t sequence;
+    uint32_t timestamp;
+    float temperature;
+    float pressure;
+    float puckFlow;
+    float pumpFlow;
+    float puckResistance;
+    uint16_t controlSequence;  // last control frame applied, 0 for none
+    uint32_t controlTimestamp; // controller millis() when it was applied
+};
+
+// Consecutive control cycles in one notification on SENSOR_BATCH_UUID, announced as "sb". Little endian:
+//
+//   0  u8   version
+//   1  u8   sample count
+//   2  u16  sequence of the first sample, the others follow without gaps
+//   4  u32  controller millis() of the first sample
+//   8  u16  sequence of the last control frame applied as of the last sample, 0 before the first
+//   10 i16  ms from the first sample to when that control frame was applied, saturates
+//
+// followed by the samples, each with the channels of a SensorFrame:
+//
+//   0  u16  ms since the first sample, saturates
+//   2  i16  temperature
+//   4  i16  pressure
+//   6  i16  puck flow
+//   8  i16  pump flow
+//   10 u32  puck resistance
+//
+// When the MTU is too small for a single sample the controller notifies the latest one as a SensorFrame instead,
+// cut to the payload. Its version byte tells the two apart.
+constexpr uint8_t SENSOR_BATCH_VERSION = 2;
+constexpr size_t SENSOR_BATCH_HEADER_SIZE = 12;
+constexpr size_t SENSOR_BATCH_SAMPLE_SIZE = 14;
+constexpr uint8_t SENSOR_BATCH_MAX_SAMPLES = 8; // fills the 128 byte MTU both sides request
+
+// Returns the number of bytes written, 0 if the buffer is too small
+size_t encodeSensorFrame(const SensorFrame &frame, uint8_t *buffer, size_t size);
+
+// Rejects frames that are too short or were written by an unknown version. Frames without the control echo decode
+// with a control sequence of 0.
+bool decodeSensorFrame(const uint8_t *data, size_t length, SensorFrame &frame);
+
+// Encodes as many of the samples as fit into size bytes, up to SENSOR_BATCH_MAX_SAMPLES. Sequence numbers are taken
+// from the first sample, the control echo from the last one encoded. Returns the number of bytes written and sets
+// encoded to the number of samples in them.
+size_t encodeSensorBatch(const SensorFrame *samples, size_t count, uint8_t *buffer, size_t size, size_t &encoded);
+
+// Returns the number of samples decoded into samples, 0 for a malformed batch or one of an unknown version. Every
+// sample carries the batch's control echo.
+size_t decodeSensorBatch(const uint8_t *data, size_t length, SensorFrame *samples, size_t capacity);
+
+#endif // SENSORFRAME_H
@@ -0,0 +1,126 @@
+#include "BLEConnectionManager.h"
+
+#include <NimBLEDevice.h>
+
+namespace {
+constexpr const char *LOG_TAG = "BLEConnectionManager";
+
+// Per link and profile. The controller link carries the sensor and control loop, so it gets the shortest interval the
+// controller accepts whenever the machine is in use. Scales send weight at about 10 Hz, a longer interval keeps up with
+// that and leaves air time to the controller.
+constexpr BLELinkParams LINK_PARAMS[BLE_LINK_COUNT][BLE_LINK_PROFILE_COUNT] = {
+    {{24, 40, 0, 400}, {6, 8, 0, 400}, {6, 8, 0, 400}},     // controller: 30-50 ms idle, 7.5-10 ms otherwise
+    {{40, 80, 0, 400}, {16, 32, 0, 400}, {16, 32, 0, 400}}, // scale: 50-100 ms idle, 20-40 ms otherwise
+};
+
+const char *linkName(BLELink link) { return link == BLELink::CONTROLLER ? "controller" : "scale"; }
+} // namespace
+
+BLEConnectionManager::BLEConnectionManager(PluginManager *pluginManager) : pluginManager(pluginManager) {}
+
+void BLEConnectionManager::attach(BLELink link, const std::string &address, const LinkCounters *counters) {
+    Link &entry = links[static_cast<size_t>(link)];
+    entry.address = address;
+    entry.counters = counters;
+    entry.notifications = counters != nullptr ? counters->notifications.load(std::memory_order_relaxed) : 0;
+    entry.bytes = counters != nullptr ? counters->bytes.load(std::memory_order_relaxed) : 0;
+    entry.missed = counters != nullptr ? counters->missed.load(std::memory_order_relaxed) : 0;
+    entry.totals = BLELinkStats{};
+    ESP_LOGI(LOG_TAG, "Managing %s link to %s", linkName(link), address.c_str());
+    apply(link);
+}
+
+void BLEConnectionManager::detach(BLELink link) {
+    Link &entry = links[static_cast<size_t>(link)];
+    entry.address.clear();
+    entry.counters = nullptr;
+    entry.totals = BLELinkStats{};
+    entry.stats.store(entry.totals);
+}
+
+void BLEConnectionManager::setProfile(BLELinkProfile profile) {
+    const BLELinkProfile previous = this->profile.exchange(profile);
+    if (previous == profile) {
+        return;
+    }
+    for (size_t i = 0; i < BLE_LINK_COUNT; i++) {
+        apply(static_cast<BLELink>(i));
+    }
+    if (profile == BLELinkProfile::PROCESS) {
+        ESP_LOGI(LOG_TAG, "Pausing scans");
+        pluginManager->trigger("controller:bluetooth:scan:pause"_ev);
+    } else if (previous == BLELinkProfile::PROCESS) {
+        ESP_LOGI(LOG_TAG, "Resuming scans");
+        pluginManager->trigger("controller:bluetooth:scan:resume"_ev);
+    }
+}
+
+void BLEConnectionManager::loop() {
+    const unsigned long now = millis();
+    const unsigned long elapsed = now - lastReport;
+    if (elapsed < BLE_LINK_STATS_INTERVAL_MS) {
+        return;
+    }
+    lastReport = now;
+    for (size_t i = 0; i < BLE_LINK_COUNT; i++) {
+        if (!links[i].address.empty()) {
+            report(static_cast<BLELink>(i), elapsed);
+        }
+    }
+}
+
+NimBLEClient *BLEConnectionManager::findClient(const Link &link) const {
+    if (link.address.empty()) {
+        return nullptr;
+    }
+    return NimBLEDevice::getClientByPeerAddress(NimBLEAddress(link.address));
+}
+
+void BLEConnectionManager::apply(BLELink link) {
+    NimBLEClient *client = findClient(links[static_cast<size_t>(link)]);
+    if (client == nullptr || !client->isConnected()) {
+        return;
+    }
+    const BLELinkParams &params = LINK_PARAMS[static_cast<size_t>(link)][static_cast<size_t>(profile.load())];
+    ESP_LOGI(LOG_TAG, "Requesting %u-%u x 1.25 ms on the %s link", params.minInterval, params.maxInterval, linkName(link));
+    client->updateConnParams(params.minInterval, params.maxInterval, params.latency, params.timeout);
+}
+
+void BLEConnectionManager::report(BLELink link, unsigned long elapsed) {
+    Link &entry = links[static_cast<size_t>(link)];
+    BLELinkStats stats = entry.totals;
+    stats.mtu = 0;
+    stats.interval = 0;
+    stats.notificationsPerSecond = 0.0f;
+    stats.bytesPerSecond = 0.0f;
+    NimBLEClient *client = findClient(entry);
+    if (client != nullptr && client->isConnected()) {
+        stats.mtu = client->getMTU();
+        stats.interval = client->getConnInfo().getConnInterval();
+    }
+    if (entry.counters != nullptr) {
+        // Counters only grow, unsigned differences stay right across a wrap
+        const uint32_t notifications = entry.counters->notifications.load(std::memory_order_relaxed);
+        const uint32_t bytes = entry.counters->bytes.load(std::memory_order_relaxed);
+        const uint32_t missed = entry.counters->missed.load(std::memory_order_relaxed);
+        stats.notificationsPerSecond = (notifications - entry.notifications) * 1000.0f / elapsed;
+        stats.bytesPerSecond = (bytes - entry.bytes) * 1000.0f / elapsed;
+        stats.notifications += notifications - entry.notifications;
+        stats.missed += missed - entry.missed;
+        entry.notifications = notifications;
+        entry.bytes = bytes;
+        entry.missed = missed;
+    }
+    entry.totals = stats;
+    entry.stats.store(stats);
+    ESP_LOGD(LOG_TAG, "%s link: mtu %u, interval %u, %.1f notifications/s, %.0f B/s, %u missed", linkName(link), stats.mtu,
+             stats.interval, stats.notificationsPerSecond, stats.bytesPerSecond, static_cast<unsigned>(stats.missed));
+
+    if (pluginManager->hasListeners("controller:bluetooth:link:stats"_ev)) {
+        Event event;
+        event.id = "controller:bluetooth:link:stats"_ev;
+        event.setInt("link"_ev, static_cast<int>(link));
+        event.setPayload(stats);
+        pluginManager->trigger(event);
+    }
+}
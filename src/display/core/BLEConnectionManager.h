@@ -0,0 +1,85 @@
+#ifndef BLECONNECTIONMANAGER_H
+#define BLECONNECTIONMANAGER_H
+
+#include "PluginManager.h"
+#include "SeqLock.h"
+#include <NimBLEComm.h>
+#include <atomic>
+#include <string>
+
+constexpr unsigned long BLE_LINK_STATS_INTERVAL_MS = 5000;
+
+// Peripherals the display keeps a connection to as a central
+enum class BLELink : uint8_t { CONTROLLER, SCALE };
+constexpr size_t BLE_LINK_COUNT = 2;
+
+// How busy the machine is, decides how often the links get serviced
+enum class BLELinkProfile : uint8_t {
+    IDLE,    // standby, relaxed intervals
+    READY,   // a mode is selected, short intervals so the controller follows the UI quickly
+    PROCESS, // brewing, grinding or dispensing: short intervals and no scanning
+};
+constexpr size_t BLE_LINK_PROFILE_COUNT = 3;
+
+// Connection parameters in the units of the BLE spec: intervals in 1.25 ms, supervision timeout in 10 ms
+struct BLELinkParams {
+    uint16_t minInterval;
+    uint16_t maxInterval;
+    uint16_t latency;
+    uint16_t timeout;
+};
+
+// One link over the last BLE_LINK_STATS_INTERVAL_MS. Also the payload of "controller:bluetooth:link:stats", whose
+// "link" is the BLELink.
+struct BLELinkStats {
+    uint16_t mtu;      // 0 while disconnected
+    uint16_t interval; // negotiated connection interval in 1.25 ms
+    float notificationsPerSecond;
+    float bytesPerSecond;   // 0 for links whose library hides the payload
+    uint32_t notifications; // since the link was attached
+    uint32_t missed;        // numbered notifications that never arrived, since the link was attached
+};
+
+// Owns the connection parameters of every BLE link of the display and keeps scanning out of the way while a process
+// runs, when the radio is busiest. Scanners listen to "controller:bluetooth:scan:pause" and
+// "controller:bluetooth:scan:resume" and check isScanPaused() before starting. Call everything but the getters from the
+// main loop task.
+class BLEConnectionManager {
+  public:
+    explicit BLEConnectionManager(PluginManager *pluginManager);
+
+    // Starts managing a connected link and applies the parameters of the current profile. The client is looked up by
+    // peer address on every use since scale libraries delete theirs on disconnect. counters may be nullptr.
+    void attach(BLELink link, const std::string &address, const LinkCounters *counters);
+    void detach(BLELink link);
+
+    void setProfile(BLELinkProfile profile);
+    BLELinkProfile getProfile() const { return profile; }
+    bool isScanPaused() const { return profile == BLELinkProfile::PROCESS; }
+
+    BLELinkStats getStats(BLELink link) const { return links[static_cast<size_t>(link)].stats.load(); }
+
+    void loop();
+
+  private:
+    struct Link {
+        std::string address; // empty while detached
+        const LinkCounters *counters = nullptr;
+        uint32_t notifications = 0; // counter values at the last report
+        uint32_t bytes = 0;
+        uint32_t missed = 0;
+        BLELinkStats totals{}; // since attach, as of the last report
+        SeqLock<BLELinkStats> stats;
+    };
+
+    NimBLEClient *findClient(const Link &link) const;
+    void apply(BLELink link);
+    void report(BLELink link, unsigned long elapsed);
+
+    PluginManager *pluginManager;
+    std::atomic<BLELinkProfile> profile{BLELinkProfile::IDLE};
+    Link links[BLE_LINK_COUNT];
+    unsigned long lastReport = 0;
+};
+
+#endif // BLECONNECTIONMANAGER_H
@@ -41,6 +41,7 @@ void Controller::setup() {
     setupPanel();
 #endif
 
+    telemetry.begin();
     pluginManager = new PluginManager();
     FS *fs = &SPIFFS;
     if (sdcard) {
@@ -48,6 +49,7 @@ void Controller::setup() {
     }
     profileManager = new ProfileManager(fs, "/p", settings, pluginManager);
     profileManager->setup();
+    connectionManager = new BLEConnectionManager(pluginManager);
 #ifndef GAGGIMATE_HEADLESS
     ui = new DefaultUI(this, driver, pluginManager);
 #endif
@@ -71,14 +73,14 @@ void Controller::setup() {
     pluginManager->registerPlugin(new AutoWakeupPlugin());
     pluginManager->setup(this);
 
-    pluginManager->on("profiles:profile:save", [this](Event const &event) {
-        String id = event.getString("id");
+    pluginManager->on("profiles:profile:save"_ev, [this](Event const &event) {
+        String id = event.getString("id"_ev);
         if (id == profileManager->getSelectedProfile().id) {
             this->handleProfileUpdate();
         }
     });
 
-    pluginManager->on("profiles:profile:select", [this](Event const &event) { this->handleProfileUpdate(); });
+    pluginManager->on("profiles:profile:select"_ev, [this](Event const &event) { this->handleProfileUpdate(); });
 
 #ifndef GAGGIMATE_HEADLESS
     ui->init();
@@ -100,12 +102,12 @@ void Controller::connect() {
     if (initialized)
         return;
     lastPing = millis();
-    pluginManager->trigger("controller:startup");
+    pluginManager->trigger("controller:startup"_ev);
 
     setupWifi();
     setupBluetooth();
-    pluginManager->on("ota:update:start", [this](Event const &) { this->updating = true; });
-    pluginManager->on("ota:update:end", [this](Event const &) { this->updating = false; });
+    pluginManager->on("ota:update:start"_ev, [this](Event const &) { this->updating = true; });
+    pluginManager->on("ota:update:end"_ev, [this](Event const &) { this->updating = false; });
 
     updateLastAction();
     initialized = true;
@@ -141,15 +143,26 @@ void Controller::setupBluetooth() {
     clientController.initClient();
     clientController.registerSensorCallback(
         [this](const float temp, const float pressure, const float puckFlow, const float pumpFlow, const float puckResistance) {
-            onTempRead(temp);
-            this->pressure = pressure;
-            this->currentPuckFlow = puckFlow;
-            this->currentPumpFlow = pumpFlow;
-            pluginManager->trigger("boiler:pressure:change", "value", pressure);
-            pluginManager->trigger("pump:puck-flow:change", "value", puckFlow);
-            pluginManager->trigger("pump:flow:change", "value", pumpFlow);
-            pluginManager->trigger("pump:puck-resistance:change", "value", puckResistance);
+            SensorSnapshot snapshot{};
+            snapshot.timestamp = millis();
+            snapshot.temperature = temp - static_cast<float>(settings.getTemperatureOffset());
+            snapshot.pressure = pressure;
+            snapshot.puckFlow = puckFlow;
+            snapshot.pumpFlow = pumpFlow;
+            snapshot.puckResistance = puckResistance;
+            onSensorUpdate(snapshot);
         });
+    clientController.registerSensorBatchCallback(
+        [this](const SensorFrame *samples, const size_t count) { onSensorBatch(samples, count); });
+    clientController.registerClockSyncCallback([this](const ClockSyncStats &stats) {
+        linkStats.store(stats);
+        if (pluginManager->hasListeners("controller:link:sync"_ev)) {
+            Event event;
+            event.id = "controller:link:sync"_ev;
+            event.setPayload(stats);
+            pluginManager->trigger(event);
+        }
+    });
     clientController.registerBrewBtnCallback([this](const int brewButtonStatus) { handleBrewButton(brewButtonStatus); });
     clientController.registerSteamBtnCallback([this](const int steamButtonStatus) { handleSteamButton(steamButtonStatus); });
     clientController.registerRemoteErrorCallback([this](const int error) {
@@ -157,7 +170,7 @@ void Controller::setupBluetooth() {
             this->error = error;
             deactivate();
             setMode(MODE_STANDBY);
-            pluginManager->trigger(F("controller:error"));
+            pluginManager->trigger("controller:error"_ev);
             ESP_LOGE(LOG_TAG, "Received error %d", error);
         }
     });
@@ -166,7 +179,7 @@ void Controller::setupBluetooth() {
         char pid[30];
         snprintf(pid, sizeof(pid), "%.3f,%.3f,%.3f", Kp, Ki, Kd);
         settings.setPid(String(pid));
-        pluginManager->trigger("controller:autotune:result");
+        pluginManager->trigger("controller:autotune:result"_ev);
         autotuning = false;
     });
     clientController.registerVolumetricMeasurementCallback(
@@ -174,9 +187,9 @@ void Controller::setupBluetooth() {
     clientController.registerTofMeasurementCallback([this](const int value) {
         tofDistance = value;
         ESP_LOGV(LOG_TAG, "Received new TOF distance: %d", value);
-        pluginManager->trigger("controller:tof:change", "value", value);
+        pluginManager->trigger("controller:tof:change"_ev, "value"_ev, value);
     });
-    pluginManager->trigger("controller:bluetooth:init");
+    pluginManager->trigger("controller:bluetooth:init"_ev);
 }
 
 void Controller::setupInfos() {
@@ -196,6 +209,10 @@ void Controller::setupInfos() {
                                     .pressure = doc["cp"]["ps"].as<bool>(),
                                     .ledControl = doc["cp"]["led"].as<bool>(),
                                     .tof = doc["cp"]["tof"].as<bool>(),
+                                    .sensorFrame = doc["cp"]["sf"].as<uint8_t>(),
+                                    .sensorBatch = doc["cp"]["sb"].as<uint8_t>(),
+                                    .controlFrame = doc["cp"]["cf"].as<uint8_t>(),
+                                    .clockSync = doc["cp"]["cs"].as<uint8_t>(),
                                 }};
     }
 }
@@ -219,12 +236,13 @@ void Controller::setupWifi() {
         if (WiFi.status() == WL_CONNECTED) {
             ESP_LOGI(LOG_TAG, "Connected to %s with IP address %s", settings.getWifiSsid().c_str(),
                      WiFi.localIP().toString().c_str());
-            WiFi.onEvent([this](WiFiEvent_t, WiFiEventInfo_t) { pluginManager->trigger("controller:wifi:connect", "AP", 0); },
-                         WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_GOT_IP);
+            WiFi.onEvent(
+                [this](WiFiEvent_t, WiFiEventInfo_t) { pluginManager->trigger("controller:wifi:connect"_ev, "AP"_ev, 0); },
+                WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_GOT_IP);
             WiFi.onEvent(
                 [this](WiFiEvent_t, WiFiEventInfo_t info) {
                     ESP_LOGI(LOG_TAG, "Lost WiFi connection. Reason: %d", info.wifi_sta_disconnected.reason);
-                    pluginManager->trigger("controller:wifi:disconnect");
+                    pluginManager->trigger("controller:wifi:disconnect"_ev);
                 },
                 WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
             configTzTime(resolve_timezone(settings.getTimezone()), NTP_SERVER);
@@ -248,10 +266,10 @@ void Controller::setupWifi() {
         ESP_LOGI(LOG_TAG, "Started WiFi AP %s", WIFI_AP_SSID);
     }
 
-    pluginManager->on("ota:update:start", [this](Event const &) { this->updating = true; });
-    pluginManager->on("ota:update:end", [this](Event const &) { this->updating = false; });
+    pluginManager->on("ota:update:start"_ev, [this](Event const &) { this->updating = true; });
+    pluginManager->on("ota:update:end"_ev, [this](Event const &) { this->updating = false; });
 
-    pluginManager->trigger("controller:wifi:connect", "AP", isApConnection ? 1 : 0);
+    pluginManager->trigger("controller:wifi:connect"_ev, "AP"_ev, isApConnection ? 1 : 0);
 }
 
 void Controller::loop() {
@@ -262,9 +280,26 @@ void Controller::loop() {
     }
 
     if (clientController.isReadyForConnection()) {
-        clientController.connectToServer();
+        if (clientController.connectToServer()) {
+            connectionManager->attach(BLELink::CONTROLLER, clientController.getClient()->getPeerAddress().toString(),
+                                      &clientController.getLinkCounters());
+        }
         setupInfos();
-        pluginManager->trigger("controller:bluetooth:connect");
+        if (systemInfo.capabilities.sensorBatch == SENSOR_BATCH_VERSION) {
+            if (!clientController.useSensorBatches() && systemInfo.capabilities.sensorFrame == SENSOR_FRAME_VERSION) {
+                clientController.useSensorFrames();
+            }
+        } else if (systemInfo.capabilities.sensorFrame == SENSOR_FRAME_VERSION) {
+            clientController.useSensorFrames();
+        }
+        if (systemInfo.capabilities.controlFrame == CONTROL_FRAME_VERSION) {
+            clientController.useControlFrames();
+        }
+        if (systemInfo.capabilities.clockSync == CLOCK_SYNC_VERSION && clientController.useClockSync()) {
+            lastClockSync = millis();
+            clientController.sendClockSync();
+        }
+        pluginManager->trigger("controller:bluetooth:connect"_ev);
         if (!loaded) {
             loaded = true;
             if (settings.getStartupMode() == MODE_STANDBY)
@@ -275,7 +310,7 @@ void Controller::loop() {
             clientController.sendPidSettings(settings.getPid());
             clientController.sendPumpModelCoeffs(settings.getPumpModelCoeffs());
 
-            pluginManager->trigger("controller:ready");
+            pluginManager->trigger("controller:ready"_ev);
         }
     }
 
@@ -287,13 +322,27 @@ void Controller::loop() {
     //     clientController.sendPing();
     // }
 
+    if (now - lastClockSync > CLOCK_SYNC_INTERVAL_MS) {
+        lastClockSync = now;
+        clientController.sendClockSync();
+    }
+
+    BLELinkProfile linkProfile = BLELinkProfile::READY;
+    if (currentProcess != nullptr) {
+        linkProfile = BLELinkProfile::PROCESS;
+    } else if (mode == MODE_STANDBY) {
+        linkProfile = BLELinkProfile::IDLE;
+    }
+    connectionManager->setProfile(linkProfile);
+    connectionManager->loop();
+
     if (isErrorState()) {
         return;
     }
 
     if (now - lastProgress > PROGRESS_INTERVAL) {
         // Check if steam is ready
-        if (mode == MODE_STEAM && !steamReady && currentTemp + 5.f > getTargetTemp()) {
+        if (mode == MODE_STEAM && !steamReady && getCurrentTemp() + 5.f > getTargetTemp()) {
             activate();
             steamReady = true;
         }
@@ -301,14 +350,24 @@ void Controller::loop() {
         // Handle current process
         if (currentProcess != nullptr) {
             updateLastAction();
+            BrewProcess *brewProcess = nullptr;
+            unsigned int phaseIndex = 0;
+            ProcessPhase processPhase = ProcessPhase::RUNNING;
             if (currentProcess->getType() == MODE_BREW) {
-                auto brewProcess = static_cast<BrewProcess *>(currentProcess);
-                brewProcess->updatePressure(pressure);
-                brewProcess->updateFlow(currentPumpFlow);
+                brewProcess = static_cast<BrewProcess *>(currentProcess);
+                const SensorSnapshot snapshot = sensors.load();
+                brewProcess->updatePressure(snapshot.pressure);
+                brewProcess->updateFlow(snapshot.pumpFlow);
+                phaseIndex = brewProcess->phaseIndex;
+                processPhase = brewProcess->processPhase;
             }
             currentProcess->progress();
             if (!isActive()) {
-                deactivate();
+                deactivate(); // requests a control update itself
+            } else if (brewProcess != nullptr &&
+                       (brewProcess->phaseIndex != phaseIndex || brewProcess->processPhase != processPhase)) {
+                // Phase transitions change the pump targets, send them now instead of on the next control tick
+                requestControlUpdate();
             }
         }
 
@@ -345,6 +404,12 @@ void Controller::loopControl() {
     }
 }
 
+void Controller::requestControlUpdate() {
+    if (taskHandle != nullptr) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
 bool Controller::isUpdating() const { return updating; }
 
 bool Controller::isAutotuning() const { return autotuning; }
@@ -368,7 +433,7 @@ void Controller::autotune(int testTime, int samples) {
     }
     autotuning = true;
     clientController.sendAutotune(testTime, samples);
-    pluginManager->trigger("controller:autotune:start");
+    pluginManager->trigger("controller:autotune:start"_ev);
 }
 
 void Controller::startProcess(Process *process) {
@@ -376,8 +441,9 @@ void Controller::startProcess(Process *process) {
         return;
     processCompleted = false;
     this->currentProcess = process;
-    pluginManager->trigger("controller:process:start");
+    pluginManager->trigger("controller:process:start"_ev);
     updateLastAction();
+    requestControlUpdate();
 }
 
 float Controller::getTargetTemp() const {
@@ -399,7 +465,7 @@ float Controller::getTargetTemp() const {
 }
 
 void Controller::setTargetTemp(float temperature) {
-    pluginManager->trigger("boiler:targetTemperature:change", "value", temperature);
+    pluginManager->trigger("boiler:targetTemperature:change"_ev, "value"_ev, temperature);
     switch (mode) {
     case MODE_BREW:
     case MODE_GRIND:
@@ -413,6 +479,7 @@ void Controller::setTargetTemp(float temperature) {
         break;
     default:;
     }
+    requestControlUpdate();
     updateLastAction();
 }
 
@@ -431,14 +498,14 @@ void Controller::setPumpModelCoeffs(void) {
 int Controller::getTargetGrindDuration() const { return settings.getTargetGrindDuration(); }
 
 void Controller::setTargetGrindDuration(int duration) {
-    Event event = pluginManager->trigger("controller:grindDuration:change", "value", duration);
-    settings.setTargetGrindDuration(event.getInt("value"));
+    Event event = pluginManager->trigger("controller:grindDuration:change"_ev, "value"_ev, duration);
+    settings.setTargetGrindDuration(event.getInt("value"_ev));
     updateLastAction();
 }
 
 void Controller::setTargetGrindVolume(double volume) {
-    Event event = pluginManager->trigger("controller:grindVolume:change", "value", static_cast<float>(volume));
-    settings.setTargetGrindVolume(event.getFloat("value"));
+    Event event = pluginManager->trigger("controller:grindVolume:change"_ev, "value"_ev, static_cast<float>(volume));
+    settings.setTargetGrindVolume(event.getFloat("value"_ev));
     updateLastAction();
 }
 
@@ -505,7 +572,8 @@ void Controller::lowerGrindTarget() {
 }
 
 void Controller::updateControl() {
-    float targetTemp = getTargetTemp();
+    const float setpoint = getTargetTemp();
+    float targetTemp = setpoint;
     if (targetTemp > .0f) {
         targetTemp = targetTemp + static_cast<float>(settings.getTemperatureOffset());
     }
@@ -521,9 +589,9 @@ void Controller::updateControl() {
     clientController.sendAltControl(altRelayActive);
     if (isActive() && systemInfo.capabilities.pressure) {
         if (currentProcess->getType() == MODE_STEAM) {
-            targetPressure = settings.getSteamPumpCutoff();
-            targetFlow = currentProcess->getPumpValue() * 0.1f;
-            clientController.sendAdvancedOutputControl(false, targetTemp, false, targetPressure, targetFlow);
+            const ControlTargets targets{setpoint, settings.getSteamPumpCutoff(), currentProcess->getPumpValue() * 0.1f};
+            controlTargets.store(targets);
+            clientController.sendAdvancedOutputControl(false, targetTemp, false, targets.pressure, targets.flow);
             return;
         }
         if (currentProcess->getType() == MODE_BREW) {
@@ -532,14 +600,12 @@ void Controller::updateControl() {
                 clientController.sendAdvancedOutputControl(brewProcess->isRelayActive(), targetTemp,
                                                            brewProcess->getPumpTarget() == PumpTarget::PUMP_TARGET_PRESSURE,
                                                            brewProcess->getPumpPressure(), brewProcess->getPumpFlow());
-                targetPressure = brewProcess->getPumpPressure();
-                targetFlow = brewProcess->getPumpFlow();
+                controlTargets.store(ControlTargets{setpoint, brewProcess->getPumpPressure(), brewProcess->getPumpFlow()});
                 return;
             }
         }
     }
-    targetPressure = 0.0f;
-    targetFlow = 0.0f;
+    controlTargets.store(ControlTargets{setpoint, 0.0f, 0.0f});
     clientController.sendOutputControl(isActive() && currentProcess->isRelayActive(),
                                        isActive() ? currentProcess->getPumpValue() : 0, targetTemp);
 }
@@ -557,7 +623,7 @@ void Controller::activate() {
         currentVolumetricSource = VolumetricMeasurementSource::BLUETOOTH;
 #endif
         if (mode == MODE_BREW) {
-            pluginManager->trigger("controller:brew:prestart");
+            pluginManager->trigger("controller:brew:prestart"_ev);
         }
     }
     delay(200);
@@ -577,7 +643,7 @@ void Controller::activate() {
     default:;
     }
     if (currentProcess->getType() == MODE_BREW) {
-        pluginManager->trigger("controller:brew:start");
+        pluginManager->trigger("controller:brew:start"_ev);
     }
 }
 
@@ -589,18 +655,19 @@ void Controller::deactivate() {
     lastProcess = currentProcess;
     currentProcess = nullptr;
     if (lastProcess->getType() == MODE_BREW) {
-        pluginManager->trigger("controller:brew:end");
+        pluginManager->trigger("controller:brew:end"_ev);
     } else if (lastProcess->getType() == MODE_GRIND) {
-        pluginManager->trigger("controller:grind:end");
+        pluginManager->trigger("controller:grind:end"_ev);
     }
-    pluginManager->trigger("controller:process:end");
+    pluginManager->trigger("controller:process:end"_ev);
     updateLastAction();
+    requestControlUpdate();
 }
 
 void Controller::clear() {
     processCompleted = true;
     if (lastProcess != nullptr && lastProcess->getType() == MODE_BREW) {
-        pluginManager->trigger("controller:brew:clear");
+        pluginManager->trigger("controller:brew:clear"_ev);
     }
     delete lastProcess;
     lastProcess = nullptr;
@@ -608,7 +675,7 @@ void Controller::clear() {
 }
 
 void Controller::activateGrind() {
-    pluginManager->trigger("controller:grind:start");
+    pluginManager->trigger("controller:grind:start"_ev);
     if (isGrindActive())
         return;
     clear();
@@ -644,17 +711,116 @@ int Controller::getMode() const { return mode; }
 
 void Controller::setMode(int newMode) {
     steamReady = false;
-    Event modeEvent = pluginManager->trigger("controller:mode:change", "value", newMode);
-    mode = modeEvent.getInt("value");
+    Event modeEvent = pluginManager->trigger("controller:mode:change"_ev, "value"_ev, newMode);
+    mode = modeEvent.getInt("value"_ev);
 
     updateLastAction();
     setTargetTemp(getTargetTemp());
 }
 
-void Controller::onTempRead(float temperature) {
-    float temp = temperature - static_cast<float>(settings.getTemperatureOffset());
-    Event event = pluginManager->trigger("boiler:currentTemperature:change", "value", temp);
-    currentTemp = event.getFloat("value");
+void Controller::onSensorUpdate(const SensorSnapshot &snapshot) {
+    sensors.store(snapshot);
+    recordTelemetry(snapshot);
+
+    Event event;
+    event.id = "controller:sensor:update"_ev;
+    event.setPayload(snapshot);
+    pluginManager->trigger(event);
+
+    // Per-channel events for older listeners, only built when somebody still subscribes to them
+    const struct {
+        EventId id;
+        float value;
+    } channels[] = {
+        {"boiler:currentTemperature:change"_ev, snapshot.temperature},
+        {"boiler:pressure:change"_ev, snapshot.pressure},
+        {"pump:puck-flow:change"_ev, snapshot.puckFlow},
+        {"pump:flow:change"_ev, snapshot.pumpFlow},
+        {"pump:puck-resistance:change"_ev, snapshot.puckResistance},
+    };
+    for (const auto &channel : channels) {
+        if (pluginManager->hasListeners(channel.id)) {
+            pluginManager->trigger(channel.id, "value"_ev, channel.value);
+        }
+    }
+}
+
+void Controller::onSensorBatch(const SensorFrame *samples, size_t count) {
+    // Map controller timestamps onto ours. Controllers that answer clock sync requests get the fitted offset and drift.
+    // Until the first reply, and for older controllers, the offset of the fastest batch is used instead; it creeps up
+    // by a millisecond per batch to follow clock drift. Either way timestamps are clamped so telemetry stays ordered
+    // when the estimate moves and never lies in the future.
+    const uint32_t now = millis();
+    const ClockSync &clock = clientController.getClockSync();
+    const bool clockSynced = clock.isSynced();
+    const uint32_t measured = now - samples[count - 1].timestamp;
+    const auto deviation = static_cast<int32_t>(measured - sensorClockOffset);
+    if (clockSynced) {
+        sensorClockSynced = false;
+    } else if (!sensorClockSynced || deviation > SENSOR_CLOCK_RESYNC_MS || deviation < 0) {
+        sensorClockOffset = measured;
+        sensorClockSynced = true;
+    } else if (deviation > 0) {
+        sensorClockOffset++;
+    }
+    auto toLocal = [&](const uint32_t remote) { return clockSynced ? clock.toLocal(remote) : remote + sensorClockOffset; };
+    TelemetrySample previous{};
+    const uint32_t floor = telemetry.latest(previous) ? previous.timestamp : 0;
+    const auto offset = static_cast<float>(settings.getTemperatureOffset());
+    for (size_t i = 0; i < count; i++) {
+        SensorSnapshot snapshot{};
+        snapshot.timestamp = toLocal(samples[i].timestamp);
+        if (static_cast<int32_t>(snapshot.timestamp - now) > 0) {
+            snapshot.timestamp = now;
+        }
+        if (static_cast<int32_t>(snapshot.timestamp - floor) < 0) {
+            snapshot.timestamp = floor;
+        }
+        snapshot.temperature = samples[i].temperature - offset;
+        snapshot.pressure = samples[i].pressure;
+        snapshot.puckFlow = samples[i].puckFlow;
+        snapshot.pumpFlow = samples[i].pumpFlow;
+        snapshot.puckResistance = samples[i].puckResistance;
+        // Only the newest sample drives the events, the older ones are history by now
+        if (i + 1 < count) {
+            recordTelemetry(snapshot);
+        } else {
+            onSensorUpdate(snapshot);
+        }
+    }
+
+    // Command-to-actuation latency, measured once per command. Without clock sync the mapped actuation time includes
+    // the fastest notification delay seen, so this errs long by a connection interval at most.
+    const SensorFrame &latest = samples[count - 1];
+    uint32_t sentAt = 0;
+    if (latest.controlSequence == echoedControlSequence ||
+        !clientController.getControlSendTime(latest.controlSequence, sentAt)) {
+        return;
+    }
+    echoedControlSequence = latest.controlSequence;
+    const int latency = static_cast<int32_t>(toLocal(latest.controlTimestamp) - sentAt);
+    ESP_LOGD(LOG_TAG, "Control frame %u applied after %d ms", latest.controlSequence, latency);
+    if (pluginManager->hasListeners("controller:control-latency:change"_ev)) {
+        pluginManager->trigger("controller:control-latency:change"_ev, "value"_ev, latency > 0 ? latency : 0);
+    }
+}
+
+void Controller::recordTelemetry(const SensorSnapshot &snapshot) {
+    // Targets come from the control loop, reading them here never touches the process objects
+    const ControlTargets targets = controlTargets.load();
+    TelemetrySample sample{};
+    sample.timestamp = snapshot.timestamp;
+    sample.temperature = snapshot.temperature;
+    sample.targetTemperature = targets.temperature;
+    sample.pressure = snapshot.pressure;
+    sample.targetPressure = targets.pressure;
+    sample.puckFlow = snapshot.puckFlow;
+    sample.pumpFlow = snapshot.pumpFlow;
+    sample.targetFlow = targets.flow;
+    sample.puckResistance = snapshot.puckResistance;
+    sample.bluetoothWeight = bluetoothWeight.load(std::memory_order_relaxed);
+    sample.estimatedWeight = estimatedWeight.load(std::memory_order_relaxed);
+    telemetry.push(sample);
 }
 
 void Controller::updateLastAction() { lastAction = millis(); }
@@ -677,11 +843,14 @@ void Controller::onProfileSaveAsNew() {
 
 void Controller::onVolumetricMeasurement(double measurement, VolumetricMeasurementSource source) {
     pluginManager->trigger(source == VolumetricMeasurementSource::FLOW_ESTIMATION
-                               ? F("controller:volumetric-measurement:estimation:change")
-                               : F("controller:volumetric-measurement:bluetooth:change"),
-                           "value", static_cast<float>(measurement));
+                               ? "controller:volumetric-measurement:estimation:change"_ev
+                               : "controller:volumetric-measurement:bluetooth:change"_ev,
+                           "value"_ev, static_cast<float>(measurement));
     if (source == VolumetricMeasurementSource::BLUETOOTH) {
+        bluetoothWeight.store(static_cast<float>(measurement), std::memory_order_relaxed);
         lastBluetoothMeasurement = millis();
+    } else {
+        estimatedWeight.store(static_cast<float>(measurement), std::memory_order_relaxed);
     }
 
     if (currentVolumetricSource != source) {
@@ -707,7 +876,7 @@ void Controller::onFlush() {
     }
     clear();
     startProcess(new BrewProcess(FLUSH_PROFILE, ProcessTarget::TIME, settings.getBrewDelay()));
-    pluginManager->trigger("controller:brew:start");
+    pluginManager->trigger("controller:brew:start"_ev);
 }
 
 void Controller::handleBrewButton(int brewButtonStatus) {
@@ -770,16 +939,18 @@ void Controller::handleSteamButton(int steamButtonStatus) {
 }
 
 void Controller::handleProfileUpdate() {
-    pluginManager->trigger("boiler:targetTemperature:change", "value", profileManager->getSelectedProfile().temperature);
-    pluginManager->trigger("controller:targetDuration:change", "value", profileManager->getSelectedProfile().getTotalDuration());
-    pluginManager->trigger("controller:targetVolume:change", "value", profileManager->getSelectedProfile().getTotalVolume());
+    pluginManager->trigger("boiler:targetTemperature:change"_ev, "value"_ev, profileManager->getSelectedProfile().temperature);
+    pluginManager->trigger("controller:targetDuration:change"_ev, "value"_ev,
+                           profileManager->getSelectedProfile().getTotalDuration());
+    pluginManager->trigger("controller:targetVolume:change"_ev, "value"_ev,
+                           profileManager->getSelectedProfile().getTotalVolume());
 }
 
 void Controller::loopTask(void *arg) {
-    TickType_t lastWake = xTaskGetTickCount();
     auto *controller = static_cast<Controller *>(arg);
     while (true) {
         controller->loopControl();
-        xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(controller->getMode() == MODE_STANDBY ? 1000 : 100));
+        // Unchanged commands are only repeated as heartbeat by the client, so waking early costs no airtime
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(controller->getMode() == MODE_STANDBY ? 1000 : 100));
     }
 }
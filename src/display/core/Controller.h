@@ -1,13 +1,17 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "BLEConnectionManager.h"
 #include "NimBLEClientController.h"
 #include "NimBLEComm.h"
 #include "PluginManager.h"
+#include "SeqLock.h"
 #include "Settings.h"
+#include "TelemetryBuffer.h"
 #include <WiFi.h>
 #include <display/core/ProfileManager.h>
 #include <display/core/process/Process.h>
+#include <display/models/sensor_snapshot.h>
 #ifndef GAGGIMATE_HEADLESS
 #include <display/drivers/Driver.h>
 #include <display/ui/default/DefaultUI.h>
@@ -16,8 +20,17 @@
 const IPAddress WIFI_AP_IP(4, 4, 4, 1); // the IP address the web server, Samsung requires the IP to be in public space
 const IPAddress WIFI_SUBNET_MASK(255, 255, 255, 0); // no need to change: https://avinetworks.com/glossary/subnet-mask/
 
+// A controller clock that moved this far from the estimate restarted or reconnected, batches re-anchor on it
+constexpr int32_t SENSOR_CLOCK_RESYNC_MS = 1000;
+
 enum class VolumetricMeasurementSource { INACTIVE, FLOW_ESTIMATION, BLUETOOTH };
 
+struct ControlTargets {
+    float temperature; // setpoint without the temperature offset
+    float pressure;
+    float flow;
+};
+
 class Controller {
   public:
     Controller() = default;
@@ -38,7 +51,7 @@ class Controller {
 
     float getTargetTemp() const;
     int getTargetGrindDuration() const;
-    virtual float getCurrentTemp() const { return currentTemp; }
+    virtual float getCurrentTemp() const { return sensors.load().temperature; }
     bool isActive() const;
     bool isGrindActive() const;
     bool isUpdating() const;
@@ -46,11 +59,21 @@ class Controller {
     bool isReady() const;
     bool isVolumetricAvailable() const;
     bool isSDCard() const { return sdcard; }
-    virtual float getTargetPressure() const { return targetPressure; }
-    virtual float getTargetFlow() const { return targetFlow; }
-    virtual float getCurrentPressure() const { return pressure; }
-    virtual float getCurrentPuckFlow() const { return currentPuckFlow; }
-    virtual float getCurrentPumpFlow() const { return currentPumpFlow; }
+    virtual float getTargetPressure() const { return controlTargets.load().pressure; }
+    virtual float getTargetFlow() const { return controlTargets.load().flow; }
+    virtual float getCurrentPressure() const { return sensors.load().pressure; }
+    virtual float getCurrentPuckFlow() const { return sensors.load().puckFlow; }
+    virtual float getCurrentPumpFlow() const { return sensors.load().pumpFlow; }
+    // All channels of the latest sensor notification, read consistently from any task
+    SensorSnapshot getSensorSnapshot() const { return sensors.load(); }
+    // Recent history of all channels, one sample per sensor notification
+    const TelemetryBuffer &getTelemetry() const { return telemetry; }
+    unsigned long getLastSensorUpdate() const { return sensors.load().timestamp; }
+    // Latest scale reading as it arrives, telemetry only samples it with the controller's sensor data
+    float getBluetoothWeight() const { return bluetoothWeight.load(std::memory_order_relaxed); }
+    // Round trip, one-way latency and clock offset to the controller as of the last clock sync exchange, all zero
+    // before the first one. Also sent as the payload of "controller:link:sync".
+    ClockSyncStats getLinkStats() const { return linkStats.load(); }
 
     void autotune(int testTime, int samples);
     void startProcess(Process *process);
@@ -58,6 +81,7 @@ class Controller {
     Process *getLastProcess() const { return lastProcess; }
     Settings &getSettings() { return settings; }
     ProfileManager *getProfileManager() { return profileManager; }
+    BLEConnectionManager *getConnectionManager() { return connectionManager; }
 #ifndef GAGGIMATE_HEADLESS
     DefaultUI *getUI() const { return ui; }
 #endif
@@ -112,9 +136,13 @@ class Controller {
 
     // Functional methods
     void updateControl();
+    // Wakes the control task so changed outputs go out without waiting for the next tick
+    void requestControlUpdate();
 
     // Event handlers
-    void onTempRead(float temperature);
+    void onSensorUpdate(const SensorSnapshot &snapshot);
+    void onSensorBatch(const SensorFrame *samples, size_t count);
+    void recordTelemetry(const SensorSnapshot &snapshot);
 
     // brew button
     void handleBrewButton(int brewButtonStatus);
@@ -133,14 +161,18 @@ class Controller {
     Settings settings;
     PluginManager *pluginManager{};
     ProfileManager *profileManager{};
+    BLEConnectionManager *connectionManager{};
 
     int mode = MODE_BREW;
-    float currentTemp = 0;
-    float pressure = 0.0f;
-    float targetPressure = 0.0f;
-    float currentPuckFlow = 0.0f;
-    float currentPumpFlow = 0.0f;
-    float targetFlow = 0.0f;
+    SeqLock<SensorSnapshot> sensors;        // written by the BLE callback only
+    SeqLock<ControlTargets> controlTargets; // written by the control loop only
+    TelemetryBuffer telemetry;              // written by the BLE callback only
+    bool sensorClockSynced = false;         // BLE callback only, like the offset
+    uint32_t sensorClockOffset = 0;         // our millis() minus the controller's, lowest latency seen
+    uint16_t echoedControlSequence = 0;     // last control frame the controller reported as applied
+    SeqLock<ClockSyncStats> linkStats;      // written by the BLE callback only
+    std::atomic<float> bluetoothWeight{0.0f};
+    std::atomic<float> estimatedWeight{0.0f};
     int tofDistance = 0;
 
     SystemInfo systemInfo{};
@@ -150,6 +182,7 @@ class Controller {
 
     unsigned long grindActiveUntil = 0;
     unsigned long lastPing = 0;
+    unsigned long lastClockSync = 0;
     unsigned long lastProgress = 0;
     unsigned long lastAction = 0;
     bool loaded = false;
@@ -169,7 +202,7 @@ class Controller {
     unsigned long lastBluetoothMeasurement = 0;
     static const unsigned long BLUETOOTH_GRACE_PERIOD_MS = 1500; // 1.5 second grace period
 
-    xTaskHandle taskHandle;
+    xTaskHandle taskHandle = nullptr;
 
     static void loopTask(void *arg);
 };
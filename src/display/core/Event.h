@@ -2,64 +2,166 @@
 #define EVENT_H
 
 #include <Arduino.h>
-#include <vector>
+#include <type_traits>
 
-enum class EventDataType { EVENT_TYPE_INT, EVENT_TYPE_FLOAT, EVENT_TYPE_STRING, EVENT_TYPE_NONE };
+// FNV-1a hash of an event name
+constexpr uint32_t eventHash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash = (hash ^ static_cast<uint8_t>(*name++)) * 16777619u;
+    }
+    return hash;
+}
 
-struct EventDataEntry {
-    String key;
-    EventDataType type = EventDataType::EVENT_TYPE_NONE;
-    int intValue = 0;
-    float floatValue = 0.0f;
-    String stringValue = "";
+// Name and hash of one literal. The hash is a static constexpr member, so the compiler has to compute it.
+template <char... Chars> struct EventLiteralName {
+    static constexpr char name[] = {Chars..., '\0'};
+    static constexpr uint32_t hash = eventHash(name);
+};
 
-    EventDataEntry() = default;
+struct EventLiteral {
+    uint32_t hash;
+    const char *name;
+};
+
+// "controller:ready"_ev names an event or payload key with its hash fixed at compile time, so dispatch compares
+// integers only. Uses the GNU string literal operator template, the firmware builds with gnu++17.
+template <typename C, C... Chars> constexpr EventLiteral operator""_ev() {
+    return {EventLiteralName<Chars...>::hash, EventLiteralName<Chars...>::name};
+}
+
+// Ids and keys also convert from plain strings so plugins written against the String based bus keep compiling. Those
+// may be hashed at runtime on every call, "name"_ev is the fast path.
+struct EventId {
+    uint32_t hash = 0;
+    const char *name = ""; // only guaranteed for the duration of the call, the manager keeps its own copy
+
+    constexpr EventId() = default;
+    constexpr EventId(EventLiteral literal) : hash(literal.hash), name(literal.name) {}
+    constexpr EventId(const char *eventName) : hash(eventHash(eventName)), name(eventName) {}
+    EventId(const String &eventName) : EventId(eventName.c_str()) {}
+
+    constexpr bool operator==(const EventId &other) const { return hash == other.hash; }
+    constexpr bool operator!=(const EventId &other) const { return hash != other.hash; }
+};
 
-    EventDataEntry(const String &k, int value) : key(k), type(EventDataType::EVENT_TYPE_INT), intValue(value) {}
+// Payload keys are interned the same way, lookups compare hashes instead of strings
+struct EventKey {
+    uint32_t hash = 0;
 
-    EventDataEntry(const String &k, float value) : key(k), type(EventDataType::EVENT_TYPE_FLOAT), floatValue(value) {}
+    constexpr EventKey() = default;
+    constexpr EventKey(EventLiteral literal) : hash(literal.hash) {}
+    constexpr EventKey(const char *key) : hash(eventHash(key)) {}
+    EventKey(const String &key) : EventKey(key.c_str()) {}
 
-    EventDataEntry(const String &k, const String &value) : key(k), type(EventDataType::EVENT_TYPE_STRING), stringValue(value) {}
+    constexpr bool operator==(const EventKey &other) const { return hash == other.hash; }
 };
 
-using EventData = std::vector<EventDataEntry>;
+enum class EventDataType { EVENT_TYPE_INT, EVENT_TYPE_FLOAT, EVENT_TYPE_STRING, EVENT_TYPE_NONE };
+
+struct EventDataEntry {
+    EventKey key;
+    EventDataType type = EventDataType::EVENT_TYPE_NONE;
+    union {
+        int intValue = 0;
+        float floatValue;
+    };
+    String stringValue; // only touched for string payloads, an empty String does not allocate
+};
+
+// Events carry at most a handful of values, so the payload lives inline and triggering a numeric event never allocates
+constexpr uint8_t EVENT_DATA_CAPACITY = 4;
+constexpr uint8_t EVENT_PAYLOAD_CAPACITY = 24; // bytes of struct payload, fits a SensorSnapshot
 
 struct Event {
-    String id;
-    EventData data;
+    EventId id;
+    EventDataEntry data[EVENT_DATA_CAPACITY];
+    uint8_t dataCount = 0;
+    uint8_t payload[EVENT_PAYLOAD_CAPACITY];
+    uint8_t payloadSize = 0;
     bool stopPropagation = false;
 
-    void setInt(const String &key, int value) { data.emplace_back(key, value); }
+    // Plain structs travel by value next to the keyed data, the event id tells listeners which type to expect
+    template <typename T> void setPayload(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "event payloads are copied bytewise");
+        static_assert(sizeof(T) <= EVENT_PAYLOAD_CAPACITY, "event payload too large");
+        memcpy(payload, &value, sizeof(T));
+        payloadSize = sizeof(T);
+    }
 
-    void setFloat(const String &key, float value) { data.emplace_back(key, value); }
+    template <typename T> bool getPayload(T &value) const {
+        if (payloadSize != sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, payload, sizeof(T));
+        return true;
+    }
 
-    void setString(const String &key, const String &value) { data.emplace_back(key, value); }
+    void setInt(EventKey key, int value) {
+        if (EventDataEntry *entry = add(key, EventDataType::EVENT_TYPE_INT)) {
+            entry->intValue = value;
+        }
+    }
 
-    int getInt(const String &key) const {
-        for (const auto &entry : data) {
-            if (entry.key == key && entry.type == EventDataType::EVENT_TYPE_INT) {
-                return entry.intValue;
-            }
+    void setFloat(EventKey key, float value) {
+        if (EventDataEntry *entry = add(key, EventDataType::EVENT_TYPE_FLOAT)) {
+            entry->floatValue = value;
+        }
+    }
+
+    void setString(EventKey key, const String &value) {
+        if (EventDataEntry *entry = add(key, EventDataType::EVENT_TYPE_STRING)) {
+            entry->stringValue = value;
         }
-        return 0;
     }
 
-    float getFloat(const String &key) const {
-        for (const auto &entry : data) {
-            if (entry.key == key && entry.type == EventDataType::EVENT_TYPE_FLOAT) {
-                return entry.floatValue;
+    int getInt(EventKey key) const {
+        const EventDataEntry *entry = find(key, EventDataType::EVENT_TYPE_INT);
+        return entry != nullptr ? entry->intValue : 0;
+    }
+
+    float getFloat(EventKey key) const {
+        const EventDataEntry *entry = find(key, EventDataType::EVENT_TYPE_FLOAT);
+        return entry != nullptr ? entry->floatValue : 0.0f;
+    }
+
+    // Int or float value as float, for code that only compares magnitudes
+    float getNumber(EventKey key) const {
+        for (uint8_t i = 0; i < dataCount; i++) {
+            if (data[i].key == key && data[i].type == EventDataType::EVENT_TYPE_INT) {
+                return static_cast<float>(data[i].intValue);
+            }
+            if (data[i].key == key && data[i].type == EventDataType::EVENT_TYPE_FLOAT) {
+                return data[i].floatValue;
             }
         }
         return 0.0f;
     }
 
-    String getString(const String &key) const {
-        for (const auto &entry : data) {
-            if (entry.key == key && entry.type == EventDataType::EVENT_TYPE_STRING) {
-                return entry.stringValue;
+    String getString(EventKey key) const {
+        const EventDataEntry *entry = find(key, EventDataType::EVENT_TYPE_STRING);
+        return entry != nullptr ? entry->stringValue : "";
+    }
+
+  private:
+    EventDataEntry *add(EventKey key, EventDataType type) {
+        if (dataCount >= EVENT_DATA_CAPACITY) {
+            ESP_LOGW("Event", "Payload of %s is full, dropping value", id.name);
+            return nullptr;
+        }
+        EventDataEntry &entry = data[dataCount++];
+        entry.key = key;
+        entry.type = type;
+        return &entry;
+    }
+
+    const EventDataEntry *find(EventKey key, EventDataType type) const {
+        for (uint8_t i = 0; i < dataCount; i++) {
+            if (data[i].key == key && data[i].type == type) {
+                return &data[i];
             }
         }
-        return "";
+        return nullptr;
     }
 };
 
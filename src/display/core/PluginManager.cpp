@@ -1,15 +1,31 @@
 #include "PluginManager.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <esp_timer.h>
+
+namespace {
+size_t priorityIndex(EventDelivery delivery) { return static_cast<size_t>(delivery) - 1; }
+} // namespace
+
 void PluginManager::registerPlugin(Plugin *plugin) { plugins.push_back(plugin); }
 
 void PluginManager::setup(Controller *controller) {
     ESP_LOGV("PluginManager", "Setting up PluginManager");
-    on("system:dummy", [](const Event &) {
+    on("system:dummy"_ev, [](const Event &) {
         // Register a dummy event so the event map is initialized properly
     });
     for (const auto &plugin : plugins) {
         plugin->setup(controller, this);
     }
+    // Started after the plugins registered their listeners. Async deliveries of events triggered before this point
+    // are dropped.
+    for (auto &queue : queues) {
+        queue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(QueuedEvent));
+    }
+    xTaskCreatePinnedToCore(dispatcherTask, "PluginManager::dispatch", configMINIMAL_STACK_SIZE * 6, this,
+                            EVENT_DISPATCHER_PRIORITY, &dispatcherHandle, EVENT_DISPATCHER_CORE);
     initialized = true;
 }
 
@@ -21,19 +37,81 @@ void PluginManager::loop() {
     }
 }
 
-void PluginManager::on(const String &eventId, const EventCallback &callback) {
-    ESP_LOGV("PluginManager", "Registering listener: %s", eventId.c_str());
-    listeners[std::string(eventId.c_str())].push_back(callback);
+PluginManager::ReadGuard::ReadGuard(PluginManager &manager) : manager(manager) {
+    // Announce the reader before loading, so on() either sees it or has already published the table loaded here
+    manager.readers.fetch_add(1);
+    table = manager.table.load();
+}
+
+PluginManager::ReadGuard::~ReadGuard() { manager.readers.fetch_sub(1); }
+
+void PluginManager::on(EventId eventId, const EventCallback &callback, EventDelivery delivery, const EventPolicy &policy) {
+    ESP_LOGV("PluginManager", "Registering listener: %s", eventId.name);
+    std::lock_guard<std::mutex> lock(registrationMutex);
+    const EventTable *current = table.load();
+    auto *next = new EventTable(*current);
+    auto it = std::lower_bound(next->begin(), next->end(), eventId.hash,
+                               [](const EventListeners *entry, uint32_t hash) { return entry->hash < hash; });
+    EventListeners *entry;
+    if (it == next->end() || (*it)->hash != eventId.hash) {
+        // Names built at runtime do not outlive the call, entries keep a copy for logs and stats
+        entry = new EventListeners{eventId.hash, strdup(eventId.name), {}};
+        next->insert(it, entry);
+    } else {
+        if (strcmp((*it)->name, eventId.name) != 0) {
+            // Merging would hand one event's payload to the other's listeners, refuse the second name instead
+            ESP_LOGE("PluginManager", "Event id collision between %s and %s, listener not registered", (*it)->name,
+                     eventId.name);
+            delete next;
+            return;
+        }
+        retiredEntries.push_back(*it);
+        entry = new EventListeners(**it);
+        *it = entry;
+    }
+    entry->callbacks.push_back(new EventListener{callback, delivery, policy});
+    if (delivery != EventDelivery::SYNC) {
+        entry->asyncPriorities |= 1 << priorityIndex(delivery);
+    }
+    table.store(next);
+    retiredTables.push_back(current);
+    reclaim();
+}
+
+void PluginManager::reclaim() {
+    // Readers that start from here on load the new table. Retired ones that are still pinned wait for a later on().
+    if (readers.load() != 0) {
+        return;
+    }
+    for (const EventTable *retired : retiredTables) {
+        delete retired;
+    }
+    for (EventListeners *retired : retiredEntries) {
+        delete retired;
+    }
+    retiredTables.clear();
+    retiredEntries.clear();
 }
 
-Event PluginManager::trigger(const String &eventId) {
+EventListeners *PluginManager::findListeners(const EventTable &table, uint32_t hash) {
+    auto it = std::lower_bound(table.begin(), table.end(), hash,
+                               [](const EventListeners *entry, uint32_t value) { return entry->hash < value; });
+    return it != table.end() && (*it)->hash == hash ? *it : nullptr;
+}
+
+bool PluginManager::hasListeners(EventId eventId) {
+    ReadGuard guard(*this);
+    return findListeners(*guard.table, eventId.hash) != nullptr;
+}
+
+Event PluginManager::trigger(EventId eventId) {
     Event event;
     event.id = eventId;
     trigger(event);
     return event;
 }
 
-Event PluginManager::trigger(const String &eventId, const String &key, const String &value) {
+Event PluginManager::trigger(EventId eventId, EventKey key, const String &value) {
     Event event;
     event.id = eventId;
     event.setString(key, value);
@@ -41,7 +119,7 @@ Event PluginManager::trigger(const String &eventId, const String &key, const Str
     return event;
 }
 
-Event PluginManager::trigger(const String &eventId, const String &key, const int value) {
+Event PluginManager::trigger(EventId eventId, EventKey key, const int value) {
     Event event;
     event.id = eventId;
     event.setInt(key, value);
@@ -49,7 +127,7 @@ Event PluginManager::trigger(const String &eventId, const String &key, const int
     return event;
 }
 
-Event PluginManager::trigger(const String &eventId, const String &key, const float value) {
+Event PluginManager::trigger(EventId eventId, EventKey key, const float value) {
     Event event;
     event.id = eventId;
     event.setFloat(key, value);
@@ -58,13 +136,167 @@ Event PluginManager::trigger(const String &eventId, const String &key, const flo
 }
 
 void PluginManager::trigger(Event &event) {
-    ESP_LOGV("PluginManager", "Triggering event: %s", event.id.c_str());
-    if (listeners.count(std::string(event.id.c_str()))) {
-        for (auto const &callback : listeners[std::string(event.id.c_str())]) {
-            callback(event);
-            if (event.stopPropagation) {
-                break;
+    ESP_LOGV("PluginManager", "Triggering event: %s", event.id.name);
+    ReadGuard guard(*this);
+    EventListeners *entry = findListeners(*guard.table, event.id.hash);
+    if (entry == nullptr) {
+        return;
+    }
+    event.id.name = entry->name; // the caller's may be a temporary String, async deliveries outlive it
+#ifdef GAGGIMATE_EVENT_STATS
+    entry->triggers++;
+#endif
+    deliver(event, *entry, EventDelivery::SYNC);
+    if (entry->asyncPriorities != 0 && !event.stopPropagation) {
+        enqueue(event, *entry);
+    }
+}
+
+const EventQueueStats &PluginManager::getQueueStats(EventDelivery delivery) const {
+    static const EventQueueStats none;
+    return delivery == EventDelivery::SYNC ? none : queueStats[priorityIndex(delivery)];
+}
+
+bool EventListener::accepts(const Event &event, bool superseded) {
+    if (policy.latestOnly && superseded) {
+        return false;
+    }
+    if (policy.isStateless()) {
+        return true;
+    }
+    const uint32_t now = policy.minIntervalMs > 0 ? static_cast<uint32_t>(millis()) : 0;
+    const float value = policy.minChange > 0.0f ? event.getNumber(policy.key) : 0.0f;
+    if (delivered.load(std::memory_order_acquire)) {
+        if (policy.minIntervalMs > 0 && now - lastDeliveryMs.load(std::memory_order_relaxed) < policy.minIntervalMs) {
+            return false;
+        }
+        if (policy.minChange > 0.0f) {
+            const float last = lastValue.load(std::memory_order_relaxed);
+            float threshold = policy.relative ? policy.minChange * std::fabs(last) : policy.minChange;
+            if (std::fabs(value - last) < threshold) {
+                return false;
             }
         }
     }
+    lastDeliveryMs.store(now, std::memory_order_relaxed);
+    lastValue.store(value, std::memory_order_relaxed);
+    delivered.store(true, std::memory_order_release);
+    return true;
+}
+
+void PluginManager::deliver(Event &event, EventListeners &entry, EventDelivery delivery, bool superseded) {
+    for (EventListener *listener : entry.callbacks) {
+        if (listener->delivery != delivery || !listener->accepts(event, superseded)) {
+            continue;
+        }
+#ifdef GAGGIMATE_EVENT_STATS
+        int64_t start = esp_timer_get_time();
+        listener->callback(event);
+        listener->stats.record(static_cast<uint32_t>(esp_timer_get_time() - start));
+#else
+        listener->callback(event);
+#endif
+        if (event.stopPropagation) {
+            break;
+        }
+    }
+}
+
+void PluginManager::enqueue(Event &event, EventListeners &entry) {
+    if (dispatcherHandle == nullptr) {
+        // Triggered before setup() started the dispatcher, nothing would drain the queues yet
+        ESP_LOGW("PluginManager", "Dispatcher not running, dropping async delivery of %s", event.id.name);
+        return;
+    }
+    QueuedEvent queued{};
+    queued.id = event.id;
+    queued.dataCount = event.dataCount;
+    size_t stringsUsed = 0;
+    for (uint8_t i = 0; i < event.dataCount; i++) {
+        queued.data[i].key = event.data[i].key;
+        queued.data[i].type = event.data[i].type;
+        if (event.data[i].type != EventDataType::EVENT_TYPE_STRING) {
+            queued.data[i].intValue = event.data[i].intValue;
+            continue;
+        }
+        const String &value = event.data[i].stringValue;
+        if (value.length() > EVENT_QUEUED_STRING_CAPACITY - stringsUsed) {
+            ESP_LOGE("PluginManager", "Strings of %s exceed %u bytes, dropping async delivery", event.id.name,
+                     static_cast<unsigned>(EVENT_QUEUED_STRING_CAPACITY));
+            for (size_t priority = 0; priority < EVENT_ASYNC_PRIORITIES; priority++) {
+                if (entry.asyncPriorities & (1 << priority)) {
+                    queueStats[priority].dropped++;
+                }
+            }
+            return;
+        }
+        memcpy(queued.strings + stringsUsed, value.c_str(), value.length());
+        queued.data[i].string.offset = static_cast<uint8_t>(stringsUsed);
+        queued.data[i].string.length = static_cast<uint8_t>(value.length());
+        stringsUsed += value.length();
+    }
+    memcpy(queued.payload, event.payload, event.payloadSize);
+    queued.payloadSize = event.payloadSize;
+    queued.sequence = ++entry.sequence;
+    queued.queuedAt = esp_timer_get_time();
+    for (size_t priority = 0; priority < EVENT_ASYNC_PRIORITIES; priority++) {
+        if (!(entry.asyncPriorities & (1 << priority))) {
+            continue;
+        }
+        EventQueueStats &stats = queueStats[priority];
+        if (xQueueSend(queues[priority], &queued, 0) != pdTRUE) {
+            stats.dropped++;
+            ESP_LOGD("PluginManager", "Event queue %u full, dropping %s", static_cast<unsigned>(priority), event.id.name);
+            continue;
+        }
+        stats.maxDepth = std::max(stats.maxDepth, uxQueueMessagesWaiting(queues[priority]));
+    }
+    xTaskNotifyGive(dispatcherHandle);
+}
+
+bool PluginManager::dispatchNext() {
+    QueuedEvent queued;
+    for (size_t priority = 0; priority < EVENT_ASYNC_PRIORITIES; priority++) {
+        if (xQueueReceive(queues[priority], &queued, 0) != pdTRUE) {
+            continue;
+        }
+        EventQueueStats &stats = queueStats[priority];
+        auto latency = static_cast<uint32_t>(esp_timer_get_time() - queued.queuedAt);
+        stats.delivered++;
+        stats.totalLatencyUs += latency;
+        stats.maxLatencyUs = std::max(stats.maxLatencyUs, latency);
+
+        Event event;
+        event.id = queued.id;
+        memcpy(event.payload, queued.payload, queued.payloadSize);
+        event.payloadSize = queued.payloadSize;
+        for (uint8_t i = 0; i < queued.dataCount; i++) {
+            if (queued.data[i].type == EventDataType::EVENT_TYPE_INT) {
+                event.setInt(queued.data[i].key, queued.data[i].intValue);
+            } else if (queued.data[i].type == EventDataType::EVENT_TYPE_FLOAT) {
+                event.setFloat(queued.data[i].key, queued.data[i].floatValue);
+            } else {
+                char text[EVENT_QUEUED_STRING_CAPACITY + 1];
+                memcpy(text, queued.strings + queued.data[i].string.offset, queued.data[i].string.length);
+                text[queued.data[i].string.length] = '\0';
+                event.setString(queued.data[i].key, String(text));
+            }
+        }
+        ReadGuard guard(*this);
+        if (EventListeners *entry = findListeners(*guard.table, event.id.hash)) {
+            deliver(event, *entry, static_cast<EventDelivery>(priority + 1), queued.sequence != entry->sequence);
+        }
+        return true;
+    }
+    return false;
+}
+
+void PluginManager::dispatcherTask(void *arg) {
+    auto *manager = static_cast<PluginManager *>(arg);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // One event per pass so a burst on a lower priority never delays a higher one for long
+        while (manager->dispatchNext()) {
+        }
+    }
 }
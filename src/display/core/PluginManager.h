@@ -3,13 +3,147 @@
 #include "Event.h"
 #include "Plugin.h"
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <atomic>
 #include <functional>
-#include <map>
-#include <string>
+#include <mutex>
 #include <vector>
 
 using EventCallback = std::function<void(Event &)>;
 
+// How a listener is invoked. SYNC listeners run on the triggering task before trigger() returns, use it for anything
+// safety relevant (errors, brew start/stop). ASYNC listeners are queued and run on the dispatcher task, higher
+// priorities first.
+enum class EventDelivery : uint8_t { SYNC, ASYNC_HIGH, ASYNC, ASYNC_LOW };
+
+constexpr size_t EVENT_ASYNC_PRIORITIES = 3;
+constexpr UBaseType_t EVENT_QUEUE_LENGTH = 16;       // per priority, events are dropped when full
+constexpr BaseType_t EVENT_DISPATCHER_CORE = 1;      // away from the NimBLE host on core 0
+constexpr UBaseType_t EVENT_DISPATCHER_PRIORITY = 1; // same as the UI and control loops
+constexpr size_t EVENT_QUEUED_STRING_CAPACITY = 64;  // bytes of all string values of one queued event together
+
+// Lets the bus drop redundant deliveries before a callback runs. Interval and change limits combine, a dropped value
+// is not delivered later. Change limits compare against the value last delivered to this listener.
+struct EventPolicy {
+    uint32_t minIntervalMs = 0;
+    float minChange = 0.0f; // absolute, or a fraction of the last value when relative is set
+    bool relative = false;
+    bool latestOnly = false;   // async listeners skip queued events that a newer one of the same id has superseded
+    EventKey key = "value"_ev; // payload compared by the change limits
+
+    static EventPolicy every(uint32_t intervalMs) {
+        EventPolicy policy;
+        policy.minIntervalMs = intervalMs;
+        return policy;
+    }
+
+    static EventPolicy onChange(float change, EventKey valueKey = "value"_ev) {
+        EventPolicy policy;
+        policy.minChange = change;
+        policy.key = valueKey;
+        return policy;
+    }
+
+    static EventPolicy onRelativeChange(float fraction, EventKey valueKey = "value"_ev) {
+        EventPolicy policy = onChange(fraction, valueKey);
+        policy.relative = true;
+        return policy;
+    }
+
+    static EventPolicy latest() {
+        EventPolicy policy;
+        policy.latestOnly = true;
+        return policy;
+    }
+
+    EventPolicy &coalesce() {
+        latestOnly = true;
+        return *this;
+    }
+
+    // Interval and change limits are the only ones that keep state or read the clock
+    bool isStateless() const { return minIntervalMs == 0 && minChange <= 0.0f; }
+};
+
+#ifdef GAGGIMATE_EVENT_STATS
+// Handler timing of one listener, updated without locking so counts can be off by one under contention
+struct EventListenerStats {
+    uint32_t calls = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+
+    void record(uint32_t us) {
+        calls++;
+        totalUs += us;
+        maxUs = us > maxUs ? us : maxUs;
+    }
+};
+#endif
+
+struct EventListener {
+    EventCallback callback;
+    EventDelivery delivery;
+    EventPolicy policy;
+    // Policy state. SYNC listeners can be triggered from several tasks at once, concurrent deliveries may both pass
+    // the limits but never tear the state.
+    std::atomic<bool> delivered{false};
+    std::atomic<uint32_t> lastDeliveryMs{0};
+    std::atomic<float> lastValue{0.0f};
+#ifdef GAGGIMATE_EVENT_STATS
+    EventListenerStats stats;
+#endif
+
+    bool accepts(const Event &event, bool superseded);
+};
+
+// Listeners of one event id. Published entries are never modified except for the counters, on() replaces them.
+struct EventListeners {
+    uint32_t hash;
+    const char *name; // copied on registration, entries are never removed
+    std::vector<EventListener *> callbacks; // owned by the manager, shared by every version of the entry
+    uint8_t asyncPriorities = 0; // bit per async priority that has listeners
+    uint32_t sequence = 0;       // bumped per queued event, lets latest-only listeners spot superseded ones
+#ifdef GAGGIMATE_EVENT_STATS
+    uint32_t triggers = 0;
+#endif
+};
+
+// Sorted by hash so trigger() can binary search it. Immutable once published, see PluginManager::on().
+using EventTable = std::vector<EventListeners *>;
+
+// Plain copy of an event so it can travel through a FreeRTOS queue. Strings are stored back to back in strings.
+struct QueuedEvent {
+    EventId id;
+    struct {
+        EventKey key;
+        EventDataType type;
+        union {
+            int intValue;
+            float floatValue;
+            struct {
+                uint8_t offset;
+                uint8_t length;
+            } string;
+        };
+    } data[EVENT_DATA_CAPACITY];
+    uint8_t dataCount;
+    char strings[EVENT_QUEUED_STRING_CAPACITY];
+    uint8_t payload[EVENT_PAYLOAD_CAPACITY];
+    uint8_t payloadSize;
+    uint32_t sequence;
+    int64_t queuedAt; // esp_timer_get_time()
+};
+
+struct EventQueueStats {
+    uint32_t delivered = 0;
+    uint32_t dropped = 0;
+    UBaseType_t maxDepth = 0;
+    uint32_t maxLatencyUs = 0;
+    uint64_t totalLatencyUs = 0;
+};
+
 class Controller;
 class PluginManager {
   public:
@@ -18,18 +152,64 @@ class PluginManager {
     void setup(Controller *controller);
     void loop();
 
-    void on(const String &eventId, const EventCallback &callback);
+    // A name whose hash is already taken by a different name is logged and not registered
+    void on(EventId eventId, const EventCallback &callback, EventDelivery delivery = EventDelivery::SYNC,
+            const EventPolicy &policy = EventPolicy());
 
-    Event trigger(const String &eventId);
-    Event trigger(const String &eventId, const String &key, const String &value);
-    Event trigger(const String &eventId, const String &key, int value);
-    Event trigger(const String &eventId, const String &key, float value);
+    Event trigger(EventId eventId);
+    Event trigger(EventId eventId, EventKey key, const String &value);
+    Event trigger(EventId eventId, EventKey key, int value);
+    Event trigger(EventId eventId, EventKey key, float value);
     void trigger(Event &event);
 
+    // Lets publishers skip building events nobody listens to
+    bool hasListeners(EventId eventId);
+
+    const EventQueueStats &getQueueStats(EventDelivery delivery) const;
+#ifdef GAGGIMATE_EVENT_STATS
+    // Calls visit(const EventListeners &) for every event with at least one listener, safe from any task
+    template <typename F> void forEachListeners(F &&visit) {
+        ReadGuard guard(*this);
+        for (const EventListeners *entry : *guard.table) {
+            visit(*entry);
+        }
+    }
+#endif
+
   private:
+    // Pins the published table and the entries in it for as long as it lives. Callbacks run inside one, so they must
+    // not wait for anything that waits for on().
+    struct ReadGuard {
+        PluginManager &manager;
+        const EventTable *table;
+
+        explicit ReadGuard(PluginManager &manager);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+    };
+
+    static EventListeners *findListeners(const EventTable &table, uint32_t hash);
+    void enqueue(Event &event, EventListeners &entry);
+    void deliver(Event &event, EventListeners &entry, EventDelivery delivery, bool superseded = false);
+    bool dispatchNext();
+    void reclaim();
+
     bool initialized = false;
     std::vector<Plugin *> plugins;
-    std::map<std::string, std::vector<EventCallback>> listeners = {};
+    // Readers walk the published table without locking. on() copies it, changes the copy and swaps it in; the
+    // replaced table and entries are freed once no reader is left that could still hold them.
+    std::atomic<const EventTable *> table{new EventTable()};
+    std::atomic<uint32_t> readers{0};
+    std::mutex registrationMutex; // serializes on(), never held while a callback runs
+    std::vector<const EventTable *> retiredTables;
+    std::vector<EventListeners *> retiredEntries;
+
+    QueueHandle_t queues[EVENT_ASYNC_PRIORITIES] = {};
+    EventQueueStats queueStats[EVENT_ASYNC_PRIORITIES];
+    xTaskHandle dispatcherHandle = nullptr;
+
+    static void dispatcherTask(void *arg);
 };
 
 #endif // PLUGINMANAGER_H
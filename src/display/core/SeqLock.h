@@ -0,0 +1,59 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer, multi-reader value without mutexes. The writer bumps the sequence to an odd number, stores the value
+// and bumps it back to even; readers retry until they copied the value between two equal, even sequence numbers. The
+// value is kept in atomic words so the concurrent copy is well defined, which limits T to small trivially copyable
+// structs. Writers must not preempt each other: publish a given lock from one task only, and give that task a higher
+// priority than any reader on the same core so a spinning reader cannot starve it.
+template <typename T> class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied wordwise");
+
+  public:
+    SeqLock() { store(T{}); }
+
+    void store(const T &value) {
+        uint32_t buffer[WORDS] = {};
+        memcpy(buffer, &value, sizeof(T));
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint32_t buffer[WORDS];
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+        T value;
+        memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // Number of completed stores, lets readers skip work when nothing changed
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+  private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> words[WORDS];
+};
+
+#endif // SEQLOCK_H
@@ -54,6 +54,14 @@ Settings::Settings() {
     steamPumpPercentage = preferences.getFloat("spp", DEFAULT_STEAM_PUMP_PERCENTAGE);
     steamPumpCutoff = preferences.getFloat("spc", DEFAULT_STEAM_PUMP_CUTOFF);
     historyIndex = preferences.getInt("hi", 0);
+    historyIndexGeneration = preferences.getInt("hig", 0);
+    historySampleInterval = preferences.getInt("hsi", DEFAULT_HISTORY_SAMPLE_INTERVAL);
+    historyRetentionCount = preferences.getInt("hrc", DEFAULT_HISTORY_RETENTION_COUNT);
+    historyRetentionSize = preferences.getInt("hrs", 0);
+    historyRetentionDays = preferences.getInt("hrd", 0);
+    historySdRetentionCount = preferences.getInt("hrcs", DEFAULT_HISTORY_SD_RETENTION_COUNT);
+    historySdRetentionSize = preferences.getInt("hrss", 0);
+    historySdRetentionDays = preferences.getInt("hrds", 0);
     autowakeupEnabled = preferences.getBool("ab_en", false);
 
     // Load schedule format: "time1|days1;time2|days2" where days is 7-bit string (e.g., "1111100" for weekdays only)
@@ -413,6 +421,46 @@ void Settings::setHistoryIndex(int history_index) {
     save();
 }
 
+void Settings::setHistoryIndexGeneration(int generation) {
+    historyIndexGeneration = generation;
+    save();
+}
+
+void Settings::setHistorySampleInterval(int interval) {
+    historySampleInterval = interval;
+    save();
+}
+
+void Settings::setHistoryRetentionCount(int count) {
+    historyRetentionCount = count;
+    save();
+}
+
+void Settings::setHistoryRetentionSize(int size_kb) {
+    historyRetentionSize = size_kb;
+    save();
+}
+
+void Settings::setHistoryRetentionDays(int days) {
+    historyRetentionDays = days;
+    save();
+}
+
+void Settings::setHistorySdRetentionCount(int count) {
+    historySdRetentionCount = count;
+    save();
+}
+
+void Settings::setHistorySdRetentionSize(int size_kb) {
+    historySdRetentionSize = size_kb;
+    save();
+}
+
+void Settings::setHistorySdRetentionDays(int days) {
+    historySdRetentionDays = days;
+    save();
+}
+
 void Settings::setSunriseR(int sunrise_r) {
     sunriseR = sunrise_r;
     save();
@@ -516,6 +564,14 @@ void Settings::doSave() {
     preferences.putFloat("spp", steamPumpPercentage);
     preferences.putFloat("spc", steamPumpCutoff);
     preferences.putInt("hi", historyIndex);
+    preferences.putInt("hig", historyIndexGeneration);
+    preferences.putInt("hsi", historySampleInterval);
+    preferences.putInt("hrc", historyRetentionCount);
+    preferences.putInt("hrs", historyRetentionSize);
+    preferences.putInt("hrd", historyRetentionDays);
+    preferences.putInt("hrcs", historySdRetentionCount);
+    preferences.putInt("hrss", historySdRetentionSize);
+    preferences.putInt("hrds", historySdRetentionDays);
     preferences.putBool("ab_en", autowakeupEnabled);
 
     // Save schedule format
@@ -107,6 +107,14 @@ class Settings {
     float getSteamPumpCutoff() const { return steamPumpCutoff; }
     int getThemeMode() const { return themeMode; }
     int getHistoryIndex() const { return historyIndex; }
+    int getHistoryIndexGeneration() const { return historyIndexGeneration; }
+    int getHistorySampleInterval() const { return historySampleInterval; }
+    int getHistoryRetentionCount() const { return historyRetentionCount; }
+    int getHistoryRetentionSize() const { return historyRetentionSize; }
+    int getHistoryRetentionDays() const { return historyRetentionDays; }
+    int getHistorySdRetentionCount() const { return historySdRetentionCount; }
+    int getHistorySdRetentionSize() const { return historySdRetentionSize; }
+    int getHistorySdRetentionDays() const { return historySdRetentionDays; }
     int getSunriseR() const { return sunriseR; }
     int getSunriseG() const { return sunriseG; }
     int getSunriseB() const { return sunriseB; }
@@ -172,6 +180,14 @@ class Settings {
     void setSteamPumpCutoff(float steam_pump_cutoff);
     void setThemeMode(int theme_mode);
     void setHistoryIndex(int history_index);
+    void setHistoryIndexGeneration(int generation);
+    void setHistorySampleInterval(int interval);
+    void setHistoryRetentionCount(int count);
+    void setHistoryRetentionSize(int size_kb);
+    void setHistoryRetentionDays(int days);
+    void setHistorySdRetentionCount(int count);
+    void setHistorySdRetentionSize(int size_kb);
+    void setHistorySdRetentionDays(int days);
     void setSunriseR(int sunrise_r);
     void setSunriseG(int sunrise_g);
     void setSunriseB(int sunrise_b);
@@ -232,6 +248,15 @@ class Settings {
     float steamPumpPercentage = DEFAULT_STEAM_PUMP_PERCENTAGE;
     float steamPumpCutoff = DEFAULT_STEAM_PUMP_CUTOFF;
     int historyIndex = 0;
+    int historyIndexGeneration = 0; // mirrors ShotIndexHeader::generation
+    int historySampleInterval = DEFAULT_HISTORY_SAMPLE_INTERVAL;
+    // Shot history retention, 0 disables a limit. Sizes in KB.
+    int historyRetentionCount = DEFAULT_HISTORY_RETENTION_COUNT;
+    int historyRetentionSize = 0;
+    int historyRetentionDays = 0;
+    int historySdRetentionCount = DEFAULT_HISTORY_SD_RETENTION_COUNT;
+    int historySdRetentionSize = 0;
+    int historySdRetentionDays = 0;
 
     // Deprecated, use profiles
     int targetBrewTemp = 93;
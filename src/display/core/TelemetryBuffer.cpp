@@ -0,0 +1,70 @@
+#include "TelemetryBuffer.h"
+
+#include <cstring>
+
+void TelemetryBuffer::begin() {
+    slots = psramFound() ? TELEMETRY_BUFFER_SAMPLES : TELEMETRY_BUFFER_FALLBACK_SAMPLES;
+    words = decltype(words)(slots * WORDS);
+    ESP_LOGI("TelemetryBuffer", "Keeping %u telemetry samples", static_cast<unsigned>(slots));
+}
+
+void TelemetryBuffer::push(const TelemetrySample &sample) {
+    if (slots == 0) {
+        return;
+    }
+    uint32_t buffer[WORDS];
+    memcpy(buffer, &sample, sizeof(sample));
+    // Same protocol as SeqLock: announce the slot before touching it so readers of the old sample notice
+    uint32_t index = claimed.load(std::memory_order_relaxed);
+    claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t base = (index % slots) * WORDS;
+    for (size_t i = 0; i < WORDS; i++) {
+        words[base + i].store(buffer[i], std::memory_order_relaxed);
+    }
+    written.store(index + 1, std::memory_order_release);
+}
+
+uint32_t TelemetryBuffer::oldest() const {
+    uint32_t last = end();
+    return last > slots ? last - slots : 0;
+}
+
+bool TelemetryBuffer::read(uint32_t index, TelemetrySample &sample) const {
+    uint32_t last = end();
+    if (slots == 0 || index >= last || last - index > slots) {
+        return false;
+    }
+    uint32_t buffer[WORDS];
+    size_t base = (index % slots) * WORDS;
+    for (size_t i = 0; i < WORDS; i++) {
+        buffer[i] = words[base + i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (claimed.load(std::memory_order_relaxed) - index > slots) {
+        return false; // overwritten while copying
+    }
+    memcpy(&sample, buffer, sizeof(sample));
+    return true;
+}
+
+bool TelemetryBuffer::latest(TelemetrySample &sample) const {
+    uint32_t last = end();
+    return last != 0 && read(last - 1, sample);
+}
+
+uint32_t TelemetryBuffer::find(uint32_t fromMs) const {
+    uint32_t low = oldest();
+    uint32_t high = end();
+    TelemetrySample sample{};
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        // Overwritten slots are older than anything still in the buffer
+        if (!read(middle, sample) || static_cast<int32_t>(sample.timestamp - fromMs) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
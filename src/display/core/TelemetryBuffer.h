@@ -0,0 +1,71 @@
+#ifndef TELEMETRYBUFFER_H
+#define TELEMETRYBUFFER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <display/core/utils.h>
+#include <vector>
+
+constexpr size_t TELEMETRY_BUFFER_SAMPLES = 4000;         // two minutes of 30ms control cycles
+constexpr size_t TELEMETRY_BUFFER_FALLBACK_SAMPLES = 800; // without PSRAM, still covers the UI's stability window
+
+// Every channel at the time of one sensor sample
+struct TelemetrySample {
+    uint32_t timestamp; // millis()
+    float temperature;
+    float targetTemperature;
+    float pressure;
+    float targetPressure;
+    float puckFlow;
+    float pumpFlow;
+    float targetFlow;
+    float puckResistance;
+    float bluetoothWeight;
+    float estimatedWeight;
+};
+
+// Fixed-size history of TelemetrySamples, written by one task and read lock-free by any number of others. Samples are
+// addressed by a running index: [oldest(), end()) are available, and read() fails for a slot that was overwritten while
+// it was being copied, so readers that fall behind just skip ahead.
+class TelemetryBuffer {
+  public:
+    void begin();
+    void push(const TelemetrySample &sample);
+
+    uint32_t end() const { return written.load(std::memory_order_acquire); }
+    uint32_t oldest() const;
+    size_t capacity() const { return slots; }
+
+    bool read(uint32_t index, TelemetrySample &sample) const;
+    bool latest(TelemetrySample &sample) const;
+    // First index with a timestamp at or after fromMs, end() when there is none
+    uint32_t find(uint32_t fromMs) const;
+
+    // Calls visit(const TelemetrySample &) for every sample in [fromMs, toMs], oldest first
+    template <typename F> size_t forEach(uint32_t fromMs, uint32_t toMs, F &&visit) const {
+        size_t visited = 0;
+        TelemetrySample sample{};
+        for (uint32_t index = find(fromMs), last = end(); index != last; index++) {
+            if (!read(index, sample)) {
+                continue;
+            }
+            if (static_cast<int32_t>(sample.timestamp - toMs) > 0) {
+                break;
+            }
+            visit(sample);
+            visited++;
+        }
+        return visited;
+    }
+
+  private:
+    static constexpr size_t WORDS = sizeof(TelemetrySample) / sizeof(uint32_t);
+    static_assert(sizeof(TelemetrySample) % sizeof(uint32_t) == 0, "samples are stored as whole words");
+
+    std::vector<std::atomic<uint32_t>, PsramAllocator<std::atomic<uint32_t>>> words;
+    size_t slots = 0;
+    std::atomic<uint32_t> claimed{0}; // index + 1 of the slot being written
+    std::atomic<uint32_t> written{0}; // index + 1 of the last complete slot
+};
+
+#endif // TELEMETRYBUFFER_H
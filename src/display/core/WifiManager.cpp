@@ -22,7 +22,7 @@ void WifiManager::wifiEventHandler(void *arg, esp_event_base_t event_base, int32
             ESP_LOGI("WifiManager", "WiFi disconnected. Reason: %d\n", event->reason);
             xEventGroupClearBits(manager->wifiEventGroup, WIFI_CONNECTED_BIT);
             xEventGroupSetBits(manager->wifiEventGroup, WIFI_FAIL_BIT);
-            manager->pluginManager->trigger("controller:wifi:disconnect");
+            manager->pluginManager->trigger("controller:wifi:disconnect"_ev);
             break;
         }
         }
@@ -31,7 +31,7 @@ void WifiManager::wifiEventHandler(void *arg, esp_event_base_t event_base, int32
         ESP_LOGI("WifiManager", "Got IP: " IPSTR "\n", IP2STR(&event->ip_info.ip));
         xEventGroupSetBits(manager->wifiEventGroup, WIFI_CONNECTED_BIT);
         xEventGroupClearBits(manager->wifiEventGroup, WIFI_FAIL_BIT);
-        manager->pluginManager->trigger("controller:wifi:connect", "AP", 0);
+        manager->pluginManager->trigger("controller:wifi:connect"_ev, "AP"_ev, 0);
         if (manager->isAPActive) {
             manager->stopAP();
         }
@@ -85,7 +85,7 @@ void WifiManager::wifiTask(void *parameter) {
                 xEventGroupSetBits(manager->wifiEventGroup, WIFI_CONNECTED_BIT);
                 xEventGroupClearBits(manager->wifiEventGroup, WIFI_FAIL_BIT);
                 attempts = 0;
-                manager->pluginManager->trigger("controller:wifi:connect", "AP", manager->isAPActive ? 1 : 0);
+                manager->pluginManager->trigger("controller:wifi:connect"_ev, "AP"_ev, manager->isAPActive ? 1 : 0);
             }
 
             // If connected and AP is active, check timeout
@@ -99,7 +99,7 @@ void WifiManager::wifiTask(void *parameter) {
                 // Just disconnected
                 xEventGroupClearBits(manager->wifiEventGroup, WIFI_CONNECTED_BIT);
                 xEventGroupSetBits(manager->wifiEventGroup, WIFI_FAIL_BIT);
-                manager->pluginManager->trigger("controller:wifi:disconnect");
+                manager->pluginManager->trigger("controller:wifi:disconnect"_ev);
             }
         }
 
@@ -161,7 +161,7 @@ void WifiManager::startAP() {
         ESP_LOGI("WifiManager", "AP '%s' started. Will timeout in %d seconds\n", config.apSSID.c_str(),
                  config.apTimeoutMs / 1000);
 
-        pluginManager->trigger("controller:wifi:connect", "AP", 1);
+        pluginManager->trigger("controller:wifi:connect"_ev, "AP"_ev, 1);
     }
 }
 
@@ -170,6 +170,6 @@ void WifiManager::stopAP() {
         ESP_LOGI("WifiManager", "Stopping AP mode");
         WiFi.softAPdisconnect(true);
         isAPActive = false;
-        pluginManager->trigger("controller:wifi:disconnect");
+        pluginManager->trigger("controller:wifi:disconnect"_ev);
     }
 }
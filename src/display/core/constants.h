@@ -37,6 +37,16 @@
 #define ALT_RELAY_GRIND 1
 #define ALT_RELAY_STEAM_BOILER 2
 
+// Shot history recording rate (ms between samples, 0 = every sensor notification)
+#define HISTORY_SAMPLE_INTERVAL_SENSOR 0
+#define HISTORY_SAMPLE_INTERVAL_10HZ 100
+#define HISTORY_SAMPLE_INTERVAL_4HZ 250
+#define DEFAULT_HISTORY_SAMPLE_INTERVAL HISTORY_SAMPLE_INTERVAL_4HZ
+
+// Shot history retention defaults (shots kept on internal flash / SD card)
+#define DEFAULT_HISTORY_RETENTION_COUNT 100
+#define DEFAULT_HISTORY_SD_RETENTION_COUNT 1000
+
 #define WIFI_CONNECT_TIMEOUT_MS 30000
 #define DEFAULT_WIFI_AP_TIMEOUT_MS 600000
 
@@ -5,15 +5,14 @@
 #include <display/core/constants.h>
 #include <display/core/predictive.h>
 #include <display/core/process/Process.h>
-#include <display/models/profile.h>
+#include <display/models/profile_plan.h>
 
 class BrewProcess : public Process {
   public:
-    Profile profile;
+    ProfilePlan plan{};
     ProcessTarget target;
     double brewDelay;
     unsigned int phaseIndex = 0;
-    Phase currentPhase;
     ProcessPhase processPhase = ProcessPhase::RUNNING;
     unsigned long processStarted = 0;
     unsigned long currentPhaseStarted = 0;
@@ -25,16 +24,23 @@ class BrewProcess : public Process {
     float waterPumped = 0.0f;
     VolumetricRateCalculator volumetricRateCalculator{PREDICTIVE_TIME};
 
-    explicit BrewProcess(Profile profile, ProcessTarget target, double brewDelay = 0.0)
-        : profile(profile), target(target), brewDelay(brewDelay) {
-        currentPhase = profile.phases.at(phaseIndex);
+    explicit BrewProcess(const Profile &profile, ProcessTarget target, double brewDelay = 0.0)
+        : target(target), brewDelay(brewDelay) {
+        compileProfile(profile, plan);
         processStarted = millis();
         currentPhaseStarted = millis();
-        phaseStartPressure = currentPhase.transition.adaptive ? currentPressure : 0;
-        phaseStartFlow = currentPhase.transition.adaptive ? currentFlow : 0;
+        if (plan.phaseCount == 0) {
+            ESP_LOGE("BrewProcess", "Profile %s has no phases", profile.label.c_str());
+            processPhase = ProcessPhase::FINISHED;
+            finished = millis();
+        }
+        phaseStartPressure = currentPhase().adaptive ? currentPressure : 0;
+        phaseStartFlow = currentPhase().adaptive ? currentFlow : 0;
         computeEffectiveTargetsForCurrentPhase();
     }
 
+    const PhasePlan &currentPhase() const { return plan.phases[phaseIndex]; }
+
     void updateVolume(double volume) override { // called even after the Process is no longer active
         currentVolume = volume;
         if (processPhase != ProcessPhase::FINISHED) { // only store measurements while active
@@ -46,9 +52,9 @@ class BrewProcess : public Process {
 
     void updateFlow(float flow) { currentFlow = flow; }
 
-    unsigned long getTotalDuration() const { return profile.getTotalDuration() * 1000L; }
+    unsigned long getTotalDuration() const { return plan.totalDurationMs; }
 
-    unsigned long getPhaseDuration() const { return static_cast<long>(currentPhase.duration) * 1000L; }
+    unsigned long getPhaseDuration() const { return currentPhase().durationMs; }
 
     bool isCurrentPhaseFinished() {
         if (millis() - currentPhaseStarted > BREW_SAFETY_DURATION_MS) {
@@ -62,22 +68,13 @@ class BrewProcess : public Process {
             volume = currentVolume + predictedAddedVolume;
         }
         float timeInPhase = static_cast<float>(millis() - currentPhaseStarted) / 1000.0f;
-        return currentPhase.isFinished(target == ProcessTarget::VOLUMETRIC, volume, timeInPhase, currentFlow, currentPressure,
-                                       waterPumped, profile.type);
+        return plan.isPhaseFinished(currentPhase(), target == ProcessTarget::VOLUMETRIC, volume, timeInPhase, currentFlow,
+                                    currentPressure, waterPumped);
     }
 
-    bool isUtility() const { return profile.utility; }
+    bool isUtility() const { return plan.utility; }
 
-    double getBrewVolume() const {
-        double brewVolume = 0;
-        for (const auto &phase : profile.phases) {
-            if (phase.hasVolumetricTarget()) {
-                Target target = phase.getVolumetricTarget();
-                brewVolume = target.value;
-            }
-        }
-        return brewVolume;
-    }
+    double getBrewVolume() const { return plan.brewVolume; }
 
     double getNewDelayTime() {
         double newDelay = brewDelay + volumetricRateCalculator.getOvershootAdjustMillis(getBrewVolume(), currentVolume);
@@ -89,7 +86,7 @@ class BrewProcess : public Process {
         if (processPhase == ProcessPhase::FINISHED) {
             return false;
         }
-        return currentPhase.valve;
+        return currentPhase().valve;
     }
 
     bool isAltRelayActive() override { return false; }
@@ -98,12 +95,12 @@ class BrewProcess : public Process {
         if (processPhase == ProcessPhase::FINISHED) {
             return 0.0f;
         }
-        return currentPhase.pumpIsSimple ? currentPhase.pumpSimple : 100.0f;
+        return currentPhase().pumpValue;
     }
 
-    bool isAdvancedPump() const { return processPhase != ProcessPhase::FINISHED && !currentPhase.pumpIsSimple; }
+    bool isAdvancedPump() const { return processPhase != ProcessPhase::FINISHED && currentPhase().advancedPump; }
 
-    [[nodiscard]] PumpTarget getPumpTarget() const { return currentPhase.pumpAdvanced.target; }
+    [[nodiscard]] PumpTarget getPumpTarget() const { return currentPhase().pumpTarget; }
 
     float getPumpPressure() const {
         if (!isAdvancedPump())
@@ -123,25 +120,19 @@ class BrewProcess : public Process {
         return startVal + (endVal - startVal) * a;
     }
 
-    float getTemperature() const {
-        if (currentPhase.temperature > 0.0f) {
-            return currentPhase.temperature;
-        }
-        return profile.temperature;
-    }
+    float getTemperature() const { return currentPhase().temperature; }
 
     void progress() override {
         // Progress should be called around every 100ms, as defined in PROGRESS_INTERVAL, while the Process is active
         waterPumped += currentFlow / 10.0f; // Add current flow divided to 100ms to water pumped counter
         while (isCurrentPhaseFinished() && processPhase == ProcessPhase::RUNNING) {
             previousPhaseFinished = millis();
-            if (phaseIndex + 1 < profile.phases.size()) {
+            if (phaseIndex + 1 < plan.phaseCount) {
                 waterPumped = 0.0f;
+                const PhasePlan &nextPhase = plan.phases[phaseIndex + 1];
+                phaseStartPressure = nextPhase.adaptive ? currentPressure : getPumpPressure();
+                phaseStartFlow = nextPhase.adaptive ? currentFlow : getPumpFlow();
                 phaseIndex++;
-                Phase nextPhase = profile.phases.at(phaseIndex);
-                phaseStartPressure = nextPhase.transition.adaptive ? currentPressure : getPumpPressure();
-                phaseStartFlow = nextPhase.transition.adaptive ? currentFlow : getPumpFlow();
-                currentPhase = nextPhase;
                 currentPhaseStarted = millis();
                 computeEffectiveTargetsForCurrentPhase();
             } else {
@@ -169,61 +160,25 @@ class BrewProcess : public Process {
     float effectivePressure = 0.0f;
     float effectiveFlow = 0.0f;
 
-    static float easeLinear(float t) { return t; }
-    static float easeIn(float t) { return t * t; }
-    static float easeOut(float t) { return 1.0f - (1.0f - t) * (1.0f - t); }
-    static float easeInOut(float t) { return (t < 0.5f) ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t); }
-
-    float applyEasing(float t, TransitionType type) const {
-        if (t <= 0.0f)
-            return 0.0f;
-        if (t >= 1.0f)
-            return 1.0f;
-        switch (type) {
-        case TransitionType::LINEAR:
-            return easeLinear(t);
-        case TransitionType::EASE_IN:
-            return easeIn(t);
-        case TransitionType::EASE_OUT:
-            return easeOut(t);
-        case TransitionType::EASE_IN_OUT:
-            return easeInOut(t);
-        case TransitionType::INSTANT:
-        default:
-            return 1.0f;
-        }
-    }
-
     void computeEffectiveTargetsForCurrentPhase() {
-        if (currentPhase.pumpIsSimple) {
+        const PhasePlan &phase = currentPhase();
+        if (!phase.advancedPump) {
             effectivePressure = 0.0f;
             effectiveFlow = 0.0f;
             return;
         }
 
         // If the profile requests -1, use the *measured* value at the moment the phase starts.
-        effectivePressure =
-            (currentPhase.pumpAdvanced.pressure == -1.0f) ? phaseStartPressure : currentPhase.pumpAdvanced.pressure;
-        effectiveFlow = (currentPhase.pumpAdvanced.flow == -1.0f) ? phaseStartFlow : currentPhase.pumpAdvanced.flow;
-        if (currentPhase.pumpAdvanced.target == PumpTarget::PUMP_TARGET_FLOW) {
+        effectivePressure = (phase.pressure == -1.0f) ? phaseStartPressure : phase.pressure;
+        effectiveFlow = (phase.flow == -1.0f) ? phaseStartFlow : phase.flow;
+        if (phase.pumpTarget == PumpTarget::PUMP_TARGET_FLOW) {
             phaseStartPressure = effectivePressure;
         } else {
             phaseStartFlow = effectiveFlow;
         }
     }
 
-    float transitionAlpha() const {
-        float dur_s = currentPhase.transition.duration;
-        if (dur_s <= 0.0f) {
-            dur_s = currentPhase.duration; // If the transition has no duration, use the phase duration
-        }
-        if (currentPhase.transition.type == TransitionType::INSTANT || dur_s <= 0.0f) {
-            return 1.0f;
-        }
-        const unsigned long elapsedMs = millis() - currentPhaseStarted;
-        float t = float(elapsedMs) / (dur_s * 1000.0f);
-        return applyEasing(t, currentPhase.transition.type);
-    }
+    float transitionAlpha() const { return currentPhase().transitionAlpha(millis() - currentPhaseStarted); }
 };
 
 #endif // BREWPROCESS_H
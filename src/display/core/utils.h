@@ -3,6 +3,7 @@
 #define UTILS_H
 #include <Arduino.h>
 #include <memory>
+#include <new>
 
 template <typename T, typename... Args> std::unique_ptr<T> make_unique(Args &&...args) {
     return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
@@ -19,6 +20,30 @@ template <typename... Args> std::string string_format(const std::string &format,
     return std::string(buf.get(), buf.get() + size - 1); // We don't want the '\0' inside
 }
 
+// Allocator for containers that may grow large; prefers PSRAM and falls back to the internal heap.
+template <typename T> struct PsramAllocator {
+    using value_type = T;
+
+    PsramAllocator() = default;
+    template <typename U> PsramAllocator(const PsramAllocator<U> &) noexcept {}
+
+    T *allocate(size_t n) {
+        void *p = ps_malloc(n * sizeof(T));
+        if (p == nullptr) {
+            p = malloc(n * sizeof(T));
+        }
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t) noexcept { free(p); }
+};
+
+template <typename T, typename U> bool operator==(const PsramAllocator<T> &, const PsramAllocator<U> &) { return true; }
+template <typename T, typename U> bool operator!=(const PsramAllocator<T> &, const PsramAllocator<U> &) { return false; }
+
 extern uint8_t randomByte();
 extern String generateShortID(uint8_t length = 10);
 extern std::vector<String> explode(const String &input, char delim);
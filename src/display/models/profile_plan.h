@@ -0,0 +1,164 @@
+#ifndef PROFILE_PLAN_H
+#define PROFILE_PLAN_H
+
+#include <display/models/profile.h>
+
+constexpr uint8_t PROFILE_PLAN_MAX_PHASES = 24;
+constexpr uint8_t PROFILE_PLAN_MAX_TARGETS = 64; // shared by all phases
+constexpr size_t PROFILE_PLAN_NAME_LENGTH = 32;  // including the terminator, longer phase names are cut
+
+using EasingFunction = float (*)(float);
+
+namespace easing {
+inline float linear(float t) { return t; }
+inline float in(float t) { return t * t; }
+inline float out(float t) { return 1.0f - (1.0f - t) * (1.0f - t); }
+inline float inOut(float t) { return (t < 0.5f) ? 2.0f * t * t : 1.0f - 2.0f * (1.0f - t) * (1.0f - t); }
+} // namespace easing
+
+// One phase of a compiled profile with everything the brew loop asks for resolved up front
+struct PhasePlan {
+    char name[PROFILE_PLAN_NAME_LENGTH];
+    PhaseType phase;
+    bool valve;
+    bool advancedPump;
+    float pumpValue;   // percent, 100 for advanced phases
+    float temperature; // phase temperature, or the profile temperature when the phase has none
+    float duration;    // seconds
+    unsigned long durationMs;
+    EasingFunction easing; // nullptr for instant transitions
+    float transitionMs;    // transition length, the phase duration when the transition has none
+    bool adaptive;         // transition starts from the measured values
+    PumpTarget pumpTarget;
+    float pressure;      // -1 for the pressure measured when the phase starts
+    float flow;          // -1 for the flow measured when the phase starts
+    uint8_t firstTarget; // index into ProfilePlan::targets
+    uint8_t targetCount;
+    bool volumetric;        // has a volumetric target above zero
+    float volumetricTarget; // value of the first volumetric target
+    bool waitsForVolume;    // standard profiles ignore the duration while a volumetric target is watched
+
+    // Eased progress through the transition, from 0 at the phase start to 1
+    float transitionAlpha(unsigned long elapsedMs) const {
+        if (easing == nullptr) {
+            return 1.0f;
+        }
+        float t = float(elapsedMs) / transitionMs;
+        if (t <= 0.0f)
+            return 0.0f;
+        if (t >= 1.0f)
+            return 1.0f;
+        return easing(t);
+    }
+};
+
+// Flat, allocation free form of a Profile. Compiled when a brew starts so the 100ms progress loop only reads plain
+// values instead of walking vectors and comparing Strings.
+struct ProfilePlan {
+    PhasePlan phases[PROFILE_PLAN_MAX_PHASES];
+    uint8_t phaseCount;
+    Target targets[PROFILE_PLAN_MAX_TARGETS];
+    uint8_t targetCount;
+    bool utility;
+    float temperature;
+    unsigned long totalDurationMs;
+    double brewVolume; // volumetric target of the last phase that has one
+
+    bool isPhaseFinished(const PhasePlan &phase, bool enableVolumetric, float volume, float timeInPhase, float flow,
+                         float pressure, float waterPumped) const {
+        // Indexed by TargetType
+        const float inputs[] = {volume, pressure, flow, waterPumped};
+        const Target *target = &targets[phase.firstTarget];
+        for (uint8_t i = 0; i < phase.targetCount; i++, target++) {
+            if (target->type == TargetType::TARGET_TYPE_VOLUMETRIC && !enableVolumetric) {
+                continue;
+            }
+            if (target->isReached(inputs[static_cast<size_t>(target->type)])) {
+                return true;
+            }
+        }
+        if (enableVolumetric && phase.waitsForVolume) {
+            return false;
+        }
+        return timeInPhase > phase.duration;
+    }
+};
+
+inline EasingFunction compileEasing(TransitionType type) {
+    switch (type) {
+    case TransitionType::LINEAR:
+        return easing::linear;
+    case TransitionType::EASE_IN:
+        return easing::in;
+    case TransitionType::EASE_OUT:
+        return easing::out;
+    case TransitionType::EASE_IN_OUT:
+        return easing::inOut;
+    case TransitionType::INSTANT:
+    default:
+        return nullptr;
+    }
+}
+
+// Phases and targets beyond the plan limits are dropped with a warning
+inline void compileProfile(const Profile &profile, ProfilePlan &plan) {
+    plan.phaseCount = 0;
+    plan.targetCount = 0;
+    plan.utility = profile.utility;
+    plan.temperature = profile.temperature;
+    plan.totalDurationMs = profile.getTotalDuration() * 1000L;
+    plan.brewVolume = 0;
+    const bool standard = profile.type == "standard";
+    size_t droppedTargets = 0;
+
+    for (const Phase &phase : profile.phases) {
+        if (plan.phaseCount >= PROFILE_PLAN_MAX_PHASES) {
+            ESP_LOGW("ProfilePlan", "Profile %s has more than %u phases, ignoring the rest", profile.label.c_str(),
+                     PROFILE_PLAN_MAX_PHASES);
+            break;
+        }
+        PhasePlan &planned = plan.phases[plan.phaseCount++];
+        strncpy(planned.name, phase.name.c_str(), sizeof(planned.name) - 1);
+        planned.name[sizeof(planned.name) - 1] = '\0';
+        planned.phase = phase.phase;
+        planned.valve = phase.valve != 0;
+        planned.advancedPump = !phase.pumpIsSimple;
+        planned.pumpValue = phase.pumpIsSimple ? phase.pumpSimple : 100.0f;
+        planned.temperature = phase.temperature > 0.0f ? phase.temperature : profile.temperature;
+        planned.duration = phase.duration;
+        planned.durationMs = static_cast<long>(phase.duration) * 1000L;
+
+        float transitionDuration = phase.transition.duration > 0.0f ? phase.transition.duration : phase.duration;
+        planned.easing = transitionDuration > 0.0f ? compileEasing(phase.transition.type) : nullptr;
+        planned.transitionMs = transitionDuration * 1000.0f;
+        planned.adaptive = phase.transition.adaptive;
+        planned.pumpTarget = phase.pumpAdvanced.target;
+        planned.pressure = phase.pumpAdvanced.pressure;
+        planned.flow = phase.pumpAdvanced.flow;
+
+        planned.firstTarget = plan.targetCount;
+        planned.targetCount = 0;
+        bool watchesVolume = false;
+        for (const Target &target : phase.targets) {
+            watchesVolume |= target.type == TargetType::TARGET_TYPE_VOLUMETRIC;
+            if (plan.targetCount >= PROFILE_PLAN_MAX_TARGETS) {
+                droppedTargets++;
+                continue;
+            }
+            plan.targets[plan.targetCount++] = target;
+            planned.targetCount++;
+        }
+        planned.volumetric = phase.hasVolumetricTarget();
+        planned.volumetricTarget = phase.getVolumetricTarget().value;
+        planned.waitsForVolume = standard && watchesVolume;
+        if (planned.volumetric) {
+            plan.brewVolume = planned.volumetricTarget;
+        }
+    }
+    if (droppedTargets > 0) {
+        ESP_LOGW("ProfilePlan", "Profile %s has more than %u targets, ignored %u", profile.label.c_str(),
+                 PROFILE_PLAN_MAX_TARGETS, static_cast<unsigned>(droppedTargets));
+    }
+}
+
+#endif // PROFILE_PLAN_H
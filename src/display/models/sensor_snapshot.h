@@ -0,0 +1,17 @@
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <stdint.h>
+
+// All channels of one sensor notification from the controller, published as the payload of controller:sensor:update
+// so listeners never see a mix of old and new values
+struct SensorSnapshot {
+    uint32_t timestamp;   // millis() when the notification arrived, or when a batched sample was taken
+    float temperature;    // °C, temperature offset already applied
+    float pressure;       // bar
+    float puckFlow;       // ml/s
+    float pumpFlow;       // ml/s
+    float puckResistance;
+};
+
+#endif // SENSOR_SNAPSHOT_H
@@ -0,0 +1,124 @@
+#ifndef SHOT_INDEX_H
+#define SHOT_INDEX_H
+
+#include <FS.h>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "shot_log_codec.h"
+#include "shot_log_format.h"
+
+// In-memory mirror of the entries of /h/index.bin with an id -> slot map, so lookups and in-place updates do not scan
+// the file. Slot n lives at SHOT_INDEX_HEADER_SIZE + n * SHOT_INDEX_ENTRY_SIZE. Depends on nothing but FS so host
+// tools can include it, the firmware passes an allocator that places the entries in PSRAM. Not synchronized.
+template <typename Allocator = std::allocator<ShotIndexEntry>> class ShotIndexCache {
+  public:
+    void clear() {
+        entries.clear();
+        slots.clear();
+    }
+
+    void reserve(size_t count) {
+        entries.reserve(count);
+        slots.reserve(count);
+    }
+
+    // Storage for count entries read straight from index.bin, call reindex() once it is filled in
+    ShotIndexEntry *prepare(size_t count) {
+        clear();
+        entries.resize(count);
+        return entries.data();
+    }
+
+    // Rebuilds the id map. Older firmware could append the same id twice, the first live slot is kept and the others
+    // are marked deleted. Returns the slots that were marked, they still have to be written back.
+    std::vector<uint32_t> reindex() {
+        std::vector<uint32_t> retired;
+        slots.clear();
+        slots.reserve(entries.size());
+        for (uint32_t slot = 0; slot < entries.size(); slot++) {
+            ShotIndexEntry &entry = entries[slot];
+            auto it = slots.find(entry.id);
+            if (it == slots.end()) {
+                slots[entry.id] = slot;
+            } else if (entries[it->second].flags & SHOT_FLAG_DELETED) {
+                it->second = slot;
+            } else if (!(entry.flags & SHOT_FLAG_DELETED)) {
+                entry.flags |= SHOT_FLAG_DELETED;
+                retired.push_back(slot);
+            }
+        }
+        return retired;
+    }
+
+    int find(uint32_t id) const {
+        auto it = slots.find(id);
+        return it != slots.end() ? static_cast<int>(it->second) : -1;
+    }
+
+    // Adds an entry, recycling the slot of a deleted one with the same id. Returns the slot, -1 if the id is live.
+    int insert(const ShotIndexEntry &entry) {
+        int slot = find(entry.id);
+        if (slot >= 0) {
+            if (!(entries[slot].flags & SHOT_FLAG_DELETED)) {
+                return -1;
+            }
+            entries[slot] = entry;
+            return slot;
+        }
+        slot = static_cast<int>(entries.size());
+        entries.push_back(entry);
+        slots[entry.id] = slot;
+        return slot;
+    }
+
+    size_t size() const { return entries.size(); }
+    const ShotIndexEntry *data() const { return entries.data(); }
+    ShotIndexEntry &operator[](uint32_t slot) { return entries[slot]; }
+    const ShotIndexEntry &operator[](uint32_t slot) const { return entries[slot]; }
+
+  private:
+    std::vector<ShotIndexEntry, Allocator> entries;
+    std::unordered_map<uint32_t, uint32_t> slots; // shot id -> slot
+};
+
+namespace shot_index {
+
+// Journal record announcing that slot is about to be written in place together with header
+inline ShotIndexJournalRecord makeJournalRecord(uint32_t slot, const ShotIndexHeader &header, const ShotIndexEntry &entry) {
+    ShotIndexJournalRecord record{};
+    record.magic = SHOT_INDEX_JOURNAL_MAGIC;
+    record.slot = slot;
+    record.header = header;
+    record.entry = entry;
+    record.crc = shot_log::crc32(&record, offsetof(ShotIndexJournalRecord, crc));
+    return record;
+}
+
+// Applies the records of an index journal to index.bin in order. A torn record is the write that was in flight, the
+// index was not touched for it yet, so the replay ends there. Returns the number of records applied.
+inline uint32_t replayJournal(File &journal, File &indexFile) {
+    uint32_t replayed = 0;
+    ShotIndexJournalRecord record{};
+    while (journal.read(reinterpret_cast<uint8_t *>(&record), sizeof(record)) == sizeof(record)) {
+        uint32_t crc = shot_log::crc32(&record, offsetof(ShotIndexJournalRecord, crc));
+        if (record.magic != SHOT_INDEX_JOURNAL_MAGIC || record.crc != crc || record.slot >= record.header.entryCount) {
+            break;
+        }
+        indexFile.seek(SHOT_INDEX_HEADER_SIZE + record.slot * SHOT_INDEX_ENTRY_SIZE, SeekSet);
+        if (indexFile.write(reinterpret_cast<const uint8_t *>(&record.entry), sizeof(record.entry)) != sizeof(record.entry)) {
+            break;
+        }
+        indexFile.seek(0, SeekSet);
+        indexFile.write(reinterpret_cast<const uint8_t *>(&record.header), sizeof(record.header));
+        replayed++;
+    }
+    return replayed;
+}
+
+} // namespace shot_index
+
+#endif // SHOT_INDEX_H
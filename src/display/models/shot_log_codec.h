@@ -0,0 +1,244 @@
+#ifndef SHOT_LOG_CODEC_H
+#define SHOT_LOG_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "shot_log_format.h"
+
+// Streaming codec for the v6 sample stream. Kept free of Arduino dependencies so host tools can include it.
+//
+// After the header, a v6 file is a sequence of blocks:
+//   payloadLength(uint16_t) sampleCount(uint8_t) payload[payloadLength]
+// Every sample in a block is encoded as
+//   varint changedMask, then one zig-zag varint delta per set bit (ascending field order)
+// where the delta is taken against a prediction:
+//   - first sample of a block (keyframe): all fields predicted as 0, so blocks decode independently
+//   - other samples: the previous sample, with tick predicted as previous tick + 1
+// Deltas are computed modulo 2^16, matching the uint16_t/int16_t storage of ShotLogSample.
+// The header's reserved1 records the keyframe interval (samples per block) used by the writer.
+
+static constexpr uint8_t SHOT_LOG_BLOCK_HEADER_SIZE = 3;
+static constexpr uint16_t SHOT_LOG_KEYFRAME_INTERVAL = 40; // 10 s at 4 Hz
+static constexpr uint16_t SHOT_LOG_MAX_KEYFRAME_INTERVAL = 64;
+static constexpr size_t SHOT_LOG_FIELD_COUNT = SHOT_LOG_SAMPLE_SIZE / sizeof(uint16_t);
+static constexpr size_t SHOT_LOG_MAX_ENCODED_SAMPLE = 2 + SHOT_LOG_FIELD_COUNT * 3; // mask varint + 13 three-byte varints
+static constexpr size_t SHOT_LOG_MAX_BLOCK_PAYLOAD = SHOT_LOG_MAX_KEYFRAME_INTERVAL * SHOT_LOG_MAX_ENCODED_SAMPLE;
+
+static_assert(SHOT_LOG_FIELD_COUNT <= 32, "changed mask must fit in 32 bits");
+static_assert(SHOT_LOG_MAX_BLOCK_PAYLOAD <= 0xFFFF, "block payload length must fit in 16 bits");
+
+namespace shot_log {
+
+// The shift runs on the unsigned value, shifting a negative int16_t left is undefined
+inline uint16_t zigzag(int16_t value) { return static_cast<uint16_t>((static_cast<uint16_t>(value) << 1) ^ (value >> 15)); }
+
+inline int16_t unzigzag(uint16_t value) { return static_cast<int16_t>((value >> 1) ^ -static_cast<int16_t>(value & 1)); }
+
+inline size_t putVarint(uint8_t *out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+inline bool getVarint(const uint8_t *&p, const uint8_t *end, uint32_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// CRC-32 (IEEE, reflected), nibble table keeps it small enough for the header-sized records it protects
+inline uint32_t crc32(const void *data, size_t length, uint32_t crc = 0) {
+    static constexpr uint32_t table[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                           0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                           0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+inline uint32_t headerCrc(const ShotLogHeader &header) {
+    ShotLogHeader copy = header;
+    copy.headerCrc = 0;
+    uint32_t crc = crc32(&copy, sizeof(copy));
+    return crc != 0 ? crc : 1; // 0 is reserved for "not set"
+}
+
+inline void toFields(const ShotLogSample &sample, uint16_t *fields) { memcpy(fields, &sample, SHOT_LOG_SAMPLE_SIZE); }
+
+inline void fromFields(const uint16_t *fields, ShotLogSample &sample) { memcpy(&sample, fields, SHOT_LOG_SAMPLE_SIZE); }
+
+inline void predict(const uint16_t *previous, bool keyframe, uint16_t *predicted) {
+    if (keyframe) {
+        memset(predicted, 0, SHOT_LOG_SAMPLE_SIZE);
+        return;
+    }
+    memcpy(predicted, previous, SHOT_LOG_SAMPLE_SIZE);
+    predicted[0]++; // tick advances by one every sample
+}
+
+} // namespace shot_log
+
+// Builds one block at a time. push() returns true when the block is full; the caller then writes data()/size()
+// before the next push() starts a fresh block with a keyframe.
+class ShotLogEncoder {
+  public:
+    explicit ShotLogEncoder(uint16_t keyframeInterval = SHOT_LOG_KEYFRAME_INTERVAL) { setKeyframeInterval(keyframeInterval); }
+
+    void setKeyframeInterval(uint16_t interval) {
+        if (interval == 0) {
+            interval = 1;
+        } else if (interval > SHOT_LOG_MAX_KEYFRAME_INTERVAL) {
+            interval = SHOT_LOG_MAX_KEYFRAME_INTERVAL;
+        }
+        keyframeInterval = interval;
+        reset();
+    }
+
+    uint16_t getKeyframeInterval() const { return keyframeInterval; }
+
+    void reset() {
+        length = SHOT_LOG_BLOCK_HEADER_SIZE;
+        count = 0;
+        sealed = false;
+    }
+
+    bool push(const ShotLogSample &sample) {
+        if (sealed) {
+            reset();
+        }
+
+        uint16_t fields[SHOT_LOG_FIELD_COUNT];
+        uint16_t predicted[SHOT_LOG_FIELD_COUNT];
+        shot_log::toFields(sample, fields);
+        shot_log::predict(previous, count == 0, predicted);
+
+        uint32_t mask = 0;
+        for (size_t i = 0; i < SHOT_LOG_FIELD_COUNT; i++) {
+            if (fields[i] != predicted[i]) {
+                mask |= 1UL << i;
+            }
+        }
+
+        uint8_t *out = buffer + length;
+        out += shot_log::putVarint(out, mask);
+        for (size_t i = 0; i < SHOT_LOG_FIELD_COUNT; i++) {
+            if (mask & (1UL << i)) {
+                out += shot_log::putVarint(out, shot_log::zigzag(static_cast<int16_t>(fields[i] - predicted[i])));
+            }
+        }
+        length = out - buffer;
+        memcpy(previous, fields, sizeof(previous));
+        count++;
+
+        if (count >= keyframeInterval) {
+            seal();
+            return true;
+        }
+        return false;
+    }
+
+    // Seals a partially filled block. Returns false when there is nothing left to write.
+    bool finish() {
+        if (sealed || count == 0) {
+            return false;
+        }
+        seal();
+        return true;
+    }
+
+    const uint8_t *data() const { return buffer; }
+    size_t size() const { return length; }
+
+  private:
+    void seal() {
+        uint16_t payloadLength = static_cast<uint16_t>(length - SHOT_LOG_BLOCK_HEADER_SIZE);
+        buffer[0] = static_cast<uint8_t>(payloadLength & 0xFF);
+        buffer[1] = static_cast<uint8_t>(payloadLength >> 8);
+        buffer[2] = count;
+        sealed = true;
+    }
+
+    uint8_t buffer[SHOT_LOG_BLOCK_HEADER_SIZE + SHOT_LOG_MAX_BLOCK_PAYLOAD];
+    uint16_t previous[SHOT_LOG_FIELD_COUNT] = {};
+    size_t length = SHOT_LOG_BLOCK_HEADER_SIZE;
+    uint16_t keyframeInterval = SHOT_LOG_KEYFRAME_INTERVAL;
+    uint8_t count = 0;
+    bool sealed = false;
+};
+
+// Decodes the samples of a single block. Blocks are independent, so readers can skip ahead using payloadLength.
+class ShotLogDecoder {
+  public:
+    static bool readBlockHeader(const uint8_t *data, uint16_t &payloadLength, uint8_t &sampleCount) {
+        payloadLength = static_cast<uint16_t>(data[0] | (data[1] << 8));
+        sampleCount = data[2];
+        return sampleCount > 0 && payloadLength <= SHOT_LOG_MAX_BLOCK_PAYLOAD;
+    }
+
+    void begin(const uint8_t *payload, size_t payloadLength, uint8_t sampleCount) {
+        p = payload;
+        end = payload + payloadLength;
+        count = sampleCount;
+        decoded = 0;
+        error = false;
+    }
+
+    bool next(ShotLogSample &sample) {
+        if (error || decoded >= count) {
+            return false;
+        }
+
+        uint16_t predicted[SHOT_LOG_FIELD_COUNT];
+        shot_log::predict(previous, decoded == 0, predicted);
+
+        uint32_t mask;
+        if (!shot_log::getVarint(p, end, mask) || (mask >> SHOT_LOG_FIELD_COUNT) != 0) {
+            error = true;
+            return false;
+        }
+        for (size_t i = 0; i < SHOT_LOG_FIELD_COUNT; i++) {
+            if (mask & (1UL << i)) {
+                uint32_t delta;
+                if (!shot_log::getVarint(p, end, delta) || delta > 0xFFFF) {
+                    error = true;
+                    return false;
+                }
+                predicted[i] = static_cast<uint16_t>(predicted[i] + shot_log::unzigzag(static_cast<uint16_t>(delta)));
+            }
+        }
+
+        memcpy(previous, predicted, sizeof(previous));
+        shot_log::fromFields(predicted, sample);
+        decoded++;
+        return true;
+    }
+
+    bool done() const { return decoded >= count; }
+    bool failed() const { return error; }
+
+  private:
+    const uint8_t *p = nullptr;
+    const uint8_t *end = nullptr;
+    uint16_t previous[SHOT_LOG_FIELD_COUNT] = {};
+    uint8_t count = 0;
+    uint8_t decoded = 0;
+    bool error = false;
+};
+
+#endif // SHOT_LOG_CODEC_H
@@ -0,0 +1,299 @@
+#ifndef SHOT_LOG_DOWNSAMPLER_H
+#define SHOT_LOG_DOWNSAMPLER_H
+
+#include <FS.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shot_log_codec.h"
+#include "shot_log_format.h"
+#include "shot_log_reader.h"
+
+// Channel of a downsampled curve, index is the ShotLogSample field position and scale the one documented with it
+struct ShotLogCurveField {
+    const char *name;
+    uint8_t index;
+    bool isSigned;
+    float scale;
+};
+
+static constexpr ShotLogCurveField SHOT_LOG_CURVE_FIELDS[] = {
+    {"tt", 1, false, 10.0f},
+    {"ct", 2, false, 10.0f},
+    {"tp", 3, false, 10.0f},
+    {"cp", 4, false, 10.0f},
+    {"fl", 5, true, 100.0f},
+    {"tf", 6, true, 100.0f},
+    {"pf", 7, true, 100.0f},
+    {"vf", 8, true, 100.0f},
+    {"v", 9, false, 10.0f},
+    {"ev", 10, false, 10.0f},
+    {"pr", 11, false, 100.0f},
+};
+static constexpr size_t SHOT_LOG_CURVE_FIELD_COUNT = sizeof(SHOT_LOG_CURVE_FIELDS) / sizeof(SHOT_LOG_CURVE_FIELDS[0]);
+static constexpr size_t SHOT_LOG_CURVE_PENDING_SIZE = 256; // fits the document prefix and one point of every field
+
+// Largest-Triangle-Three-Buckets downsampling of a .slog file into the JSON document served by
+// /api/history/<id>?points=N:
+//   {"id":"000042","interval":250,"samples":812,"fields":["t","cp",...],"points":[[0,1.2,...],...]}
+// The document is produced piecewise by read(), so it can back a chunked HTTP response: every call resumes where the
+// previous one stopped and writes whole points until the buffer is full. Two readers over the same file keep memory
+// constant for any shot length, the lead one averages the next bucket while the lag one picks from the current one.
+// Keeps pointers into itself once begin() succeeded, so it must not be moved or copied afterwards.
+class ShotLogDownsampler {
+  public:
+    // fields is a comma separated list of SHOT_LOG_CURVE_FIELDS names, empty for all. points must be at least 3.
+    bool begin(File lead, File lag, const char *id, uint16_t points, const char *fields) {
+        leadFile = lead;
+        lagFile = lag;
+        if (!leadFile || !lagFile || !leadReader.begin(leadFile) || !lagReader.begin(lagFile) || points < 3) {
+            return false;
+        }
+        snprintf(shotId, sizeof(shotId), "%s", id);
+        pointLimit = points;
+        selectedCount = 0;
+        for (size_t f = 0; f < SHOT_LOG_CURVE_FIELD_COUNT; f++) {
+            if (*fields == '\0' || requested(fields, SHOT_LOG_CURVE_FIELDS[f].name)) {
+                selected[selectedCount++] = &SHOT_LOG_CURVE_FIELDS[f];
+            }
+        }
+        stage = Stage::SCAN;
+        firstPoint = true;
+        pendingStart = pendingEnd = 0;
+        return true;
+    }
+
+    // Copies the next part of the document into buffer, returns 0 once all of it was written
+    size_t read(uint8_t *buffer, size_t maxLen) {
+        size_t written = 0;
+        while (written < maxLen) {
+            if (pendingStart == pendingEnd) {
+                pendingStart = pendingEnd = 0;
+                if (!step()) {
+                    break;
+                }
+                continue;
+            }
+            size_t count = pendingEnd - pendingStart < maxLen - written ? pendingEnd - pendingStart : maxLen - written;
+            memcpy(buffer + written, pending + pendingStart, count);
+            pendingStart += count;
+            written += count;
+        }
+        return written;
+    }
+
+    uint32_t getSampleCount() const { return total; }
+
+  private:
+    enum class Stage { SCAN, ALL, FIRST, BUCKET, LAST, CLOSE, DONE };
+
+    static bool requested(const char *fields, const char *name) {
+        size_t length = strlen(name);
+        for (const char *start = fields; *start != '\0';) {
+            const char *end = strchr(start, ',');
+            size_t tokenLength = end != nullptr ? static_cast<size_t>(end - start) : strlen(start);
+            if (tokenLength == length && strncmp(start, name, length) == 0) {
+                return true;
+            }
+            if (end == nullptr) {
+                break;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    static float value(const ShotLogSample &sample, const ShotLogCurveField &field) {
+        uint16_t fields[SHOT_LOG_FIELD_COUNT];
+        shot_log::toFields(sample, fields);
+        return field.isSigned ? static_cast<int16_t>(fields[field.index]) : fields[field.index];
+    }
+
+    // Appends the next unit of the document to pending, false once the document is complete
+    bool step() {
+        switch (stage) {
+        case Stage::SCAN:
+            scan();
+            return true;
+        case Stage::ALL:
+            if (leadReader.next(sample)) {
+                appendPoint(sample);
+            } else {
+                stage = Stage::CLOSE;
+            }
+            return true;
+        case Stage::FIRST:
+            startBuckets();
+            return true;
+        case Stage::BUCKET:
+            nextBucket();
+            return true;
+        case Stage::LAST:
+            finishBuckets();
+            return true;
+        case Stage::CLOSE:
+            append("]}");
+            stage = Stage::DONE;
+            return true;
+        case Stage::DONE:
+            break;
+        }
+        return false;
+    }
+
+    // Sample count and value ranges, so every channel weighs the same in the triangle areas. Decoding is cheap next to
+    // the network, so this one pass runs in a single call.
+    void scan() {
+        float minValue[SHOT_LOG_CURVE_FIELD_COUNT];
+        float maxValue[SHOT_LOG_CURVE_FIELD_COUNT];
+        total = 0;
+        while (leadReader.next(sample)) {
+            for (size_t f = 0; f < selectedCount; f++) {
+                float current = value(sample, *selected[f]);
+                minValue[f] = total == 0 ? current : (current < minValue[f] ? current : minValue[f]);
+                maxValue[f] = total == 0 ? current : (current > maxValue[f] ? current : maxValue[f]);
+            }
+            total++;
+        }
+        for (size_t f = 0; f < selectedCount; f++) {
+            range[f] = total > 0 && maxValue[f] > minValue[f] ? maxValue[f] - minValue[f] : 1.0f;
+        }
+        interval = leadReader.getHeader().sampleInterval;
+        leadReader.rewind();
+
+        append("{\"id\":\"%s\",\"interval\":%u,\"samples\":%lu,\"fields\":[\"t\"", shotId, static_cast<unsigned>(interval),
+               static_cast<unsigned long>(total));
+        for (size_t f = 0; f < selectedCount; f++) {
+            append(",\"%s\"", selected[f]->name);
+        }
+        append("],\"points\":[");
+        stage = total <= pointLimit ? Stage::ALL : Stage::FIRST;
+    }
+
+    // Keeps the first sample and moves the lead reader to the start of the second bucket
+    void startBuckets() {
+        lagReader.next(anchor);
+        appendPoint(anchor);
+        leadReader.next(sample);
+        leadPosition = 1;
+        lagPosition = 1;
+        every = static_cast<float>(total - 2) / (pointLimit - 2);
+        const uint32_t firstBucketEnd = static_cast<uint32_t>(every) + 1;
+        while (leadPosition < firstBucketEnd && leadReader.next(sample)) {
+            leadPosition++;
+        }
+        bucket = 0;
+        stage = Stage::BUCKET;
+    }
+
+    // Keeps the sample of the current bucket that spans the largest triangle with the previously kept one and the
+    // average of the next bucket
+    void nextBucket() {
+        uint32_t averageEnd = static_cast<uint32_t>((bucket + 2) * every) + 1;
+        averageEnd = averageEnd < total ? averageEnd : total;
+        float averageTick = 0.0f;
+        float average[SHOT_LOG_CURVE_FIELD_COUNT] = {};
+        uint32_t averageCount = 0;
+        while (leadPosition < averageEnd && leadReader.next(sample)) {
+            averageTick += sample.t;
+            for (size_t f = 0; f < selectedCount; f++) {
+                average[f] += value(sample, *selected[f]);
+            }
+            averageCount++;
+            leadPosition++;
+        }
+        if (averageCount > 0) {
+            averageTick /= averageCount;
+            for (size_t f = 0; f < selectedCount; f++) {
+                average[f] /= averageCount;
+            }
+        }
+
+        uint32_t bucketEnd = static_cast<uint32_t>((bucket + 1) * every) + 1;
+        float bestArea = -1.0f;
+        ShotLogSample best{};
+        while (lagPosition < bucketEnd && lagReader.next(sample)) {
+            float anchorTick = anchor.t;
+            float area = 0.0f;
+            for (size_t f = 0; f < selectedCount; f++) {
+                float anchorValue = value(anchor, *selected[f]);
+                area += fabsf((anchorTick - averageTick) * (value(sample, *selected[f]) - anchorValue) -
+                              (anchorTick - sample.t) * (average[f] - anchorValue)) /
+                        range[f];
+            }
+            if (area > bestArea) {
+                bestArea = area;
+                best = sample;
+            }
+            lagPosition++;
+        }
+        if (bestArea >= 0.0f) {
+            appendPoint(best);
+            anchor = best;
+        }
+        if (++bucket == pointLimit - 2) {
+            stage = Stage::LAST;
+        }
+    }
+
+    // Keeps the last sample, unless the file ended early
+    void finishBuckets() {
+        ShotLogSample last = anchor;
+        while (lagPosition < total && lagReader.next(sample)) {
+            last = sample;
+            lagPosition++;
+        }
+        if (lagPosition == total) {
+            appendPoint(last);
+        }
+        stage = Stage::CLOSE;
+    }
+
+    void appendPoint(const ShotLogSample &point) {
+        append(firstPoint ? "[%lu" : ",[%lu", static_cast<unsigned long>(point.t) * interval);
+        for (size_t f = 0; f < selectedCount; f++) {
+            append(",%.*f", selected[f]->scale >= 100.0f ? 2 : 1, value(point, *selected[f]) / selected[f]->scale);
+        }
+        append("]");
+        firstPoint = false;
+    }
+
+    void append(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(pending + pendingEnd, sizeof(pending) - pendingEnd, format, args);
+        va_end(args);
+        if (length > 0) {
+            pendingEnd = pendingEnd + length < sizeof(pending) ? pendingEnd + length : sizeof(pending) - 1;
+        }
+    }
+
+    File leadFile;
+    File lagFile;
+    ShotLogReader leadReader;
+    ShotLogReader lagReader;
+    char shotId[16] = {};
+    uint16_t pointLimit = 0;
+    const ShotLogCurveField *selected[SHOT_LOG_CURVE_FIELD_COUNT] = {};
+    size_t selectedCount = 0;
+    float range[SHOT_LOG_CURVE_FIELD_COUNT] = {};
+    uint32_t total = 0;
+    uint16_t interval = 0;
+
+    Stage stage = Stage::DONE;
+    ShotLogSample sample{};
+    ShotLogSample anchor{};
+    bool firstPoint = true;
+    float every = 0.0f;
+    uint16_t bucket = 0;
+    uint32_t leadPosition = 0;
+    uint32_t lagPosition = 0;
+
+    char pending[SHOT_LOG_CURVE_PENDING_SIZE];
+    size_t pendingStart = 0;
+    size_t pendingEnd = 0;
+};
+
+#endif // SHOT_LOG_DOWNSAMPLER_H
@@ -15,9 +15,13 @@
 // Values are stored as scaled integers (see comments per field below).
 // Sample size = 13 fields * 2 bytes = 26 bytes (v5+ format). Phase data moved to header transitions.
 // Older files may have fewer fields - use fieldsMask to determine layout.
+// v6+: samples are no longer stored as fixed records but delta/varint encoded in blocks, see shot_log_codec.h.
+//   reserved0 still reports the decoded sample size, reserved1 holds the keyframe interval.
+//   headerCrc protects the header patched at the end of a shot; 0 means not set (files from older firmware).
+//   A header with sampleCount == 0 or a CRC mismatch was cut off and is repaired from the sample data.
 
 static constexpr uint32_t SHOT_LOG_MAGIC = 0x544F4853; // 'S''H''O''T' little-endian 0x54 0x4F 0x48 0x53
-static constexpr uint8_t SHOT_LOG_VERSION = 5;
+static constexpr uint8_t SHOT_LOG_VERSION = 6;
 static constexpr uint16_t SHOT_LOG_HEADER_SIZE = 512;
 static constexpr uint16_t SHOT_LOG_SAMPLE_INTERVAL_MS = 250; // nominal recording interval
 static constexpr uint32_t SHOT_LOG_FIELDS_MASK_ALL = 0x1FFF; // 13 fields present (removed phase number)
@@ -42,7 +46,7 @@ static constexpr uint32_t SHOT_LOG_FIELD_SI = 0x1000; // system info (bit 12)
 // Phase transition structure for version 5+ headers
 #pragma pack(push, 1)
 struct PhaseTransition {
-    uint16_t sampleIndex; // Sample index when phase changed
+    uint16_t sampleTick;  // v6+: t of the first sample of the phase, v5: its sample index
     uint8_t phaseNumber;  // Phase number (0-based)
     uint8_t reserved;     // Padding for alignment
     char phaseName[25];   // Phase name (24 chars + null terminator)
@@ -56,7 +60,7 @@ struct ShotLogHeader {
     uint8_t reserved0;       // stores sample size (SHOT_LOG_SAMPLE_SIZE) for diagnostics
     uint16_t headerSize;     // = SHOT_LOG_HEADER_SIZE
     uint16_t sampleInterval; // ms (nominal)
-    uint16_t reserved1;      // future
+    uint16_t reserved1;      // v6+: samples per encoded block (keyframe interval)
     uint32_t fieldsMask;     // bitmask (currently always SHOT_LOG_FIELDS_MASK_ALL)
     uint32_t sampleCount;    // patched at end
     uint32_t durationMs;     // patched at end (last t)
@@ -70,7 +74,8 @@ struct ShotLogHeader {
     uint8_t phaseTransitionCount;         // 1 byte
 
     // Future expansion - pad to 512 bytes total
-    uint8_t reserved_v5[53]; // Manual padding to reach 512 bytes
+    uint8_t reserved_v5[49]; // Manual padding to reach 512 bytes
+    uint32_t headerCrc;      // CRC-32 of the header with this field zeroed, 0 if not set
 };
 #pragma pack(pop)
 
@@ -122,6 +127,7 @@ static constexpr uint16_t SHOT_INDEX_ENTRY_SIZE = 128;
 static constexpr uint8_t SHOT_FLAG_COMPLETED = 0x01;
 static constexpr uint8_t SHOT_FLAG_DELETED = 0x02;
 static constexpr uint8_t SHOT_FLAG_HAS_NOTES = 0x04;
+static constexpr uint8_t SHOT_FLAG_HAS_SUMMARY = 0x08; // summary holds aggregates of the recorded samples
 
 #pragma pack(push, 1)
 struct ShotIndexHeader {
@@ -130,7 +136,20 @@ struct ShotIndexHeader {
     uint16_t entrySize;   // SHOT_INDEX_ENTRY_SIZE
     uint32_t entryCount;  // Number of entries in file
     uint32_t nextId;      // Next shot ID to use
-    uint8_t reserved[16]; // Future expansion
+    uint32_t generation;  // Bumped on every header write, mirrored in settings to detect stale indexes
+    uint8_t reserved[12]; // Future expansion
+};
+
+// Aggregates over the brewing part of a shot (extended recording excluded), same scaling as ShotLogSample.
+// Lives in what used to be reserved space of ShotIndexEntry, only valid with SHOT_FLAG_HAS_SUMMARY set.
+struct ShotSummary {
+    uint16_t peakPressure;  // bar * 10
+    uint16_t meanPressure;  // bar * 10
+    int16_t meanFlow;       // pump flow, ml/s * 100
+    int16_t meanTempError;  // current - target temperature, °C * 10
+    uint32_t firstDripMs;   // first puck flow since shot start, 0 if never reached
+    uint32_t preinfusionMs; // time spent in preinfusion phases
+    uint16_t waterPumped;   // integrated pump flow, ml * 10
 };
 
 struct ShotIndexEntry {
@@ -142,7 +161,25 @@ struct ShotIndexEntry {
     uint8_t flags;        // Bit flags (completed, deleted, etc.)
     char profileId[32];   // Profile ID, null-terminated
     char profileName[48]; // Profile name, null-terminated
-    uint8_t reserved[32]; // Future expansion
+    ShotSummary summary;  // Valid with SHOT_FLAG_HAS_SUMMARY
+    uint32_t logSize;     // Size of the .slog file in bytes, 0 if unknown
+    uint16_t notesSize;   // Size of the notes file in bytes
+    uint8_t reserved[8];  // Future expansion
+};
+
+// Write-ahead journal for in-place index updates
+// File: /h/index.jnl
+// Every index write first appends the target slot together with the entry and header it is about to write.
+// Records with a bad CRC mark a write that never reached index.bin and end the replay. Replaying the rest is
+// idempotent, so the journal is only dropped once it has grown or the index is rewritten as a whole.
+static constexpr uint32_t SHOT_INDEX_JOURNAL_MAGIC = 0x4C4E4A53; // 'S''J''N''L' little-endian
+
+struct ShotIndexJournalRecord {
+    uint32_t magic;         // SHOT_INDEX_JOURNAL_MAGIC
+    uint32_t slot;          // Entry slot written in place
+    ShotIndexHeader header; // Header as written with the entry
+    ShotIndexEntry entry;   // Entry contents
+    uint32_t crc;           // CRC-32 of all preceding fields
 };
 #pragma pack(pop)
 
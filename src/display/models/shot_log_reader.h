@@ -0,0 +1,109 @@
+#ifndef SHOT_LOG_READER_H
+#define SHOT_LOG_READER_H
+
+#include <FS.h>
+#include <string.h>
+
+#include "shot_log_codec.h"
+#include "shot_log_format.h"
+
+// Sequential sample reader for .slog files of any version. Fixed records (up to v5) are expanded to the full
+// ShotLogSample using the header's fieldsMask, v6+ blocks are decoded one at a time, so memory use does not depend
+// on the length of the shot. Reading stops at the first truncated or corrupt record, which is where a shot that is
+// still being written or was interrupted ends.
+class ShotLogReader {
+  public:
+    bool begin(File &source) {
+        file = &source;
+        memset(&header, 0, sizeof(header));
+        file->seek(0, SeekSet);
+        size_t read = file->read(reinterpret_cast<uint8_t *>(&header), sizeof(header));
+        if (read < 8 || header.magic != SHOT_LOG_MAGIC || header.headerSize > read || header.sampleInterval == 0) {
+            file = nullptr;
+            return false;
+        }
+        if (header.headerSize < sizeof(header)) {
+            // Older, shorter headers: clear whatever sample data was read past them
+            memset(reinterpret_cast<uint8_t *>(&header) + header.headerSize, 0, sizeof(header) - header.headerSize);
+        }
+        recordFields = 0;
+        for (uint32_t mask = header.fieldsMask; mask != 0; mask >>= 1) {
+            recordFields += mask & 1;
+        }
+        if (header.version < 6 && (recordFields == 0 || recordFields > 32)) {
+            file = nullptr;
+            return false;
+        }
+        return rewind();
+    }
+
+    bool rewind() {
+        if (file == nullptr) {
+            return false;
+        }
+        decoder.begin(nullptr, 0, 0);
+        ended = false;
+        return file->seek(header.headerSize, SeekSet);
+    }
+
+    bool next(ShotLogSample &sample) {
+        if (file == nullptr || ended) {
+            return false;
+        }
+        if (!(header.version >= 6 ? nextEncoded(sample) : nextFixed(sample))) {
+            ended = true;
+            return false;
+        }
+        return true;
+    }
+
+    const ShotLogHeader &getHeader() const { return header; }
+
+  private:
+    bool nextFixed(ShotLogSample &sample) {
+        uint16_t record[32];
+        size_t bytes = recordFields * sizeof(uint16_t);
+        if (file->read(reinterpret_cast<uint8_t *>(record), bytes) != bytes) {
+            return false;
+        }
+        uint16_t fields[SHOT_LOG_FIELD_COUNT] = {};
+        size_t column = 0;
+        for (size_t bit = 0; bit < 32 && column < recordFields; bit++) {
+            if (header.fieldsMask & (1UL << bit)) {
+                if (bit < SHOT_LOG_FIELD_COUNT) {
+                    fields[bit] = record[column];
+                }
+                column++;
+            }
+        }
+        shot_log::fromFields(fields, sample);
+        return true;
+    }
+
+    bool nextEncoded(ShotLogSample &sample) {
+        while (!decoder.next(sample)) {
+            if (decoder.failed()) {
+                return false;
+            }
+            uint8_t blockHeader[SHOT_LOG_BLOCK_HEADER_SIZE];
+            uint16_t payloadLength;
+            uint8_t sampleCount;
+            if (file->read(blockHeader, sizeof(blockHeader)) != sizeof(blockHeader) ||
+                !ShotLogDecoder::readBlockHeader(blockHeader, payloadLength, sampleCount) ||
+                file->read(payload, payloadLength) != payloadLength) {
+                return false;
+            }
+            decoder.begin(payload, payloadLength, sampleCount);
+        }
+        return true;
+    }
+
+    File *file = nullptr;
+    ShotLogHeader header{};
+    size_t recordFields = 0;
+    bool ended = false;
+    ShotLogDecoder decoder;
+    uint8_t payload[SHOT_LOG_MAX_BLOCK_PAYLOAD];
+};
+
+#endif // SHOT_LOG_READER_H
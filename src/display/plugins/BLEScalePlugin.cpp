@@ -74,17 +74,17 @@ void BLEScalePlugin::setup(Controller *controller, PluginManager *manager) {
         return;
     }
 
-    manager->on("controller:ready", [this](Event const &) {
+    manager->on("controller:ready"_ev, [this](Event const &) {
         if (this->controller != nullptr && this->controller->getMode() != MODE_STANDBY) {
             ESP_LOGI("BLEScalePlugin", "Resuming scanning");
             scan();
             active = true;
         }
     });
-    manager->on("controller:brew:prestart", [this](Event const &) { onProcessStart(); });
-    manager->on("controller:grind:start", [this](Event const &) { onProcessStart(); });
-    manager->on("controller:mode:change", [this](Event const &event) {
-        if (event.getInt("value") != MODE_STANDBY) {
+    manager->on("controller:brew:prestart"_ev, [this](Event const &) { onProcessStart(); });
+    manager->on("controller:grind:start"_ev, [this](Event const &) { onProcessStart(); });
+    manager->on("controller:mode:change"_ev, [this](Event const &event) {
+        if (event.getInt("value"_ev) != MODE_STANDBY) {
             ESP_LOGI("BLEScalePlugin", "Resuming scanning");
             scan();
             active = true;
@@ -97,6 +97,19 @@ void BLEScalePlugin::setup(Controller *controller, PluginManager *manager) {
             ESP_LOGI("BLEScalePlugin", "Stopping scanning, disconnecting");
         }
     });
+    // Scanning shares the radio with the controller link, stay quiet while a process runs
+    manager->on("controller:bluetooth:scan:pause"_ev, [this](Event const &) {
+        if (scanner != nullptr) {
+            scanner->stopAsyncScan();
+        }
+    });
+    // A scale that is connected or about to be needs no scan, starting one would only compete with its link again
+    manager->on("controller:bluetooth:scan:resume"_ev, [this](Event const &) {
+        if (!active || doConnect || (scale != nullptr && scale->isConnected())) {
+            return;
+        }
+        scan();
+    });
 }
 
 void BLEScalePlugin::loop() {
@@ -128,6 +141,14 @@ void BLEScalePlugin::update() {
     if (controller->isVolumetricAvailable())
         controller->setVolumetricOverride(hasConnectedScale);
 
+    if (hasConnectedScale && !linkAttached) {
+        controller->getConnectionManager()->attach(BLELink::SCALE, scale->getDeviceAddress(), &linkCounters);
+        linkAttached = true;
+    } else if (!hasConnectedScale && linkAttached) {
+        controller->getConnectionManager()->detach(BLELink::SCALE);
+        linkAttached = false;
+    }
+
     if (!active)
         return;
 
@@ -139,9 +160,7 @@ void BLEScalePlugin::update() {
             if (reconnectionTries > RECONNECTION_TRIES) {
                 ESP_LOGW("BLEScalePlugin", "Max reconnection attempts reached, disconnecting");
                 disconnect();
-                if (scanner != nullptr) {
-                    scanner->initializeAsyncScan();
-                }
+                scan();
             }
         }
     } else if (controller->getSettings().getSavedScale() != "" && scanner != nullptr) {
@@ -180,6 +199,10 @@ void BLEScalePlugin::scan() const {
         ESP_LOGE("BLEScalePlugin", "Scanner not initialized, cannot start scan");
         return;
     }
+    if (controller != nullptr && controller->getConnectionManager()->isScanPaused()) {
+        ESP_LOGI("BLEScalePlugin", "Scanning paused while a process runs");
+        return;
+    }
     scanner->initializeAsyncScan();
 }
 
@@ -271,9 +294,7 @@ void BLEScalePlugin::establishConnection() {
             if (!connectResult) {
                 ESP_LOGW("BLEScalePlugin", "Failed to connect to scale, retrying scan");
                 disconnect();
-                if (scanner != nullptr) {
-                    scanner->initializeAsyncScan();
-                }
+                scan();
             }
             break;
         }
@@ -281,13 +302,13 @@ void BLEScalePlugin::establishConnection() {
 
     if (!deviceFound) {
         ESP_LOGW("BLEScalePlugin", "Device %s not found in discovered scales", uuid.c_str());
-        if (scanner != nullptr) {
-            scanner->initializeAsyncScan();
-        }
+        scan();
     }
 }
 
 void BLEScalePlugin::onMeasurement(float value) const {
+    linkCounters.notifications.fetch_add(1, std::memory_order_relaxed);
+
     // Rate limiting to prevent callback flooding
     unsigned long now = millis();
     if (now - lastMeasurementTime < MIN_MEASUREMENT_INTERVAL_MS) {
@@ -1,6 +1,7 @@
 #ifndef BLESCALEPLUGIN_H
 #define BLESCALEPLUGIN_H
 #include "../core/Plugin.h"
+#include <NimBLEComm.h>
 #include "remote_scales.h"
 #include "remote_scales_plugin_registry.h"
 
@@ -56,6 +57,10 @@ class BLEScalePlugin : public Plugin {
     mutable unsigned long lastMeasurementTime = 0;
     static constexpr unsigned long MIN_MEASUREMENT_INTERVAL_MS = 10; // Max 100 measurements per second
 
+    // Weight updates are the scale's notifications, the library does not expose their size or numbering
+    mutable LinkCounters linkCounters;
+    bool linkAttached = false;
+
     Controller *controller = nullptr;
     RemoteScalesPluginRegistry *pluginRegistry = nullptr;
     RemoteScalesScanner *scanner = nullptr;
@@ -6,11 +6,11 @@
 
 void BoilerFillPlugin::setup(Controller *controller, PluginManager *pluginManager) {
     this->controller = controller;
-    pluginManager->on("controller:ready", [this](Event const &) {
+    pluginManager->on("controller:ready"_ev, [this](Event const &) {
         this->controller->startProcess(new PumpProcess(this->controller->getSettings().getStartupFillTime()));
     });
-    pluginManager->on("controller:mode:change", [this](Event const &event) {
-        int newMode = event.getInt("value");
+    pluginManager->on("controller:mode:change"_ev, [this](Event const &event) {
+        int newMode = event.getInt("value"_ev);
         if (newMode == MODE_BREW && this->controller->getMode() == MODE_STEAM) {
             this->controller->startProcess(new PumpProcess(this->controller->getSettings().getSteamFillTime()));
         }
@@ -55,8 +55,8 @@ void HomekitPlugin::clearAction() { actionRequired = false; }
 void HomekitPlugin::setup(Controller *controller, PluginManager *pluginManager) {
     this->controller = controller;
 
-    pluginManager->on("controller:wifi:connect", [this](Event &event) {
-        int apMode = event.getInt("AP");
+    pluginManager->on("controller:wifi:connect"_ev, [this](Event &event) {
+        int apMode = event.getInt("AP"_ev);
         if (apMode)
             return;
         homeSpan.setHostNameSuffix("");
@@ -70,23 +70,32 @@ void HomekitPlugin::setup(Controller *controller, PluginManager *pluginManager)
         homeSpan.autoPoll();
     });
 
-    pluginManager->on("boiler:targetTemperature:change", [this](Event const &event) {
-        if (accessory == nullptr)
-            return;
-        accessory->setTargetTemperature(event.getFloat("value"));
-    });
-
-    pluginManager->on("boiler:currentTemperature:change", [this](Event const &event) {
-        if (accessory == nullptr)
-            return;
-        accessory->setCurrentTemperature(event.getFloat("value"));
-    });
-
-    pluginManager->on("controller:mode:change", [this](Event const &event) {
-        if (accessory == nullptr)
-            return;
-        accessory->setState(event.getInt("value") != MODE_STANDBY);
-    });
+    pluginManager->on(
+        "boiler:targetTemperature:change"_ev,
+        [this](Event const &event) {
+            if (accessory == nullptr)
+                return;
+            accessory->setTargetTemperature(event.getFloat("value"_ev));
+        },
+        EventDelivery::ASYNC);
+
+    pluginManager->on(
+        "boiler:currentTemperature:change"_ev,
+        [this](Event const &event) {
+            if (accessory == nullptr)
+                return;
+            accessory->setCurrentTemperature(event.getFloat("value"_ev));
+        },
+        EventDelivery::ASYNC_LOW, EventPolicy::onChange(HOMEKIT_TEMPERATURE_CHANGE).coalesce());
+
+    pluginManager->on(
+        "controller:mode:change"_ev,
+        [this](Event const &event) {
+            if (accessory == nullptr)
+                return;
+            accessory->setState(event.getInt("value"_ev) != MODE_STANDBY);
+        },
+        EventDelivery::ASYNC);
 }
 
 void HomekitPlugin::loop() {
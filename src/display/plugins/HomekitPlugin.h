@@ -5,6 +5,7 @@
 
 #define HOMESPAN_PORT 8080
 #define DEVICE_NAME "GaggiMate"
+#define HOMEKIT_TEMPERATURE_CHANGE 0.1f
 
 typedef std::function<void()> change_callback_t;
 class HomekitAccessory : public Service::Thermostat {
@@ -4,7 +4,7 @@
 
 void LedControlPlugin::setup(Controller *controller, PluginManager *pluginManager) {
     this->controller = controller;
-    pluginManager->on("controller:ready", [this](Event const) { initialized = true; });
+    pluginManager->on("controller:ready"_ev, [this](Event const) { initialized = true; });
 }
 
 void LedControlPlugin::loop() {
@@ -11,19 +11,34 @@ bool MQTTPlugin::connect(Controller *controller) {
     const String haUser = settings.getHomeAssistantUser();
     const String haPassword = settings.getHomeAssistantPassword();
 
-    client.begin(ip.c_str(), haPort, net);
-    client.setKeepAlive(10);
-    printf("Connecting to MQTT");
-    for (int i = 0; i < MQTT_CONNECTION_RETRIES; i++) {
-        if (client.connect(clientId.c_str(), haUser.c_str(), haPassword.c_str())) {
-            printf("\n");
-            return true;
+    if (connectAttempts == 0) {
+        client.begin(ip.c_str(), haPort, net);
+        client.setKeepAlive(10);
+        printf("Connecting to MQTT\n");
+    }
+    return client.connect(clientId.c_str(), haUser.c_str(), haPassword.c_str());
+}
+
+void MQTTPlugin::loop() {
+    if (connectRequested.exchange(false)) {
+        connectAttempts = 0;
+        lastConnectAttempt = 0;
+    }
+    // One attempt per pass instead of sleeping between retries, so the main loop keeps running
+    if (connectAttempts < MQTT_CONNECTION_RETRIES && !client.connected() &&
+        (connectAttempts == 0 || millis() - lastConnectAttempt >= MQTT_CONNECTION_DELAY)) {
+        lastConnectAttempt = millis();
+        if (connect(controller)) {
+            connectAttempts = MQTT_CONNECTION_RETRIES;
+            publishDiscovery(controller);
+        } else if (++connectAttempts == MQTT_CONNECTION_RETRIES) {
+            printf("Connection to MQTT failed.\n");
         }
-        printf(".");
-        delay(MQTT_CONNECTION_DELAY);
     }
-    printf("\nConnection to MQTT failed.\n");
-    return false;
+    if (!client.connected())
+        return;
+    client.loop();
+    publishPending();
 }
 
 void MQTTPlugin::publishDiscovery(Controller *controller) {
@@ -117,34 +132,19 @@ void MQTTPlugin::publishBrewState(const char *state) {
     publish("controller/brew/state", json);
 }
 
-void MQTTPlugin::setup(Controller *controller, PluginManager *pluginManager) {
-    pluginManager->on("controller:wifi:connect", [this, controller](const Event &) {
-        if (!connect(controller))
-            return;
-        publishDiscovery(controller);
-    });
-
-    pluginManager->on("boiler:currentTemperature:change", [this](Event const &event) {
-        if (!client.connected())
-            return;
-        char json[50];
-        const float temp = event.getFloat("value");
-        if (temp != lastTemperature) {
-            snprintf(json, sizeof(json), R"***({"temperature":%02f})***", temp);
-            publish("boilers/0/temperature", json);
-        }
-        lastTemperature = temp;
-    });
-    pluginManager->on("boiler:targetTemperature:change", [this](Event const &event) {
-        if (!client.connected())
-            return;
-        char json[50];
-        const float temp = event.getFloat("value");
+void MQTTPlugin::publishPending() {
+    char json[100];
+    float temp;
+    if (temperature.take(temp)) {
+        snprintf(json, sizeof(json), R"***({"temperature":%02f})***", temp);
+        publish("boilers/0/temperature", json);
+    }
+    if (targetTemperature.take(temp)) {
         snprintf(json, sizeof(json), R"***({"temperature":%02f})***", temp);
         publish("boilers/0/targetTemperature", json);
-    });
-    pluginManager->on("controller:mode:change", [this](Event const &event) {
-        int newMode = event.getInt("value");
+    }
+    int newMode;
+    if (mode.take(newMode)) {
         const char *modeStr;
         switch (newMode) {
         case 0:
@@ -166,11 +166,27 @@ void MQTTPlugin::setup(Controller *controller, PluginManager *pluginManager) {
             modeStr = "Unknown";
             break; // Fallback in case of unexpected value
         }
-        char json[100];
         snprintf(json, sizeof(json), R"({"mode":%d,"mode_str":"%s"})", newMode, modeStr);
         publish("controller/mode", json);
-    });
-    pluginManager->on("controller:brew:start", [this](Event const &) { publishBrewState("brewing"); });
+    }
+    const char *state;
+    if (brewState.take(state)) {
+        publishBrewState(state);
+    }
+}
 
-    pluginManager->on("controller:brew:end", [this](Event const &) { publishBrewState("not brewing"); });
+void MQTTPlugin::setup(Controller *controller, PluginManager *pluginManager) {
+    this->controller = controller;
+    // The connection is made from loop(), the event may come from a WiFi task
+    pluginManager->on("controller:wifi:connect"_ev, [this](const Event &) { connectRequested.store(true); });
+
+    // Listeners only record the latest values, publishing happens in loop() on the task that owns the client
+    pluginManager->on(
+        "boiler:currentTemperature:change"_ev, [this](Event const &event) { temperature.set(event.getFloat("value"_ev)); },
+        EventDelivery::SYNC, EventPolicy::onChange(MQTT_TEMPERATURE_CHANGE));
+    pluginManager->on("boiler:targetTemperature:change"_ev,
+                      [this](Event const &event) { targetTemperature.set(event.getFloat("value"_ev)); });
+    pluginManager->on("controller:mode:change"_ev, [this](Event const &event) { mode.set(event.getInt("value"_ev)); });
+    pluginManager->on("controller:brew:start"_ev, [this](Event const &) { brewState.set("brewing"); });
+    pluginManager->on("controller:brew:end"_ev, [this](Event const &) { brewState.set("not brewing"); });
 }
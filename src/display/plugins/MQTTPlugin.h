@@ -3,26 +3,52 @@
 #include "../core/Plugin.h"
 #include <MQTT.h>
 #include <WiFi.h>
+#include <atomic>
 
 constexpr int MQTT_CONNECTION_RETRIES = 5;
 constexpr int MQTT_CONNECTION_DELAY = 1000;
+constexpr float MQTT_TEMPERATURE_CHANGE = 0.1f; // °C, smaller changes are not published
 
 class MQTTPlugin : public Plugin {
   public:
     void setup(Controller *controller, PluginManager *pluginManager) override;
     bool connect(Controller *controller);
-    void loop() override {
-        // Event based plugin, no loop needed
-    };
+    void loop() override;
 
   private:
+    // Latest value of a topic, left by a listener for loop() to publish
+    template <typename T> struct PendingValue {
+        std::atomic<T> value{};
+        std::atomic<bool> pending{false};
+
+        void set(T next) {
+            value.store(next);
+            pending.store(true);
+        }
+        bool take(T &out) {
+            if (!pending.exchange(false))
+                return false;
+            out = value.load();
+            return true;
+        }
+    };
+
     void publish(const std::string &topic, const std::string &message);
     void publishBrewState(const char *state);
     void publishDiscovery(Controller *controller);
+    void publishPending();
+    Controller *controller = nullptr;
     MQTTClient client;
     WiFiClient net;
 
-    float lastTemperature = 0;
+    // Events arrive on whatever task triggers them but the client is not thread safe, so only loop() touches it
+    std::atomic<bool> connectRequested{false};
+    int connectAttempts = MQTT_CONNECTION_RETRIES; // nothing to retry until WiFi connects
+    unsigned long lastConnectAttempt = 0;
+    PendingValue<float> temperature;
+    PendingValue<float> targetTemperature;
+    PendingValue<int> mode;
+    PendingValue<const char *> brewState;
 };
 
 #endif // MQTTPLUGIN_H
@@ -3,11 +3,13 @@
 #include <SD_MMC.h>
 #include <SPIFFS.h>
 #include <cmath>
+#include <cstddef>
 #include <display/core/Controller.h>
 #include <display/core/ProfileManager.h>
 #include <display/core/process/BrewProcess.h>
 #include <display/core/utils.h>
 #include <display/models/shot_log_format.h>
+#include <display/models/shot_log_reader.h>
 
 namespace {
 constexpr float TEMP_SCALE = 10.0f;
@@ -76,29 +78,43 @@ void ShotHistoryPlugin::setup(Controller *c, PluginManager *pm) {
         fs = &SD_MMC;
         ESP_LOGI("ShotHistoryPlugin", "Logging shot history to SD card");
     }
-    rebuildIndex();
-    pm->on("controller:brew:start", [this](Event const &) { startRecording(); });
-    pm->on("controller:brew:end", [this](Event const &) { endRecording(); });
-    pm->on("controller:brew:clear", [this](Event const &) { endExtendedRecording(); });
-    pm->on("controller:volumetric-measurement:estimation:change",
-           [this](Event const &event) { currentEstimatedWeight = event.getFloat("value"); });
-    pm->on("controller:volumetric-measurement:bluetooth:change",
-           [this](Event const &event) { currentBluetoothWeight = event.getFloat("value"); });
-    pm->on("boiler:currentTemperature:change", [this](Event const &event) { currentTemperature = event.getFloat("value"); });
-    pm->on("pump:puck-resistance:change", [this](Event const &event) { currentPuckResistance = event.getFloat("value"); });
-    xTaskCreatePinnedToCore(loopTask, "ShotHistoryPlugin::loop", configMINIMAL_STACK_SIZE * 6, this, 1, &taskHandle, 0);
+    recoverIndex();
+    pm->on("controller:brew:start"_ev, [this](Event const &) { startRecording(); });
+    pm->on("controller:brew:end"_ev, [this](Event const &) { endRecording(); });
+    pm->on("controller:brew:clear"_ev, [this](Event const &) { endExtendedRecording(); });
+    pm->on("controller:volumetric-measurement:estimation:change"_ev,
+           [this](Event const &event) { currentEstimatedWeight = event.getFloat("value"_ev); });
+    pm->on("controller:volumetric-measurement:bluetooth:change"_ev,
+           [this](Event const &event) { currentBluetoothWeight = event.getFloat("value"_ev); });
+    pm->on("controller:sensor:update"_ev, [this](Event const &) {
+        // Wake the sampler when recording per notification
+        if (sampleOnSensorUpdate && taskHandle != nullptr) {
+            xTaskNotifyGive(taskHandle);
+        }
+    });
+
+    freeBuffers = xQueueCreate(SHOT_LOG_BUFFER_COUNT, sizeof(int8_t));
+    writerQueue = xQueueCreate(SHOT_LOG_WRITER_QUEUE_LENGTH, sizeof(ShotLogCommand));
+    for (int8_t i = 0; i < static_cast<int8_t>(SHOT_LOG_BUFFER_COUNT); i++) {
+        xQueueSend(freeBuffers, &i, 0);
+    }
+    // Sampler runs above the writer so storage stalls never push back on the sample timeline
+    xTaskCreatePinnedToCore(writerTask, "ShotHistoryPlugin::writer", configMINIMAL_STACK_SIZE * 6, this, 1, &writerTaskHandle, 0);
+    xTaskCreatePinnedToCore(loopTask, "ShotHistoryPlugin::loop", configMINIMAL_STACK_SIZE * 6, this, 2, &taskHandle, 0);
 }
 
 void ShotHistoryPlugin::record() {
+    if (closePending) {
+        submitClose();
+    }
     bool shouldRecord = recording || extendedRecording;
 
     if (shouldRecord && (controller->getMode() == MODE_BREW || extendedRecording)) {
         if (!isFileOpen) {
-            if (!fs->exists("/h")) {
-                fs->mkdir("/h");
-            }
-            currentFile = fs->open("/h/" + currentId + ".slog", FILE_WRITE);
-            if (currentFile) {
+            // Never waits for storage, the open is retried on the next pass. The writer still has the previous log
+            // open until its close is posted.
+            int8_t buffer = closePending ? -1 : acquireBuffer(0);
+            if (buffer >= 0) {
                 isFileOpen = true;
                 // Prepare header
                 memset(&header, 0, sizeof(header));
@@ -106,7 +122,8 @@ void ShotHistoryPlugin::record() {
                 header.version = SHOT_LOG_VERSION;
                 header.reserved0 = (uint8_t)SHOT_LOG_SAMPLE_SIZE; // record sample size actually used
                 header.headerSize = SHOT_LOG_HEADER_SIZE;
-                header.sampleInterval = SHOT_LOG_SAMPLE_INTERVAL_MS;
+                header.sampleInterval = sampleInterval;
+                header.reserved1 = encoder.getKeyframeInterval();
                 header.fieldsMask = SHOT_LOG_FIELDS_MASK_ALL;
                 header.startEpoch = getTime();
                 Profile profile = controller->getProfileManager()->getSelectedProfile();
@@ -115,59 +132,53 @@ void ShotHistoryPlugin::record() {
                 strncpy(header.profileName, profile.label.c_str(), sizeof(header.profileName) - 1);
                 header.profileName[sizeof(header.profileName) - 1] = '\0';
                 header.phaseTransitionCount = 0; // Initialize phase transition count
+                header.headerCrc = shot_log::headerCrc(header);
+                encoder.reset();
                 // Write header placeholder
-                currentFile.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+                memcpy(writeBuffers[buffer].data, &header, sizeof(header));
+                writeBuffers[buffer].length = sizeof(header);
+                submitCommand(ShotLogCommandType::OPEN, buffer);
+            } else {
+                writerStats.droppedSamples++;
             }
         }
-        float btDiff = currentBluetoothWeight - lastBluetoothWeight;
-        float btFlow = btDiff / 0.25f;
-        currentBluetoothFlow = currentBluetoothFlow * 0.75f + btFlow * 0.25f;
-        lastBluetoothWeight = currentBluetoothWeight;
-
-        ShotLogSample sample{};
-        uint32_t tick = sampleCount <= 0xFFFF ? sampleCount : 0xFFFF;
-        sample.t = static_cast<uint16_t>(tick);
-        sample.tt = encodeUnsigned(controller->getTargetTemp(), TEMP_SCALE, TEMP_MAX_VALUE);
-        sample.ct = encodeUnsigned(currentTemperature, TEMP_SCALE, TEMP_MAX_VALUE);
-        sample.tp = encodeUnsigned(controller->getTargetPressure(), PRESSURE_SCALE, PRESSURE_MAX_VALUE);
-        sample.cp = encodeUnsigned(controller->getCurrentPressure(), PRESSURE_SCALE, PRESSURE_MAX_VALUE);
-        sample.fl = encodeSigned(controller->getCurrentPumpFlow(), FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
-        sample.tf = encodeSigned(controller->getTargetFlow(), FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
-        sample.pf = encodeSigned(controller->getCurrentPuckFlow(), FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
-        sample.vf = encodeSigned(currentBluetoothFlow, FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
-        sample.v = encodeUnsigned(currentBluetoothWeight, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
-        sample.ev = encodeUnsigned(currentEstimatedWeight, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
-        sample.pr = encodeUnsigned(currentPuckResistance, RESISTANCE_SCALE, RESISTANCE_MAX_VALUE);
-        sample.si = getSystemInfo(); // Pack system state information
-
-        // Track phase transitions
-        if (controller->getMode() == MODE_BREW) {
-            Process *process = controller->getProcess();
-            if (process != nullptr && process->getType() == MODE_BREW) {
-                auto *brewProcess = static_cast<BrewProcess *>(process);
-                uint8_t currentPhase = static_cast<uint8_t>(brewProcess->phaseIndex);
-
-                // Check for phase transition
-                if (currentPhase != lastRecordedPhase) {
-                    recordPhaseTransition(currentPhase, sampleCount);
-                    lastRecordedPhase = currentPhase;
+        const unsigned long now = millis();
+        const TelemetryBuffer &telemetry = controller->getTelemetry();
+        TelemetrySample latest{};
+        if (sampleOnSensorUpdate) {
+            // Log every sample that reached the telemetry since the last pass, batched controllers deliver a
+            // burst of control cycles per notification
+            bool recorded = false;
+            if (static_cast<int32_t>(nextTelemetry - telemetry.oldest()) < 0) {
+                nextTelemetry = telemetry.oldest(); // fell behind, the skipped samples are gone
+            }
+            for (const uint32_t last = telemetry.end(); nextTelemetry != last; nextTelemetry++) {
+                TelemetrySample sample{};
+                if (!telemetry.read(nextTelemetry, sample) || static_cast<int32_t>(sample.timestamp - shotStart) < 0) {
+                    continue;
                 }
+                recordSample(sample, sample.timestamp, sample.timestamp);
+                recorded = true;
             }
-        }
-
-        if (isFileOpen) {
-            if (ioBufferPos + sizeof(sample) > sizeof(ioBuffer)) {
-                flushBuffer();
+            if (!recorded) {
+                // Controller went quiet, keep sampling the weights
+                telemetry.latest(latest);
+                recordSample(latest, now, now);
+            }
+        } else {
+            // Sensor channels and targets from the latest telemetry sample; weights keep their own, faster cadence.
+            // Stamped with the arrival of the sensor data unless it is stale.
+            telemetry.latest(latest);
+            unsigned long sampleTime = controller->getLastSensorUpdate();
+            if (sampleTime < shotStart || now - sampleTime > 2 * SHOT_LOG_SAMPLE_INTERVAL_MS) {
+                sampleTime = now;
             }
-            memcpy(ioBuffer + ioBufferPos, &sample, sizeof(sample));
-            ioBufferPos += sizeof(sample);
-            sampleCount++;
+            recordSample(latest, now, sampleTime);
         }
 
         // Check for early index insertion (once per shot after 7.5s)
         if (!indexEntryCreated && (millis() - shotStart) > 7500) {
-            createEarlyIndexEntry();
-            indexEntryCreated = true;
+            indexEntryCreated = createEarlyIndexEntry();
         }
 
         // Check for weight stabilization during extended recording
@@ -208,49 +219,166 @@ void ShotHistoryPlugin::record() {
         }
     }
     if (!recording && !extendedRecording && isFileOpen) {
+        if (encoder.finish()) {
+            writeEncodedBlock();
+        }
         flushBuffer();
         // Patch header with sampleCount and duration
-        header.sampleCount = sampleCount;
+        header.sampleCount = sampleCount - shotDroppedSamples;
         header.durationMs = millis() - shotStart;
         float finalWeight = currentBluetoothWeight;
         header.finalWeight = finalWeight > 0.0f ? encodeUnsigned(finalWeight, WEIGHT_SCALE, WEIGHT_MAX_VALUE) : 0;
-        currentFile.seek(0, SeekSet);
-        currentFile.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
-        currentFile.close();
         isFileOpen = false;
-        unsigned long duration = header.durationMs;
-        if (duration <= 7500) { // Exclude failed shots and flushes
-            fs->remove("/h/" + currentId + ".slog");
-
-            // If we created an early index entry, mark it as deleted
-            if (indexEntryCreated) {
-                markIndexDeleted(currentId.toInt());
-            }
-        } else {
+        if (header.durationMs > 7500) {
+            // Claim the id now so a shot started before the writer catches up gets a fresh one
             controller->getSettings().setHistoryIndex(controller->getSettings().getHistoryIndex() + 1);
-            cleanupHistory();
+        }
+        // The final header must reach the writer. Without a free buffer it stays pending and goes out on a later tick,
+        // the sampler never waits for storage.
+        header.headerCrc = shot_log::headerCrc(header);
+        pendingClose.header = header;
+        pendingClose.summary = buildSummary();
+        pendingClose.shotId = currentId.toInt();
+        pendingClose.indexed = indexEntryCreated;
+        closePending = true;
+        submitClose();
+        if (shotDroppedSamples > 0) {
+            ESP_LOGW("ShotHistoryPlugin", "Shot %s lost %u samples, storage could not keep up", currentId.c_str(),
+                     shotDroppedSamples);
+        }
+    }
+}
 
-            if (indexEntryCreated) {
-                // Update existing entry with final completion data
-                updateIndexCompletion(currentId.toInt(), header);
-            } else {
-                // Create completed entry directly (edge case: shot ended right after 7.5s)
-                ShotIndexEntry indexEntry{};
-                indexEntry.id = currentId.toInt();
-                indexEntry.timestamp = header.startEpoch;
-                indexEntry.duration = header.durationMs;
-                indexEntry.volume = header.finalWeight;
-                indexEntry.rating = 0; // Will be updated if notes are added
-                indexEntry.flags = SHOT_FLAG_COMPLETED;
-                strncpy(indexEntry.profileId, header.profileId, sizeof(indexEntry.profileId) - 1);
-                indexEntry.profileId[sizeof(indexEntry.profileId) - 1] = '\0';
-                strncpy(indexEntry.profileName, header.profileName, sizeof(indexEntry.profileName) - 1);
-                indexEntry.profileName[sizeof(indexEntry.profileName) - 1] = '\0';
-
-                appendToIndex(indexEntry);
+void ShotHistoryPlugin::recordSample(const TelemetrySample &telemetry, unsigned long now, unsigned long sampleTime) {
+    // Backdated telemetry may predate a sample taken while the controller was quiet
+    const auto elapsed = static_cast<int32_t>(now - lastSampleTime);
+    float dt = elapsed > 0 ? elapsed / 1000.0f : 0.0f;
+    if (dt > 0.0f) {
+        float btDiff = currentBluetoothWeight - lastBluetoothWeight;
+        float btFlow = btDiff / dt;
+        currentBluetoothFlow = currentBluetoothFlow * 0.75f + btFlow * 0.25f;
+        lastSampleTime = now;
+    }
+    lastBluetoothWeight = currentBluetoothWeight;
+
+    ShotLogSample sample{};
+    sample.t = sampleTick(sampleTime);
+    sample.tt = encodeUnsigned(telemetry.targetTemperature, TEMP_SCALE, TEMP_MAX_VALUE);
+    sample.ct = encodeUnsigned(telemetry.temperature, TEMP_SCALE, TEMP_MAX_VALUE);
+    sample.tp = encodeUnsigned(telemetry.targetPressure, PRESSURE_SCALE, PRESSURE_MAX_VALUE);
+    sample.cp = encodeUnsigned(telemetry.pressure, PRESSURE_SCALE, PRESSURE_MAX_VALUE);
+    sample.fl = encodeSigned(telemetry.pumpFlow, FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
+    sample.tf = encodeSigned(telemetry.targetFlow, FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
+    sample.pf = encodeSigned(telemetry.puckFlow, FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
+    sample.vf = encodeSigned(currentBluetoothFlow, FLOW_SCALE, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
+    sample.v = encodeUnsigned(currentBluetoothWeight, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
+    sample.ev = encodeUnsigned(currentEstimatedWeight, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
+    sample.pr = encodeUnsigned(telemetry.puckResistance, RESISTANCE_SCALE, RESISTANCE_MAX_VALUE);
+    sample.si = getSystemInfo(); // Pack system state information
+
+    // Track phase transitions
+    bool preinfusion = false;
+    if (controller->getMode() == MODE_BREW) {
+        Process *process = controller->getProcess();
+        if (process != nullptr && process->getType() == MODE_BREW) {
+            auto *brewProcess = static_cast<BrewProcess *>(process);
+            uint8_t currentPhase = static_cast<uint8_t>(brewProcess->phaseIndex);
+            preinfusion = brewProcess->currentPhase().phase == PhaseType::PHASE_TYPE_PREINFUSION;
+
+            // Check for phase transition
+            if (currentPhase != lastRecordedPhase) {
+                recordPhaseTransition(currentPhase, sample.t);
+                lastRecordedPhase = currentPhase;
             }
         }
     }
+    if (recording) {
+        updateSummary(sample, dt, preinfusion);
+    }
+
+    if (isFileOpen) {
+        if (encoder.push(sample)) {
+            writeEncodedBlock();
+        }
+        sampleCount++;
+    }
+}
+
+void ShotHistoryPlugin::updateSummary(const ShotLogSample &sample, float dt, bool preinfusion) {
+    summarySamples++;
+    summaryPeakPressure = std::max(summaryPeakPressure, sample.cp);
+    summaryPressureSum += sample.cp;
+    summaryFlowSum += sample.fl;
+    if (sample.tt > 0) {
+        summaryTempErrorSum += static_cast<int32_t>(sample.ct) - sample.tt;
+        summaryTempSamples++;
+    }
+    if (summaryFirstDripMs == 0 && sample.pf >= FIRST_DRIP_PUCK_FLOW * FLOW_SCALE) {
+        summaryFirstDripMs = std::max<uint32_t>(lastSampleTime - shotStart, 1);
+    }
+    if (preinfusion) {
+        summaryPreinfusionMs += dt * 1000.0f;
+    }
+    if (sample.fl > 0) {
+        summaryWaterPumped += sample.fl / FLOW_SCALE * dt;
+    }
+}
+
+ShotSummary ShotHistoryPlugin::buildSummary() const {
+    ShotSummary summary{};
+    if (summarySamples == 0) {
+        return summary;
+    }
+    // Sums are already in sample units, so the encoders only round and clamp
+    summary.peakPressure = summaryPeakPressure;
+    summary.meanPressure = encodeUnsigned(static_cast<float>(summaryPressureSum) / summarySamples, 1.0f, PRESSURE_MAX_VALUE);
+    summary.meanFlow = encodeSigned(static_cast<float>(summaryFlowSum) / summarySamples, 1.0f, FLOW_MIN_VALUE, FLOW_MAX_VALUE);
+    if (summaryTempSamples > 0) {
+        summary.meanTempError = encodeSigned(static_cast<float>(summaryTempErrorSum) / summaryTempSamples, 1.0f,
+                                             -static_cast<int16_t>(TEMP_MAX_VALUE), TEMP_MAX_VALUE);
+    }
+    summary.firstDripMs = summaryFirstDripMs;
+    summary.preinfusionMs = static_cast<uint32_t>(summaryPreinfusionMs + 0.5f);
+    summary.waterPumped = encodeUnsigned(summaryWaterPumped, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
+    return summary;
+}
+
+void ShotHistoryPlugin::finalizeShot(uint32_t shotId, const ShotLogHeader &finalHeader, const ShotSummary &summary,
+                                     uint32_t logSize, bool indexed) {
+    String paddedId = padId(String(shotId));
+    // Exclude failed shots and flushes, and shots without a log to point the index at
+    if (finalHeader.durationMs <= 7500 || logSize == 0) {
+        fs->remove("/h/" + paddedId + ".slog");
+
+        // If we created an early index entry, mark it as deleted
+        if (indexed) {
+            markIndexDeleted(shotId);
+        }
+    } else {
+        if (indexed) {
+            // Update existing entry with final completion data
+            updateIndexCompletion(shotId, finalHeader, summary, logSize);
+        } else {
+            // Create completed entry directly (edge case: shot ended right after 7.5s)
+            ShotIndexEntry indexEntry{};
+            indexEntry.id = shotId;
+            indexEntry.timestamp = finalHeader.startEpoch;
+            indexEntry.duration = finalHeader.durationMs;
+            indexEntry.volume = finalHeader.finalWeight;
+            indexEntry.rating = 0; // Will be updated if notes are added
+            indexEntry.flags = SHOT_FLAG_COMPLETED | SHOT_FLAG_HAS_SUMMARY;
+            indexEntry.summary = summary;
+            indexEntry.logSize = logSize;
+            strncpy(indexEntry.profileId, finalHeader.profileId, sizeof(indexEntry.profileId) - 1);
+            indexEntry.profileId[sizeof(indexEntry.profileId) - 1] = '\0';
+            strncpy(indexEntry.profileName, finalHeader.profileName, sizeof(indexEntry.profileName) - 1);
+            indexEntry.profileName[sizeof(indexEntry.profileName) - 1] = '\0';
+
+            appendToIndex(indexEntry);
+        }
+        retentionPending = true;
+        lastShotFinalized = millis();
+    }
 }
 
 void ShotHistoryPlugin::startRecording() {
@@ -274,7 +402,26 @@ void ShotHistoryPlugin::startRecording() {
     extendedRecording = false;
     indexEntryCreated = false; // Reset flag for new shot
     sampleCount = 0;
-    ioBufferPos = 0;
+    shotDroppedSamples = 0;
+    lastSampleTime = shotStart;
+    lastTick = 0;
+    nextTelemetry = controller->getTelemetry().end();
+    summarySamples = 0;
+    summaryPeakPressure = 0;
+    summaryPressureSum = 0;
+    summaryFlowSum = 0;
+    summaryTempErrorSum = 0;
+    summaryTempSamples = 0;
+    summaryFirstDripMs = 0;
+    summaryPreinfusionMs = 0.0f;
+    summaryWaterPumped = 0.0f;
+
+    int interval = controller->getSettings().getHistorySampleInterval();
+    if (interval != HISTORY_SAMPLE_INTERVAL_SENSOR && interval != HISTORY_SAMPLE_INTERVAL_10HZ) {
+        interval = HISTORY_SAMPLE_INTERVAL_4HZ;
+    }
+    sampleOnSensorUpdate = interval == HISTORY_SAMPLE_INTERVAL_SENSOR;
+    sampleInterval = sampleOnSensorUpdate ? SHOT_LOG_SENSOR_TICK_MS : interval;
 
     // Reset phase tracking for new shot
     lastRecordedPhase = 0xFF; // Invalid value to detect first phase
@@ -283,6 +430,16 @@ void ShotHistoryPlugin::startRecording() {
     shotStartedVolumetric = controller->getSettings().isVolumetricTarget();
 }
 
+uint16_t ShotHistoryPlugin::sampleTick(unsigned long sampleTime) {
+    // In units of header.sampleInterval, never going backwards
+    uint32_t tick = (sampleTime - shotStart + sampleInterval / 2) / sampleInterval;
+    if (tick < lastTick) {
+        tick = lastTick;
+    }
+    lastTick = tick;
+    return static_cast<uint16_t>(tick <= 0xFFFF ? tick : 0xFFFF);
+}
+
 unsigned long ShotHistoryPlugin::getTime() {
     time_t now;
     time(&now);
@@ -307,7 +464,105 @@ void ShotHistoryPlugin::endExtendedRecording() {
     }
 }
 
-void ShotHistoryPlugin::recordPhaseTransition(uint8_t phaseNumber, uint16_t sampleIndex) {
+void ShotHistoryPlugin::applyRetention() {
+    // Runs on the writer task between commands, never while a shot is being recorded
+    if (recording || extendedRecording || isFileOpen || closePending) {
+        return;
+    }
+    unsigned long now = millis();
+    bool due = retentionPending ? now - lastShotFinalized >= HISTORY_RETENTION_DELAY
+                                : now - lastRetentionRun >= HISTORY_RETENTION_INTERVAL;
+    if (!due) {
+        return;
+    }
+    retentionPending = pruneHistory();
+    lastRetentionRun = now;
+}
+
+bool ShotHistoryPlugin::pruneHistory() {
+    Settings &settings = controller->getSettings();
+    bool sdCard = controller->isSDCard();
+    uint32_t maxCount = std::max(sdCard ? settings.getHistorySdRetentionCount() : settings.getHistoryRetentionCount(), 0);
+    uint64_t maxBytes = std::max(sdCard ? settings.getHistorySdRetentionSize() : settings.getHistoryRetentionSize(), 0) * 1024ULL;
+    uint32_t maxDays = std::max(sdCard ? settings.getHistorySdRetentionDays() : settings.getHistoryRetentionDays(), 0);
+
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
+        return false;
+    }
+
+    // Oldest first; ids are handed out in order, timestamps may be missing when the clock was not set
+    std::vector<uint32_t> live;
+    uint64_t bytes = 0;
+    for (uint32_t slot = 0; slot < indexEntries.size(); slot++) {
+        ShotIndexEntry &entry = indexEntries[slot];
+        if (entry.flags & SHOT_FLAG_DELETED) {
+            continue;
+        }
+        if (entry.logSize == 0) {
+            // Entry from before sizes were indexed, measure once
+            File shotFile = fs->open("/h/" + padId(String(entry.id)) + ".slog", "r");
+            if (shotFile) {
+                entry.logSize = shotFile.size();
+                shotFile.close();
+                writeIndexSlot(slot);
+            }
+        }
+        bytes += entry.logSize + entry.notesSize;
+        live.push_back(slot);
+    }
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) { return indexEntries[a].id < indexEntries[b].id; });
+
+    // Whatever the settings say, leave the rest of the filesystem room to work
+    uint64_t totalBytes = sdCard ? SD_MMC.totalBytes() : SPIFFS.totalBytes();
+    uint64_t usedBytes = sdCard ? SD_MMC.usedBytes() : SPIFFS.usedBytes();
+    uint64_t fillLimit = totalBytes * HISTORY_RETENTION_MAX_FILL / 100;
+    if (usedBytes > fillLimit) {
+        uint64_t allowed = bytes > usedBytes - fillLimit ? bytes - (usedBytes - fillLimit) : 0;
+        maxBytes = std::max<uint64_t>(maxBytes > 0 ? std::min(maxBytes, allowed) : allowed, 1);
+    }
+    uint32_t now = getTime();
+    uint64_t maxAge = maxDays * 86400ULL;
+    uint32_t cutoff = maxDays > 0 && now > 1609459200 && now > maxAge ? now - maxAge : 0; // only with a synced clock (after 2021)
+
+    uint32_t count = live.size();
+    uint32_t removed = 0;
+    for (size_t i = 0; i + 1 < live.size(); i++) { // the newest shot is always kept
+        uint32_t slot = live[i];
+        ShotIndexEntry &entry = indexEntries[slot];
+        bool overCount = maxCount > 0 && count > maxCount;
+        bool overSize = maxBytes > 0 && bytes > maxBytes;
+        bool tooOld = cutoff > 0 && entry.timestamp > 0 && entry.timestamp < cutoff;
+        if (!overCount && !overSize) {
+            if (cutoff == 0) {
+                break;
+            }
+            if (!tooOld) {
+                continue; // undated or recent, a later shot may still be past the cutoff
+            }
+        }
+        if (removed == HISTORY_RETENTION_BATCH) {
+            ESP_LOGI("ShotHistoryPlugin", "Retention removed %u shots, continuing on the next pass", removed);
+            return true;
+        }
+        String paddedId = padId(String(entry.id));
+        fs->remove("/h/" + paddedId + ".slog");
+        if (fs->exists("/h/" + paddedId + ".json")) {
+            fs->remove("/h/" + paddedId + ".json");
+        }
+        entry.flags |= SHOT_FLAG_DELETED;
+        writeIndexSlot(slot);
+        bytes -= std::min<uint64_t>(bytes, entry.logSize + entry.notesSize);
+        count--;
+        removed++;
+    }
+    if (removed > 0) {
+        ESP_LOGI("ShotHistoryPlugin", "Retention removed %u shots, %u left using %llu bytes", removed, count, bytes);
+    }
+    return false;
+}
+
+void ShotHistoryPlugin::recordPhaseTransition(uint8_t phaseNumber, uint16_t sampleTick) {
     // Only record if we have space and a valid header
     if (header.phaseTransitionCount >= 12 || !isFileOpen) {
         return;
@@ -317,7 +572,7 @@ void ShotHistoryPlugin::recordPhaseTransition(uint8_t phaseNumber, uint16_t samp
     Profile profile = controller->getProfileManager()->getSelectedProfile();
     PhaseTransition &transition = header.phaseTransitions[header.phaseTransitionCount];
 
-    transition.sampleIndex = sampleIndex;
+    transition.sampleTick = sampleTick;
     transition.phaseNumber = phaseNumber;
     transition.reserved = 0;
 
@@ -332,8 +587,8 @@ void ShotHistoryPlugin::recordPhaseTransition(uint8_t phaseNumber, uint16_t samp
 
     header.phaseTransitionCount++;
 
-    ESP_LOGD("ShotHistoryPlugin", "Recorded phase transition to phase %d (%s) at sample %d", phaseNumber, transition.phaseName,
-             sampleIndex);
+    ESP_LOGD("ShotHistoryPlugin", "Recorded phase transition to phase %d (%s) at tick %d", phaseNumber, transition.phaseName,
+             sampleTick);
 }
 
 uint16_t ShotHistoryPlugin::getSystemInfo() {
@@ -350,7 +605,7 @@ uint16_t ShotHistoryPlugin::getSystemInfo() {
         if (process != nullptr && process->getType() == MODE_BREW) {
             auto *brewProcess = static_cast<BrewProcess *>(process);
             bool currentlyVolumetric = brewProcess->target == ProcessTarget::VOLUMETRIC &&
-                                       brewProcess->currentPhase.hasVolumetricTarget() && controller->isVolumetricAvailable();
+                                       brewProcess->currentPhase().volumetric && controller->isVolumetricAvailable();
             if (currentlyVolumetric) {
                 systemInfo |= SYSTEM_INFO_CURRENTLY_VOLUMETRIC;
             }
@@ -375,65 +630,13 @@ uint16_t ShotHistoryPlugin::getSystemInfo() {
     return systemInfo;
 }
 
-void ShotHistoryPlugin::cleanupHistory() {
-    File directory = fs->open("/h");
-    std::vector<String> entries;
-    String filename = directory.getNextFileName();
-    while (filename != "") {
-        entries.push_back(filename);
-        filename = directory.getNextFileName();
-    }
-    sort(entries.begin(), entries.end(), [](String a, String b) { return a < b; });
-    if (entries.size() > MAX_HISTORY_ENTRIES) {
-        for (unsigned int i = 0; i < entries.size() - MAX_HISTORY_ENTRIES; i++) {
-            String name = entries[i];
-            fs->remove(name);
-        }
-    }
-}
-
 void ShotHistoryPlugin::handleRequest(JsonDocument &request, JsonDocument &response) {
     String type = request["tp"].as<String>();
     response["tp"] = String("res:") + type.substring(4);
     response["rid"] = request["rid"].as<String>();
 
     if (type == "req:history:list") {
-        JsonArray arr = response["history"].to<JsonArray>();
-        File root = fs->open("/h");
-        if (root && root.isDirectory()) {
-            File file = root.openNextFile();
-            while (file) {
-                String fname = String(file.name());
-                if (fname.endsWith(".slog")) {
-                    // Read header only
-                    ShotLogHeader hdr{};
-                    if (file.read(reinterpret_cast<uint8_t *>(&hdr), sizeof(hdr)) == sizeof(hdr) && hdr.magic == SHOT_LOG_MAGIC) {
-                        float finalWeight = hdr.finalWeight > 0 ? static_cast<float>(hdr.finalWeight) / WEIGHT_SCALE : 0.0f;
-
-                        bool headerIncomplete = hdr.sampleCount == 0;
-
-                        auto o = arr.add<JsonObject>();
-                        int start = fname.lastIndexOf('/') + 1;
-                        int end = fname.lastIndexOf('.');
-                        String id = fname.substring(start, end);
-                        o["id"] = id;
-                        o["version"] = hdr.version;
-                        o["timestamp"] = hdr.startEpoch;
-                        o["profile"] = hdr.profileName;
-                        o["profileId"] = hdr.profileId;
-                        o["samples"] = hdr.sampleCount;
-                        o["duration"] = hdr.durationMs;
-                        if (finalWeight > 0.0f) {
-                            o["volume"] = finalWeight;
-                        }
-                        if (headerIncomplete) {
-                            o["incomplete"] = true; // flag partial shot
-                        }
-                    }
-                }
-                file = root.openNextFile();
-            }
-        }
+        listHistory(request, response);
     } else if (type == "req:history:get") {
         // Return error: binary must be fetched via HTTP endpoint
         response["error"] = "use HTTP /api/history?id=<id>";
@@ -458,7 +661,7 @@ void ShotHistoryPlugin::handleRequest(JsonDocument &request, JsonDocument &respo
     } else if (type == "req:history:notes:save") {
         auto id = request["id"].as<String>();
         auto notes = request["notes"];
-        saveNotes(id, notes);
+        size_t notesSize = saveNotes(id, notes);
 
         // Update rating and volume in index
         uint8_t rating = notes["rating"].as<uint8_t>();
@@ -473,23 +676,140 @@ void ShotHistoryPlugin::handleRequest(JsonDocument &request, JsonDocument &respo
         }
 
         // Always use updateIndexMetadata - it handles both rating and optional volume
-        updateIndexMetadata(id.toInt(), rating, volume);
+        updateIndexMetadata(id.toInt(), rating, volume, std::min<size_t>(notesSize, UINT16_MAX));
 
         response["msg"] = "Ok";
     } else if (type == "req:history:rebuild") {
         rebuildIndex();
         response["msg"] = "Index rebuilt";
+    } else if (type == "req:history:stats") {
+        response["droppedSamples"] = writerStats.droppedSamples;
+        response["lateSamples"] = writerStats.lateSamples;
+        response["maxWriteLatencyUs"] = writerStats.maxWriteLatencyUs;
+        response["failedLogs"] = writerStats.failedLogs;
+    }
+}
+
+void ShotHistoryPlugin::listHistory(JsonDocument &request, JsonDocument &response) {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
+        response["error"] = "index unavailable";
+        return;
+    }
+
+    // Paging: newest first, "cursor" is the id of the last entry of the previous page
+    uint32_t cursor = request["cursor"].is<uint32_t>() ? request["cursor"].as<uint32_t>() : UINT32_MAX;
+    uint32_t limit = request["limit"].is<uint32_t>() ? request["limit"].as<uint32_t>() : HISTORY_LIST_DEFAULT_LIMIT;
+    if (limit == 0 || limit > HISTORY_LIST_MAX_LIMIT) {
+        limit = HISTORY_LIST_MAX_LIMIT;
+    }
+
+    // Filters, all optional
+    String profileId = request["profileId"].is<String>() ? request["profileId"].as<String>() : "";
+    uint8_t minRating = request["minRating"].is<uint8_t>() ? request["minRating"].as<uint8_t>() : 0;
+    uint8_t maxRating = request["maxRating"].is<uint8_t>() ? request["maxRating"].as<uint8_t>() : UINT8_MAX;
+    uint32_t from = request["from"].is<uint32_t>() ? request["from"].as<uint32_t>() : 0;
+    uint32_t to = request["to"].is<uint32_t>() ? request["to"].as<uint32_t>() : UINT32_MAX;
+    bool filterCompleted = request["completed"].is<bool>();
+    bool completed = request["completed"].as<bool>();
+    bool deleted = request["deleted"].is<bool>() && request["deleted"].as<bool>();
+
+    std::vector<uint32_t> matches;
+    for (uint32_t slot = 0; slot < indexEntries.size(); slot++) {
+        const ShotIndexEntry &entry = indexEntries[slot];
+        if (static_cast<bool>(entry.flags & SHOT_FLAG_DELETED) != deleted) {
+            continue;
+        }
+        if (filterCompleted && static_cast<bool>(entry.flags & SHOT_FLAG_COMPLETED) != completed) {
+            continue;
+        }
+        if (entry.rating < minRating || entry.rating > maxRating || entry.timestamp < from || entry.timestamp > to) {
+            continue;
+        }
+        if (!profileId.isEmpty() && strncmp(entry.profileId, profileId.c_str(), sizeof(entry.profileId)) != 0) {
+            continue;
+        }
+        matches.push_back(slot);
+    }
+    std::sort(matches.begin(), matches.end(), [this](uint32_t a, uint32_t b) { return indexEntries[a].id > indexEntries[b].id; });
+    response["total"] = matches.size();
+
+    JsonArray arr = response["history"].to<JsonArray>();
+    uint32_t count = 0;
+    uint32_t lastId = 0;
+    bool more = false;
+    for (uint32_t slot : matches) {
+        const ShotIndexEntry &entry = indexEntries[slot];
+        if (entry.id >= cursor) {
+            continue;
+        }
+        if (count == limit) {
+            more = true;
+            break;
+        }
+        auto o = arr.add<JsonObject>();
+        o["id"] = padId(String(entry.id));
+        o["timestamp"] = entry.timestamp;
+        o["profile"] = entry.profileName;
+        o["profileId"] = entry.profileId;
+        o["duration"] = entry.duration;
+        if (entry.volume > 0) {
+            o["volume"] = static_cast<float>(entry.volume) / WEIGHT_SCALE;
+        }
+        if (entry.rating > 0) {
+            o["rating"] = entry.rating;
+        }
+        if (entry.flags & SHOT_FLAG_HAS_NOTES) {
+            o["notes"] = true;
+        }
+        if (!(entry.flags & SHOT_FLAG_COMPLETED)) {
+            o["incomplete"] = true; // flag partial shot
+        }
+        if (entry.flags & SHOT_FLAG_DELETED) {
+            o["deleted"] = true;
+        }
+        if (entry.flags & SHOT_FLAG_HAS_SUMMARY) {
+            auto summary = o["summary"].to<JsonObject>();
+            summary["peakPressure"] = entry.summary.peakPressure / PRESSURE_SCALE;
+            summary["meanPressure"] = entry.summary.meanPressure / PRESSURE_SCALE;
+            summary["meanFlow"] = entry.summary.meanFlow / FLOW_SCALE;
+            summary["meanTempError"] = entry.summary.meanTempError / TEMP_SCALE;
+            if (entry.summary.firstDripMs > 0) {
+                summary["firstDrip"] = entry.summary.firstDripMs;
+            }
+            summary["preinfusion"] = entry.summary.preinfusionMs;
+            summary["waterPumped"] = entry.summary.waterPumped / WEIGHT_SCALE;
+        }
+        lastId = entry.id;
+        count++;
     }
+    if (more) {
+        response["next"] = lastId;
+    }
+}
+
+std::shared_ptr<ShotLogDownsampler> ShotHistoryPlugin::openDownsampled(uint32_t shotId, uint16_t points,
+                                                                       const String &fields) {
+    String paddedId = padId(String(shotId));
+    String path = "/h/" + paddedId + ".slog";
+    auto curve = std::make_shared<ShotLogDownsampler>();
+    points = std::min(std::max(points, HISTORY_CURVE_MIN_POINTS), HISTORY_CURVE_MAX_POINTS);
+    if (!curve->begin(fs->open(path, "r"), fs->open(path, "r"), paddedId.c_str(), points, fields.c_str())) {
+        return nullptr;
+    }
+    return curve;
 }
 
-void ShotHistoryPlugin::saveNotes(const String &id, const JsonDocument &notes) {
+size_t ShotHistoryPlugin::saveNotes(const String &id, const JsonDocument &notes) {
     File file = fs->open("/h/" + id + ".json", FILE_WRITE);
-    if (file) {
-        String notesStr;
-        serializeJson(notes, notesStr);
-        file.print(notesStr);
-        file.close();
+    if (!file) {
+        return 0;
     }
+    String notesStr;
+    serializeJson(notes, notesStr);
+    size_t written = file.print(notesStr);
+    file.close();
+    return written;
 }
 
 void ShotHistoryPlugin::loadNotes(const String &id, JsonDocument &notes) {
@@ -503,23 +823,167 @@ void ShotHistoryPlugin::loadNotes(const String &id, JsonDocument &notes) {
 
 void ShotHistoryPlugin::loopTask(void *arg) {
     auto *plugin = static_cast<ShotHistoryPlugin *>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
     while (true) {
         plugin->record();
-        // Use canonical interval from shot log format to avoid divergence.
-        vTaskDelay(SHOT_LOG_SAMPLE_INTERVAL_MS / portTICK_PERIOD_MS);
+        bool active = plugin->recording || plugin->extendedRecording;
+        if (active && plugin->sampleOnSensorUpdate) {
+            // Wait for the next notification, but keep sampling if the controller goes quiet
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2 * SHOT_LOG_SAMPLE_INTERVAL_MS));
+            lastWake = xTaskGetTickCount();
+            continue;
+        }
+        uint32_t interval = active ? plugin->sampleInterval : SHOT_LOG_SAMPLE_INTERVAL_MS;
+        if (xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(interval)) == pdFALSE && plugin->isFileOpen) {
+            // Deadline already passed, the previous sample ran long
+            plugin->writerStats.lateSamples++;
+        }
+    }
+}
+
+void ShotHistoryPlugin::writerTask(void *arg) {
+    auto *plugin = static_cast<ShotHistoryPlugin *>(arg);
+    ShotLogCommand command{};
+    while (true) {
+        if (xQueueReceive(plugin->writerQueue, &command, pdMS_TO_TICKS(HISTORY_RETENTION_POLL)) == pdTRUE) {
+            plugin->processCommand(command);
+        } else {
+            plugin->applyRetention();
+        }
+    }
+}
+
+void ShotHistoryPlugin::processCommand(const ShotLogCommand &command) {
+    ShotLogBuffer &buffer = writeBuffers[command.buffer];
+    unsigned long start = micros();
+    bool bufferReturned = false;
+    switch (command.type) {
+    case ShotLogCommandType::OPEN:
+        if (!fs->exists("/h")) {
+            fs->mkdir("/h");
+        }
+        currentFile = fs->open("/h/" + padId(String(command.shotId)) + ".slog", FILE_WRITE);
+        if (currentFile) {
+            currentFile.write(buffer.data, buffer.length);
+        } else {
+            // The sampler does not wait for this, its blocks are discarded and counted when the shot closes
+            writerStats.failedLogs++;
+            ESP_LOGE("ShotHistoryPlugin", "Failed to open log for shot %u", command.shotId);
+        }
+        break;
+    case ShotLogCommandType::WRITE:
+        if (currentFile) {
+            currentFile.write(buffer.data, buffer.length);
+        }
+        break;
+    case ShotLogCommandType::CLOSE: {
+        ShotLogHeader finalHeader{};
+        ShotSummary summary{};
+        uint32_t logSize = 0;
+        memcpy(&finalHeader, buffer.data, sizeof(finalHeader));
+        memcpy(&summary, buffer.data + sizeof(finalHeader), sizeof(summary));
+        if (currentFile) {
+            currentFile.seek(0, SeekSet);
+            currentFile.write(reinterpret_cast<const uint8_t *>(&finalHeader), sizeof(finalHeader));
+            logSize = currentFile.size();
+            currentFile.close();
+        } else {
+            writerStats.droppedSamples += finalHeader.sampleCount;
+            ESP_LOGE("ShotHistoryPlugin", "Shot %u lost all %u samples, its log could not be created", command.shotId,
+                     finalHeader.sampleCount);
+        }
+        // Hand the buffer back before the slower index work
+        xQueueSend(freeBuffers, &command.buffer, 0);
+        bufferReturned = true;
+        finalizeShot(command.shotId, finalHeader, summary, logSize, command.indexed);
+        break;
+    }
+    case ShotLogCommandType::INDEX: {
+        ShotIndexEntry entry{};
+        memcpy(&entry, buffer.data, sizeof(entry));
+        appendToIndex(entry);
+        break;
+    }
+    }
+    uint32_t latency = micros() - start;
+    if (latency > writerStats.maxWriteLatencyUs) {
+        writerStats.maxWriteLatencyUs = latency;
+    }
+    if (command.type == ShotLogCommandType::CLOSE) {
+        ESP_LOGI("ShotHistoryPlugin", "Writer stats: %u dropped, %u late samples, max write latency %u us",
+                 writerStats.droppedSamples, writerStats.lateSamples, writerStats.maxWriteLatencyUs);
+    }
+    if (!bufferReturned) {
+        xQueueSend(freeBuffers, &command.buffer, 0);
     }
 }
 
+int8_t ShotHistoryPlugin::acquireBuffer(TickType_t wait) {
+    int8_t buffer = -1;
+    if (xQueueReceive(freeBuffers, &buffer, wait) != pdTRUE) {
+        return -1;
+    }
+    writeBuffers[buffer].length = 0;
+    return buffer;
+}
+
+void ShotHistoryPlugin::submitCommand(ShotLogCommandType type, int8_t buffer, bool indexed) {
+    ShotLogCommand command{};
+    command.type = type;
+    command.buffer = buffer;
+    command.indexed = indexed;
+    command.shotId = currentId.toInt();
+    // The queue holds more slots than there are buffers, so this never has to wait
+    xQueueSend(writerQueue, &command, portMAX_DELAY);
+}
+
+bool ShotHistoryPlugin::submitClose() {
+    int8_t buffer = acquireBuffer(0);
+    if (buffer < 0) {
+        return false;
+    }
+    memcpy(writeBuffers[buffer].data, &pendingClose.header, sizeof(pendingClose.header));
+    memcpy(writeBuffers[buffer].data + sizeof(pendingClose.header), &pendingClose.summary, sizeof(pendingClose.summary));
+    writeBuffers[buffer].length = sizeof(pendingClose.header) + sizeof(pendingClose.summary);
+    ShotLogCommand command{};
+    command.type = ShotLogCommandType::CLOSE;
+    command.buffer = buffer;
+    command.indexed = pendingClose.indexed;
+    command.shotId = pendingClose.shotId; // a new shot may already have taken currentId
+    xQueueSend(writerQueue, &command, portMAX_DELAY); // holds a buffer, so the queue has room
+    closePending = false;
+    return true;
+}
+
 void ShotHistoryPlugin::flushBuffer() {
-    if (isFileOpen && ioBufferPos > 0) {
-        currentFile.write(ioBuffer, ioBufferPos);
-        ioBufferPos = 0;
+    if (activeBuffer >= 0) {
+        submitCommand(ShotLogCommandType::WRITE, activeBuffer);
+        activeBuffer = -1;
+    }
+}
+
+void ShotHistoryPlugin::writeEncodedBlock() {
+    if (activeBuffer >= 0 && writeBuffers[activeBuffer].length + encoder.size() > SHOT_LOG_BUFFER_SIZE) {
+        flushBuffer();
+    }
+    if (activeBuffer < 0) {
+        activeBuffer = acquireBuffer(0);
+        if (activeBuffer < 0) {
+            // Storage is behind; blocks decode independently so dropping one keeps the file readable
+            writerStats.droppedSamples += encoder.data()[2];
+            shotDroppedSamples += encoder.data()[2];
+            return;
+        }
     }
+    ShotLogBuffer &buffer = writeBuffers[activeBuffer];
+    memcpy(buffer.data + buffer.length, encoder.data(), encoder.size());
+    buffer.length += encoder.size();
 }
 
 // Index management methods
 bool ShotHistoryPlugin::ensureIndexExists() {
-    if (fs->exists("/h/index.bin")) {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (indexLoaded || fs->exists("/h/index.bin")) {
         return true;
     }
 
@@ -536,9 +1000,15 @@ bool ShotHistoryPlugin::ensureIndexExists() {
     header.entrySize = SHOT_INDEX_ENTRY_SIZE;
     header.entryCount = 0;
     header.nextId = controller->getSettings().getHistoryIndex();
+    header.generation = controller->getSettings().getHistoryIndexGeneration();
 
     indexFile.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
     indexFile.close();
+    dropIndexJournal();
+
+    indexHeader = header;
+    indexEntries.clear();
+    indexLoaded = true;
 
     ESP_LOGI("ShotHistoryPlugin", "Created new index file");
     return true;
@@ -549,223 +1019,323 @@ void ShotHistoryPlugin::appendToIndex(const ShotIndexEntry &entry) {
         return;
     }
 
-    File indexFile = fs->open("/h/index.bin", "r+");
-    if (!indexFile) {
-        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for append");
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
         return;
     }
 
-    ShotIndexHeader header{};
-    if (!readIndexHeader(indexFile, header)) {
-        indexFile.close();
+    // An id reused after a discarded shot recycles its slot instead of growing the index
+    int slot = indexEntries.insert(entry);
+    if (slot < 0) {
+        ESP_LOGW("ShotHistoryPlugin", "Attempt to add duplicate entry for shot %u - entry already exists at slot %d",
+                 entry.id, indexEntries.find(entry.id));
         return;
     }
-
-    // Check for existing entry with same ID to prevent duplicates
-    int existingPos = findEntryPosition(indexFile, header, entry.id);
-    if (existingPos >= 0) {
-        ESP_LOGW("ShotHistoryPlugin", "Attempt to add duplicate entry for shot %u - entry already exists at position %d",
-                 entry.id, existingPos);
-        indexFile.close();
-        return;
+    indexHeader.entryCount = indexEntries.size();
+    if (entry.id + 1 > indexHeader.nextId) {
+        indexHeader.nextId = entry.id + 1;
     }
+    indexHeader.generation++;
 
-    // Append entry
-    indexFile.seek(0, SeekEnd);
-    indexFile.write(reinterpret_cast<const uint8_t *>(&entry), sizeof(entry));
-
-    // Update header
-    header.entryCount++;
-    header.nextId = entry.id + 1;
-    indexFile.seek(0, SeekSet);
-    indexFile.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
-
-    indexFile.close();
-    ESP_LOGD("ShotHistoryPlugin", "Appended shot %u to index", entry.id);
+    if (writeIndexSlot(slot, true)) {
+        controller->getSettings().setHistoryIndexGeneration(indexHeader.generation);
+        ESP_LOGD("ShotHistoryPlugin", "Appended shot %u to index", entry.id);
+    }
 }
 
-void ShotHistoryPlugin::updateIndexMetadata(uint32_t shotId, uint8_t rating, uint16_t volume) {
-    File indexFile = fs->open("/h/index.bin", "r+");
-    if (!indexFile) {
-        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for metadata update");
+void ShotHistoryPlugin::updateIndexMetadata(uint32_t shotId, uint8_t rating, uint16_t volume, uint16_t notesSize) {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
         return;
     }
 
-    ShotIndexHeader header{};
-    if (!readIndexHeader(indexFile, header)) {
-        indexFile.close();
+    int slot = indexEntries.find(shotId);
+    if (slot < 0) {
+        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for metadata update", shotId);
         return;
     }
 
-    int entryPos = findEntryPosition(indexFile, header, shotId);
-    if (entryPos >= 0) {
-        ShotIndexEntry entry{};
-        if (readEntryAtPosition(indexFile, entryPos, entry)) {
-            entry.rating = rating;
-            if (volume > 0) {
-                entry.volume = volume;
-            }
-            if (rating > 0) {
-                entry.flags |= SHOT_FLAG_HAS_NOTES;
-            }
-
-            if (writeEntryAtPosition(indexFile, entryPos, entry)) {
-                ESP_LOGD("ShotHistoryPlugin", "Updated metadata for shot %u: rating=%u, volume=%u", shotId, rating, volume);
-            }
-        }
-    } else {
-        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for metadata update", shotId);
+    ShotIndexEntry &entry = indexEntries[slot];
+    entry.rating = rating;
+    entry.notesSize = notesSize;
+    if (volume > 0) {
+        entry.volume = volume;
+    }
+    if (rating > 0) {
+        entry.flags |= SHOT_FLAG_HAS_NOTES;
     }
 
-    indexFile.close();
+    if (writeIndexSlot(slot)) {
+        ESP_LOGD("ShotHistoryPlugin", "Updated metadata for shot %u: rating=%u, volume=%u", shotId, rating, volume);
+    }
 }
 
 void ShotHistoryPlugin::markIndexDeleted(uint32_t shotId) {
-    File indexFile = fs->open("/h/index.bin", "r+");
-    if (!indexFile) {
-        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for deletion marking");
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
         return;
     }
 
-    ShotIndexHeader header{};
-    if (!readIndexHeader(indexFile, header)) {
-        indexFile.close();
+    // Duplicates are collapsed while loading, so there is at most one live slot per id
+    int slot = indexEntries.find(shotId);
+    if (slot < 0) {
+        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for deletion marking", shotId);
         return;
     }
 
-    // Find ALL entries with this shot ID and mark them as deleted
-    uint32_t duplicatesFound = 0;
-
-    for (uint32_t i = 0; i < header.entryCount; i++) {
-        size_t entryPos = sizeof(ShotIndexHeader) + i * sizeof(ShotIndexEntry);
-        ShotIndexEntry entry{};
-        if (readEntryAtPosition(indexFile, entryPos, entry)) {
-            if (entry.id == shotId) {
-                duplicatesFound++;
-
-                // Mark this entry as deleted
-                entry.flags |= SHOT_FLAG_DELETED;
+    indexEntries[slot].flags |= SHOT_FLAG_DELETED;
+    if (writeIndexSlot(slot)) {
+        ESP_LOGD("ShotHistoryPlugin", "Marked shot %u as deleted in index", shotId);
+    }
+}
 
-                if (writeEntryAtPosition(indexFile, entryPos, entry)) {
-                    ESP_LOGD("ShotHistoryPlugin", "Marked shot %u as deleted in index (duplicate #%u)", shotId, duplicatesFound);
+void ShotHistoryPlugin::recoverIndex() {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    uint32_t replayed = replayIndexJournal();
+    if (replayed > 0) {
+        ESP_LOGW("ShotHistoryPlugin", "Replayed %u index writes from journal", replayed);
+    }
+    if (!fs->exists("/h/index.bin") || !loadIndex()) {
+        rebuildIndex();
+        return;
+    }
+    repairIncompleteEntries();
+
+    Settings &settings = controller->getSettings();
+    uint32_t historyIndex = settings.getHistoryIndex();
+    uint32_t added = 0;
+    if (indexHeader.generation < static_cast<uint32_t>(settings.getHistoryIndexGeneration())) {
+        // The index is older than the last write we know of, compare it against the directory
+        ESP_LOGW("ShotHistoryPlugin", "Index generation %u behind settings (%d), reconciling with directory",
+                 indexHeader.generation, settings.getHistoryIndexGeneration());
+        std::vector<uint32_t> shotIds = listShotIds();
+        for (uint32_t shotId : shotIds) {
+            if (indexEntries.find(shotId) < 0) {
+                ShotIndexEntry entry{};
+                if (buildIndexEntry(shotId, entry)) {
+                    appendToIndex(entry);
+                    added++;
                 }
             }
         }
+        for (uint32_t slot = 0; slot < indexEntries.size(); slot++) {
+            ShotIndexEntry &entry = indexEntries[slot];
+            if (!(entry.flags & SHOT_FLAG_DELETED) && !std::binary_search(shotIds.begin(), shotIds.end(), entry.id)) {
+                entry.flags |= SHOT_FLAG_DELETED;
+                writeIndexSlot(slot);
+            }
+        }
+    } else {
+        // Only shots finished after the last index write can be missing
+        for (uint32_t shotId = indexHeader.nextId; shotId < historyIndex; shotId++) {
+            ShotIndexEntry entry{};
+            if (buildIndexEntry(shotId, entry)) {
+                appendToIndex(entry);
+                added++;
+            }
+        }
     }
 
-    if (duplicatesFound == 0) {
-        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for deletion marking", shotId);
-    } else if (duplicatesFound > 1) {
-        ESP_LOGW("ShotHistoryPlugin", "Found and marked %u duplicate entries for shot %u as deleted", duplicatesFound, shotId);
+    // An interrupted shot leaves an early index entry without advancing the history index; never hand its id out again
+    if (indexHeader.nextId > historyIndex) {
+        settings.setHistoryIndex(indexHeader.nextId);
+    }
+    if (static_cast<uint32_t>(settings.getHistoryIndexGeneration()) != indexHeader.generation) {
+        settings.setHistoryIndexGeneration(indexHeader.generation);
     }
 
-    indexFile.close();
+    ESP_LOGI("ShotHistoryPlugin", "Index recovered with %u entries, %u reconciled", indexHeader.entryCount, added);
+}
+
+void ShotHistoryPlugin::repairIncompleteEntries() {
+    // Nothing records during boot, so every incomplete entry belongs to a shot cut off by a reset or power loss
+    for (uint32_t slot = 0; slot < indexEntries.size(); slot++) {
+        ShotIndexEntry &entry = indexEntries[slot];
+        if (entry.flags & (SHOT_FLAG_COMPLETED | SHOT_FLAG_DELETED)) {
+            continue;
+        }
+        ShotIndexEntry repaired{};
+        if (buildIndexEntry(entry.id, repaired)) {
+            entry = repaired;
+        } else {
+            entry.flags |= SHOT_FLAG_DELETED;
+        }
+        writeIndexSlot(slot);
+        ESP_LOGI("ShotHistoryPlugin", "Recovered interrupted shot %u%s", entry.id,
+                 entry.flags & SHOT_FLAG_DELETED ? ", log missing" : "");
+    }
+}
+
+bool ShotHistoryPlugin::repairShotLog(const String &path, ShotLogHeader &shotHeader) {
+    File shotFile = fs->open(path, "r");
+    if (!shotFile) {
+        return false;
+    }
+    auto reader = make_unique<ShotLogReader>();
+    uint32_t count = 0;
+    uint32_t lastTick = 0;
+    if (reader->begin(shotFile)) {
+        ShotLogSample sample{};
+        while (reader->next(sample)) {
+            lastTick = sample.t;
+            count++;
+        }
+    }
+    shotFile.close();
+    if (count == 0) {
+        return false;
+    }
+
+    // The samples that made it to storage are intact, only the final header patch is missing
+    shotHeader.sampleCount = count;
+    shotHeader.durationMs = lastTick * shotHeader.sampleInterval;
+    shotHeader.headerCrc = shot_log::headerCrc(shotHeader);
+    shotFile = fs->open(path, "r+");
+    if (!shotFile) {
+        return false;
+    }
+    shotFile.seek(0, SeekSet);
+    bool ok = shotFile.write(reinterpret_cast<const uint8_t *>(&shotHeader), sizeof(shotHeader)) == sizeof(shotHeader);
+    shotFile.close();
+    ESP_LOGI("ShotHistoryPlugin", "Repaired %s: %u samples, %u ms", path.c_str(), count, shotHeader.durationMs);
+    return ok;
 }
 
 void ShotHistoryPlugin::rebuildIndex() {
     ESP_LOGI("ShotHistoryPlugin", "Starting index rebuild...");
 
-    // Delete existing index
-    fs->remove("/h/index.bin");
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    dropIndexJournal(); // journaled writes target the old layout
+    Settings &settings = controller->getSettings();
+    uint32_t generation = std::max(indexHeader.generation, static_cast<uint32_t>(settings.getHistoryIndexGeneration()));
 
-    // Create new empty index
-    if (!ensureIndexExists()) {
+    std::vector<uint32_t> shotIds = listShotIds();
+    ESP_LOGI("ShotHistoryPlugin", "Rebuilding index from %d shot files", shotIds.size());
+
+    indexEntries.clear();
+    indexEntries.reserve(shotIds.size());
+    for (uint32_t shotId : shotIds) {
+        ShotIndexEntry entry{};
+        if (buildIndexEntry(shotId, entry)) {
+            indexEntries.insert(entry);
+        }
+    }
+
+    memset(&indexHeader, 0, sizeof(indexHeader));
+    indexHeader.magic = SHOT_INDEX_MAGIC;
+    indexHeader.version = SHOT_INDEX_VERSION;
+    indexHeader.entrySize = SHOT_INDEX_ENTRY_SIZE;
+    indexHeader.entryCount = indexEntries.size();
+    indexHeader.nextId = std::max<uint32_t>(settings.getHistoryIndex(), shotIds.empty() ? 0 : shotIds.back() + 1);
+    indexHeader.generation = generation + 1;
+    indexLoaded = true;
+
+    // Write the whole file in one pass
+    if (!fs->exists("/h")) {
+        fs->mkdir("/h");
+    }
+    File indexFile = fs->open("/h/index.bin", FILE_WRITE);
+    if (!indexFile) {
         ESP_LOGE("ShotHistoryPlugin", "Failed to create index during rebuild");
+        indexLoaded = false;
         return;
     }
+    indexFile.write(reinterpret_cast<const uint8_t *>(&indexHeader), sizeof(indexHeader));
+    indexFile.write(reinterpret_cast<const uint8_t *>(indexEntries.data()), indexEntries.size() * sizeof(ShotIndexEntry));
+    indexFile.close();
+    settings.setHistoryIndexGeneration(indexHeader.generation);
 
+    ESP_LOGI("ShotHistoryPlugin", "Index rebuild completed");
+}
+
+std::vector<uint32_t> ShotHistoryPlugin::listShotIds() {
+    std::vector<uint32_t> shotIds;
     File directory = fs->open("/h");
     if (!directory || !directory.isDirectory()) {
         ESP_LOGW("ShotHistoryPlugin", "No history directory found");
-        return;
+        return shotIds;
     }
 
-    // Collect all .slog files
-    std::vector<String> slogFiles;
-    File file = directory.openNextFile();
-    while (file) {
-        String fname = String(file.name());
+    String fname = directory.getNextFileName();
+    while (fname != "") {
         if (fname.endsWith(".slog")) {
-            slogFiles.push_back(fname);
+            int start = fname.lastIndexOf('/') + 1;
+            int end = fname.lastIndexOf('.');
+            shotIds.push_back(fname.substring(start, end).toInt());
         }
-        file = directory.openNextFile();
+        fname = directory.getNextFileName();
     }
     directory.close();
 
-    // Sort files to maintain order
-    std::sort(slogFiles.begin(), slogFiles.end());
-
-    ESP_LOGI("ShotHistoryPlugin", "Rebuilding index from %d shot files", slogFiles.size());
+    std::sort(shotIds.begin(), shotIds.end());
+    return shotIds;
+}
 
-    for (const String &fileName : slogFiles) {
-        File shotFile = fs->open(fileName, "r");
-        if (!shotFile) {
-            continue;
-        }
+bool ShotHistoryPlugin::buildIndexEntry(uint32_t shotId, ShotIndexEntry &entry) {
+    String paddedId = padId(String(shotId));
+    String path = "/h/" + paddedId + ".slog";
+    File shotFile = fs->open(path, "r");
+    if (!shotFile) {
+        return false;
+    }
 
-        // Read shot header
-        ShotLogHeader shotHeader{};
-        if (shotFile.read(reinterpret_cast<uint8_t *>(&shotHeader), sizeof(shotHeader)) != sizeof(shotHeader) ||
-            shotHeader.magic != SHOT_LOG_MAGIC) {
-            shotFile.close();
-            continue;
-        }
+    // Read shot header
+    ShotLogHeader shotHeader{};
+    if (shotFile.read(reinterpret_cast<uint8_t *>(&shotHeader), sizeof(shotHeader)) != sizeof(shotHeader) ||
+        shotHeader.magic != SHOT_LOG_MAGIC) {
+        shotFile.close();
+        return false;
+    }
+    size_t logSize = shotFile.size();
+    shotFile.close();
+    bool torn = shotHeader.headerCrc != 0 && shotHeader.headerCrc != shot_log::headerCrc(shotHeader);
+    if ((shotHeader.sampleCount == 0 || torn) && !repairShotLog(path, shotHeader)) {
+        shotHeader.sampleCount = 0;
+    }
 
-        // Extract shot ID from filename
-        int start = fileName.lastIndexOf('/') + 1;
-        int end = fileName.lastIndexOf('.');
-        uint32_t shotId = fileName.substring(start, end).toInt();
+    entry.id = shotId;
+    entry.timestamp = shotHeader.startEpoch;
+    entry.duration = shotHeader.durationMs;
+    entry.volume = shotHeader.finalWeight;
+    entry.logSize = logSize;
+    entry.rating = 0; // Will be updated if notes exist
+    entry.flags = SHOT_FLAG_COMPLETED;
+    strncpy(entry.profileId, shotHeader.profileId, sizeof(entry.profileId) - 1);
+    entry.profileId[sizeof(entry.profileId) - 1] = '\0';
+    strncpy(entry.profileName, shotHeader.profileName, sizeof(entry.profileName) - 1);
+    entry.profileName[sizeof(entry.profileName) - 1] = '\0';
+
+    // Shots without any readable sample stay incomplete
+    if (shotHeader.sampleCount == 0) {
+        entry.flags &= ~SHOT_FLAG_COMPLETED;
+    }
 
-        // Create index entry
-        ShotIndexEntry entry{};
-        entry.id = shotId;
-        entry.timestamp = shotHeader.startEpoch;
-        entry.duration = shotHeader.durationMs;
-        entry.volume = shotHeader.finalWeight;
-        entry.rating = 0; // Will be updated if notes exist
-        entry.flags = SHOT_FLAG_COMPLETED;
-        strncpy(entry.profileId, shotHeader.profileId, sizeof(entry.profileId) - 1);
-        entry.profileId[sizeof(entry.profileId) - 1] = '\0';
-        strncpy(entry.profileName, shotHeader.profileName, sizeof(entry.profileName) - 1);
-        entry.profileName[sizeof(entry.profileName) - 1] = '\0';
-
-        // Check for incomplete shots
-        if (shotHeader.sampleCount == 0) {
-            entry.flags &= ~SHOT_FLAG_COMPLETED;
-        }
-
-        // Check for notes and extract rating and volume override
-        String notesPath = "/h/" + String(shotId, 10) + ".json";
-        if (fs->exists(notesPath)) {
-            entry.flags |= SHOT_FLAG_HAS_NOTES;
-
-            File notesFile = fs->open(notesPath, "r");
-            if (notesFile) {
-                String notesStr = notesFile.readString();
-                notesFile.close();
-
-                JsonDocument notesDoc;
-                if (deserializeJson(notesDoc, notesStr) == DeserializationError::Ok) {
-                    entry.rating = notesDoc["rating"].as<uint8_t>();
-
-                    // Check if user provided a doseOut value to override volume
-                    if (notesDoc["doseOut"].is<String>() && !notesDoc["doseOut"].as<String>().isEmpty()) {
-                        float doseOut = notesDoc["doseOut"].as<String>().toFloat();
-                        if (doseOut > 0.0f) {
-                            entry.volume = encodeUnsigned(doseOut, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
-                        }
+    // Check for notes and extract rating and volume override
+    String notesPath = "/h/" + paddedId + ".json";
+    if (fs->exists(notesPath)) {
+        entry.flags |= SHOT_FLAG_HAS_NOTES;
+
+        File notesFile = fs->open(notesPath, "r");
+        if (notesFile) {
+            String notesStr = notesFile.readString();
+            notesFile.close();
+            entry.notesSize = std::min<size_t>(notesStr.length(), UINT16_MAX);
+
+            JsonDocument notesDoc;
+            if (deserializeJson(notesDoc, notesStr) == DeserializationError::Ok) {
+                entry.rating = notesDoc["rating"].as<uint8_t>();
+
+                // Check if user provided a doseOut value to override volume
+                if (notesDoc["doseOut"].is<String>() && !notesDoc["doseOut"].as<String>().isEmpty()) {
+                    float doseOut = notesDoc["doseOut"].as<String>().toFloat();
+                    if (doseOut > 0.0f) {
+                        entry.volume = encodeUnsigned(doseOut, WEIGHT_SCALE, WEIGHT_MAX_VALUE);
                     }
                 }
             }
         }
-
-        shotFile.close();
-
-        // Append to index
-        appendToIndex(entry);
     }
-
-    ESP_LOGI("ShotHistoryPlugin", "Index rebuild completed");
+    return true;
 }
 
 // Index helper functions
@@ -781,33 +1351,118 @@ bool ShotHistoryPlugin::readIndexHeader(File &indexFile, ShotIndexHeader &header
     return true;
 }
 
-int ShotHistoryPlugin::findEntryPosition(File &indexFile, const ShotIndexHeader &header, uint32_t shotId) {
-    for (uint32_t i = 0; i < header.entryCount; i++) {
-        size_t entryPos = sizeof(ShotIndexHeader) + i * sizeof(ShotIndexEntry);
-        indexFile.seek(entryPos, SeekSet);
+bool ShotHistoryPlugin::loadIndex() {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (indexLoaded) {
+        return true;
+    }
 
-        ShotIndexEntry entry{};
-        if (!readEntryAtPosition(indexFile, entryPos, entry)) {
-            ESP_LOGW("ShotHistoryPlugin", "Failed to read entry at position %u", i);
-            break;
-        }
+    File indexFile = fs->open("/h/index.bin", "r");
+    if (!indexFile) {
+        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for loading");
+        return false;
+    }
 
-        if (entry.id == shotId) {
-            return entryPos;
-        }
+    ShotIndexHeader header{};
+    if (!readIndexHeader(indexFile, header)) {
+        indexFile.close();
+        return false;
     }
-    return -1;
-}
 
-bool ShotHistoryPlugin::readEntryAtPosition(File &indexFile, size_t position, ShotIndexEntry &entry) {
-    indexFile.seek(position, SeekSet);
-    if (indexFile.read(reinterpret_cast<uint8_t *>(&entry), sizeof(entry)) != sizeof(entry)) {
-        ESP_LOGE("ShotHistoryPlugin", "Failed to read entry at position %zu", position);
+    size_t bytes = header.entryCount * sizeof(ShotIndexEntry);
+    if (header.version != SHOT_INDEX_VERSION || header.entrySize != SHOT_INDEX_ENTRY_SIZE ||
+        indexFile.size() != sizeof(ShotIndexHeader) + bytes) {
+        ESP_LOGE("ShotHistoryPlugin", "Index layout mismatch: version %u, entry size %u, %u entries in %u bytes", header.version,
+                 header.entrySize, header.entryCount, indexFile.size());
+        indexFile.close();
+        return false;
+    }
+
+    size_t read = indexFile.read(reinterpret_cast<uint8_t *>(indexEntries.prepare(header.entryCount)), bytes);
+    indexFile.close();
+    if (read != bytes) {
+        ESP_LOGE("ShotHistoryPlugin", "Failed to read index entries");
+        indexEntries.clear();
         return false;
     }
+    indexHeader = header;
+    indexLoaded = true;
+
+    // Older firmware could append the same id twice; keep the first live slot and retire the rest
+    std::vector<uint32_t> duplicates = indexEntries.reindex();
+    for (uint32_t slot : duplicates) {
+        writeIndexSlot(slot);
+    }
+    if (!duplicates.empty()) {
+        ESP_LOGW("ShotHistoryPlugin", "Retired %u duplicate index entries", duplicates.size());
+    }
+
+    ESP_LOGI("ShotHistoryPlugin", "Loaded %u index entries", indexHeader.entryCount);
     return true;
 }
 
+bool ShotHistoryPlugin::writeIndexSlot(uint32_t slot, bool includeHeader) {
+    if (!journalIndexWrite(slot)) {
+        return false;
+    }
+    File indexFile = fs->open("/h/index.bin", "r+");
+    if (!indexFile) {
+        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for update");
+        return false;
+    }
+    size_t position = SHOT_INDEX_HEADER_SIZE + slot * SHOT_INDEX_ENTRY_SIZE;
+    bool ok = writeEntryAtPosition(indexFile, position, indexEntries[slot]);
+    if (ok && includeHeader) {
+        indexFile.seek(0, SeekSet);
+        ok = indexFile.write(reinterpret_cast<const uint8_t *>(&indexHeader), sizeof(indexHeader)) == sizeof(indexHeader);
+    }
+    indexFile.close();
+    if (ok && ++journalRecords >= SHOT_INDEX_JOURNAL_MAX_RECORDS) {
+        dropIndexJournal(); // everything journaled so far is on disk
+    }
+    return ok;
+}
+
+bool ShotHistoryPlugin::journalIndexWrite(uint32_t slot) {
+    ShotIndexJournalRecord record = shot_index::makeJournalRecord(slot, indexHeader, indexEntries[slot]);
+    File journal = fs->open("/h/index.jnl", FILE_APPEND);
+    if (!journal) {
+        ESP_LOGE("ShotHistoryPlugin", "Failed to open index journal");
+        return false;
+    }
+    bool ok = journal.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record)) == sizeof(record);
+    journal.close();
+    return ok;
+}
+
+uint32_t ShotHistoryPlugin::replayIndexJournal() {
+    if (!fs->exists("/h/index.jnl")) {
+        return 0;
+    }
+    uint32_t replayed = 0;
+    File journal = fs->open("/h/index.jnl", "r");
+    File indexFile = fs->open("/h/index.bin", "r+");
+    if (journal && indexFile) {
+        replayed = shot_index::replayJournal(journal, indexFile);
+    }
+    if (journal) {
+        journal.close();
+    }
+    if (indexFile) {
+        indexFile.close();
+    }
+    dropIndexJournal();
+    indexLoaded = false;
+    return replayed;
+}
+
+void ShotHistoryPlugin::dropIndexJournal() {
+    if (fs->exists("/h/index.jnl")) {
+        fs->remove("/h/index.jnl");
+    }
+    journalRecords = 0;
+}
+
 bool ShotHistoryPlugin::writeEntryAtPosition(File &indexFile, size_t position, const ShotIndexEntry &entry) {
     indexFile.seek(position, SeekSet);
     if (indexFile.write(reinterpret_cast<const uint8_t *>(&entry), sizeof(entry)) != sizeof(entry)) {
@@ -817,7 +1472,7 @@ bool ShotHistoryPlugin::writeEntryAtPosition(File &indexFile, size_t position, c
     return true;
 }
 
-void ShotHistoryPlugin::createEarlyIndexEntry() {
+bool ShotHistoryPlugin::createEarlyIndexEntry() {
     Profile profile = controller->getProfileManager()->getSelectedProfile();
 
     ShotIndexEntry indexEntry{};
@@ -832,46 +1487,42 @@ void ShotHistoryPlugin::createEarlyIndexEntry() {
     strncpy(indexEntry.profileName, profile.label.c_str(), sizeof(indexEntry.profileName) - 1);
     indexEntry.profileName[sizeof(indexEntry.profileName) - 1] = '\0';
 
-    appendToIndex(indexEntry);
-    ESP_LOGD("ShotHistoryPlugin", "Created early index entry for shot %u", indexEntry.id);
+    int8_t buffer = acquireBuffer(0);
+    if (buffer < 0) {
+        ESP_LOGW("ShotHistoryPlugin", "No writer buffer for early index entry of shot %u", indexEntry.id);
+        return false;
+    }
+    memcpy(writeBuffers[buffer].data, &indexEntry, sizeof(indexEntry));
+    writeBuffers[buffer].length = sizeof(indexEntry);
+    submitCommand(ShotLogCommandType::INDEX, buffer);
+    ESP_LOGD("ShotHistoryPlugin", "Queued early index entry for shot %u", indexEntry.id);
+    return true;
 }
 
-void ShotHistoryPlugin::updateIndexCompletion(uint32_t shotId, const ShotLogHeader &finalHeader) {
-    File indexFile = fs->open("/h/index.bin", "r+");
-    if (!indexFile) {
-        ESP_LOGE("ShotHistoryPlugin", "Failed to open index file for completion update");
+void ShotHistoryPlugin::updateIndexCompletion(uint32_t shotId, const ShotLogHeader &finalHeader, const ShotSummary &summary,
+                                              uint32_t logSize) {
+    std::lock_guard<std::recursive_mutex> lock(indexMutex);
+    if (!loadIndex()) {
         return;
     }
 
-    ShotIndexHeader header{};
-    if (!readIndexHeader(indexFile, header)) {
-        indexFile.close();
+    int slot = indexEntries.find(shotId);
+    if (slot < 0) {
+        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for completion update", shotId);
         return;
     }
 
-    int entryPos = findEntryPosition(indexFile, header, shotId);
-    if (entryPos >= 0) {
-        ShotIndexEntry entry{};
-        if (readEntryAtPosition(indexFile, entryPos, entry)) {
-            // Update with final shot data
-            entry.duration = finalHeader.durationMs;
-            entry.volume = finalHeader.finalWeight;
-            entry.flags |= SHOT_FLAG_COMPLETED; // Mark as completed
-
-            if (writeEntryAtPosition(indexFile, entryPos, entry)) {
-                ESP_LOGD("ShotHistoryPlugin", "Updated shot %u completion: duration=%u, volume=%u", shotId, entry.duration,
-                         entry.volume);
-                indexFile.close();
-                return;
-            } else {
-                ESP_LOGE("ShotHistoryPlugin", "Failed to write completion data for shot %u", shotId);
-            }
-        } else {
-            ESP_LOGE("ShotHistoryPlugin", "Failed to read entry for shot %u at position %d", shotId, entryPos);
-        }
+    // Update with final shot data
+    ShotIndexEntry &entry = indexEntries[slot];
+    entry.duration = finalHeader.durationMs;
+    entry.volume = finalHeader.finalWeight;
+    entry.summary = summary;
+    entry.logSize = logSize;
+    entry.flags |= SHOT_FLAG_COMPLETED | SHOT_FLAG_HAS_SUMMARY; // Mark as completed
+
+    if (writeIndexSlot(slot)) {
+        ESP_LOGD("ShotHistoryPlugin", "Updated shot %u completion: duration=%u, volume=%u", shotId, entry.duration, entry.volume);
     } else {
-        ESP_LOGW("ShotHistoryPlugin", "Shot %u not found in index for completion update", shotId);
+        ESP_LOGE("ShotHistoryPlugin", "Failed to write completion data for shot %u", shotId);
     }
-
-    indexFile.close();
 }
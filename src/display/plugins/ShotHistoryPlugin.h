@@ -4,14 +4,69 @@
 #include <ArduinoJson.h>
 #include <SPIFFS.h>
 #include <display/core/Plugin.h>
+#include <display/core/TelemetryBuffer.h>
 #include <display/core/utils.h>
+#include <display/models/shot_index.h>
+#include <display/models/shot_log_codec.h>
+#include <display/models/shot_log_downsampler.h>
 #include <display/models/shot_log_format.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 constexpr size_t SHOT_HISTORY_INTERVAL = 100;
-constexpr size_t MAX_HISTORY_ENTRIES = 100;                 // Increased from 10
+constexpr uint32_t HISTORY_LIST_DEFAULT_LIMIT = 20; // entries per req:history:list page
+constexpr uint32_t HISTORY_LIST_MAX_LIMIT = 50;
+constexpr uint16_t HISTORY_CURVE_MIN_POINTS = 3; // downsampled curves keep at least first, one, last
+constexpr uint16_t HISTORY_CURVE_MAX_POINTS = 1000;
 constexpr unsigned long EXTENDED_RECORDING_DURATION = 3000; // 3 seconds
 constexpr unsigned long WEIGHT_STABILIZATION_TIME = 1000;   // 1 second
 constexpr float WEIGHT_STABILIZATION_THRESHOLD = 0.1f;      // 0.1g threshold
+constexpr float FIRST_DRIP_PUCK_FLOW = 0.3f;                // ml/s of puck flow that counts as first drip
+constexpr uint16_t SHOT_LOG_SENSOR_TICK_MS = 10;            // tick length when recording every sensor notification
+constexpr size_t SHOT_LOG_BUFFER_COUNT = 3;
+constexpr size_t SHOT_LOG_BUFFER_SIZE = 4096;
+constexpr size_t SHOT_LOG_WRITER_QUEUE_LENGTH = SHOT_LOG_BUFFER_COUNT + 2;
+constexpr uint32_t SHOT_INDEX_JOURNAL_MAX_RECORDS = 32;       // journal is dropped once this many writes have completed
+constexpr unsigned long HISTORY_RETENTION_POLL = 1000;        // writer idle wake-up to check retention
+constexpr unsigned long HISTORY_RETENTION_DELAY = 5000;       // settle time after a shot before pruning
+constexpr unsigned long HISTORY_RETENTION_INTERVAL = 3600000; // periodic pass so age limits apply without new shots
+constexpr uint32_t HISTORY_RETENTION_BATCH = 10;              // shots removed per pass, the rest waits for the next
+constexpr uint8_t HISTORY_RETENTION_MAX_FILL = 90;            // percent of the filesystem history may push usage to
+
+static_assert(SHOT_LOG_BUFFER_SIZE >= SHOT_LOG_BLOCK_HEADER_SIZE + SHOT_LOG_MAX_BLOCK_PAYLOAD, "encoded block must fit a buffer");
+static_assert(SHOT_LOG_BUFFER_SIZE >= sizeof(ShotLogHeader) + sizeof(ShotSummary), "final header must fit a buffer");
+
+enum class ShotLogCommandType { OPEN, WRITE, CLOSE, INDEX };
+
+// Work item for the writer task. The referenced buffer goes back to the free queue once processed.
+struct ShotLogCommand {
+    ShotLogCommandType type;
+    int8_t buffer;
+    bool indexed; // CLOSE: an early index entry exists for this shot, buffer holds header and summary
+    uint32_t shotId;
+};
+
+struct ShotLogBuffer {
+    uint8_t data[SHOT_LOG_BUFFER_SIZE];
+    size_t length = 0;
+};
+
+struct ShotLogWriterStats {
+    uint32_t droppedSamples = 0;    // samples lost because no buffer was free
+    uint32_t lateSamples = 0;       // sampler missed its wake-up deadline
+    uint32_t maxWriteLatencyUs = 0; // slowest single storage operation
+    uint32_t failedLogs = 0;        // shots whose log could not be created, they are not indexed
+};
+
+// Final header and summary of a shot that has stopped, kept until a writer buffer is free to carry them
+struct ShotLogClose {
+    ShotLogHeader header;
+    ShotSummary summary;
+    uint32_t shotId;
+    bool indexed;
+};
 
 class ShotHistoryPlugin : public Plugin {
   public:
@@ -21,71 +76,131 @@ class ShotHistoryPlugin : public Plugin {
     void loop() override {};
 
     void record();
+    const ShotLogWriterStats &getWriterStats() const { return writerStats; }
 
     void handleRequest(JsonDocument &request, JsonDocument &response);
+    // Cursor producing the downsampled curve of a shot piecewise, nullptr if the shot does not exist
+    std::shared_ptr<ShotLogDownsampler> openDownsampled(uint32_t shotId, uint16_t points, const String &fields);
 
     // Index management methods
     void appendToIndex(const ShotIndexEntry &entry);
-    void updateIndexMetadata(uint32_t shotId, uint8_t rating, uint16_t volume);
+    void updateIndexMetadata(uint32_t shotId, uint8_t rating, uint16_t volume, uint16_t notesSize);
     void markIndexDeleted(uint32_t shotId);
+    void recoverIndex();
     void rebuildIndex();
     bool ensureIndexExists();
 
   private:
     // Index helper functions
     bool readIndexHeader(File &indexFile, ShotIndexHeader &header);
-    int findEntryPosition(File &indexFile, const ShotIndexHeader &header, uint32_t shotId);
-    bool readEntryAtPosition(File &indexFile, size_t position, ShotIndexEntry &entry);
+    bool loadIndex();
+    std::vector<uint32_t> listShotIds();
+    bool buildIndexEntry(uint32_t shotId, ShotIndexEntry &entry);
+    bool repairShotLog(const String &path, ShotLogHeader &shotHeader);
+    void repairIncompleteEntries();
+    bool journalIndexWrite(uint32_t slot);
+    uint32_t replayIndexJournal();
+    void dropIndexJournal();
+    bool writeIndexSlot(uint32_t slot, bool includeHeader = false);
     bool writeEntryAtPosition(File &indexFile, size_t position, const ShotIndexEntry &entry);
-    void createEarlyIndexEntry();
-    void updateIndexCompletion(uint32_t shotId, const ShotLogHeader &finalHeader);
-    void saveNotes(const String &id, const JsonDocument &notes);
+    bool createEarlyIndexEntry();
+    void updateIndexCompletion(uint32_t shotId, const ShotLogHeader &finalHeader, const ShotSummary &summary, uint32_t logSize);
+    void listHistory(JsonDocument &request, JsonDocument &response);
+    size_t saveNotes(const String &id, const JsonDocument &notes);
     void loadNotes(const String &id, JsonDocument &notes);
     void startRecording();
 
     uint16_t getSystemInfo(); // Helper to pack system state bits
+    uint16_t sampleTick(unsigned long sampleTime);
+    // Logs one sample, dt and the Bluetooth flow run on now, the tick on sampleTime
+    void recordSample(const TelemetrySample &telemetry, unsigned long now, unsigned long sampleTime);
 
     unsigned long getTime();
 
     void endRecording();
     void endExtendedRecording();
-    void cleanupHistory();
+    void applyRetention();
+    bool pruneHistory();
+    void finalizeShot(uint32_t shotId, const ShotLogHeader &finalHeader, const ShotSummary &summary, uint32_t logSize,
+                      bool indexed);
+    void updateSummary(const ShotLogSample &sample, float dt, bool preinfusion);
+    ShotSummary buildSummary() const;
 
-    void recordPhaseTransition(uint8_t phaseNumber, uint16_t sampleIndex); // Helper for phase transitions
+    void recordPhaseTransition(uint8_t phaseNumber, uint16_t sampleTick); // Helper for phase transitions
 
     Controller *controller = nullptr;
     PluginManager *pluginManager = nullptr;
     FS *fs = &SPIFFS;
     String currentId = "";
-    bool isFileOpen = false;
+    std::atomic<bool> isFileOpen{false}; // sampler, writer task and retention all check it
     File currentFile;
     ShotLogHeader header{};
     uint32_t sampleCount = 0;
-    uint8_t ioBuffer[4096];
-    size_t ioBufferPos = 0; // bytes used
-
-    bool recording = false;
-    bool extendedRecording = false;
+    uint16_t sampleInterval = SHOT_LOG_SAMPLE_INTERVAL_MS; // tick length of the current shot in ms
+    bool sampleOnSensorUpdate = false;
+    unsigned long lastSampleTime = 0;
+    uint32_t lastTick = 0;
+    uint32_t nextTelemetry = 0; // next telemetry index to log when sampling every sensor update
+    ShotLogEncoder encoder;
+    uint32_t shotDroppedSamples = 0;
+
+    // Storage is handled by the writer task; the sampler only fills buffers and queues them
+    ShotLogBuffer writeBuffers[SHOT_LOG_BUFFER_COUNT];
+    int8_t activeBuffer = -1; // buffer currently being filled by the sampler
+    QueueHandle_t freeBuffers = nullptr;
+    QueueHandle_t writerQueue = nullptr;
+    ShotLogWriterStats writerStats;
+    ShotLogClose pendingClose{};
+    std::atomic<bool> closePending{false}; // set by the sampler, the next shot opens only once it is posted
+    bool retentionPending = true; // prune soon, set at boot and after every shot
+    unsigned long lastRetentionRun = 0;
+    unsigned long lastShotFinalized = 0;
+
+    std::atomic<bool> recording{false}; // set by event handlers, read by the sampler and writer tasks
+    std::atomic<bool> extendedRecording{false};
     bool indexEntryCreated = false;     // Track if early index entry was created
     bool shotStartedVolumetric = false; // Track initial volumetric mode
     unsigned long shotStart = 0;
     unsigned long extendedRecordingStart = 0;
     unsigned long lastWeightChangeTime = 0;
-    float currentTemperature = 0.0f;
     float currentBluetoothWeight = 0.0f;
     float lastStableWeight = 0.0f;
     float lastBluetoothWeight = 0.0f;
     float currentBluetoothFlow = 0.0f;
     float currentEstimatedWeight = 0.0f;
-    float currentPuckResistance = 0.0f;
     String currentProfileName;
 
     // Phase transition tracking (v5+)
     uint8_t lastRecordedPhase = 0xFF; // Invalid initial value to detect first phase
 
-    xTaskHandle taskHandle;
+    // Running aggregates for the index summary, in sample units
+    uint32_t summarySamples = 0;
+    uint16_t summaryPeakPressure = 0;
+    int32_t summaryPressureSum = 0;
+    int32_t summaryFlowSum = 0;
+    int32_t summaryTempErrorSum = 0;
+    uint32_t summaryTempSamples = 0;
+    uint32_t summaryFirstDripMs = 0;
+    float summaryPreinfusionMs = 0.0f;
+    float summaryWaterPumped = 0.0f; // ml
+
+    // In-memory mirror of /h/index.bin. Slot n lives at SHOT_INDEX_HEADER_SIZE + n * SHOT_INDEX_ENTRY_SIZE.
+    ShotIndexHeader indexHeader{};
+    ShotIndexCache<PsramAllocator<ShotIndexEntry>> indexEntries;
+    bool indexLoaded = false;
+    uint32_t journalRecords = 0; // completed writes covered by /h/index.jnl
+    std::recursive_mutex indexMutex; // recording task and web requests both touch the index
+
+    xTaskHandle taskHandle = nullptr;
+    xTaskHandle writerTaskHandle = nullptr;
     void flushBuffer();
+    void writeEncodedBlock();
+    int8_t acquireBuffer(TickType_t wait);
+    void submitCommand(ShotLogCommandType type, int8_t buffer, bool indexed = false);
+    bool submitClose();
+    void processCommand(const ShotLogCommand &command);
     static void loopTask(void *arg);
+    static void writerTask(void *arg);
 };
 
 extern ShotHistoryPlugin ShotHistory;
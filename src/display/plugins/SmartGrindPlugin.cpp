@@ -7,8 +7,8 @@
 
 void SmartGrindPlugin::setup(Controller *controller, PluginManager *pluginManager) {
     this->controller = controller;
-    pluginManager->on("controller:grind:start", [this](Event const &event) { start(); });
-    pluginManager->on("controller:grind:end", [this](Event const &event) { stop(); });
+    pluginManager->on("controller:grind:start"_ev, [this](Event const &event) { start(); });
+    pluginManager->on("controller:grind:end"_ev, [this](Event const &event) { stop(); });
 }
 
 void SmartGrindPlugin::start() {
@@ -33,37 +33,33 @@ void WebUIPlugin::setup(Controller *_controller, PluginManager *_pluginManager)
         BUILD_GIT_VERSION, controller->getSystemInfo().version,
         RELEASE_URL + (controller->getSettings().getOTAChannel() == "latest" ? "latest" : "tag/nightly"),
         [this](uint8_t phase) {
-            pluginManager->trigger("ota:update:phase", "phase", phase);
+            pluginManager->trigger("ota:update:phase"_ev, "phase"_ev, phase);
             updateOTAProgress(phase, 0);
         },
         [this](uint8_t phase, int progress) {
-            pluginManager->trigger("ota:update:progress", "progress", progress);
+            pluginManager->trigger("ota:update:progress"_ev, "progress"_ev, progress);
             updateOTAProgress(phase, progress);
         },
         "display-firmware.bin", "display-filesystem.bin", "board-firmware.bin");
-    pluginManager->on("controller:wifi:connect", [this](Event const &event) {
-        apMode = event.getInt("AP");
+    pluginManager->on("controller:wifi:connect"_ev, [this](Event const &event) {
+        apMode = event.getInt("AP"_ev);
         start();
     });
-    pluginManager->on("controller:wifi:disconnect", [this](Event const &) { stop(); });
-    pluginManager->on("controller:ready", [this](Event const &) {
+    pluginManager->on("controller:wifi:disconnect"_ev, [this](Event const &) { stop(); });
+    pluginManager->on("controller:ready"_ev, [this](Event const &) {
         ota->setControllerVersion(controller->getSystemInfo().version);
         ota->init(controller->getClientController()->getClient());
     });
-    pluginManager->on("controller:autotune:result", [this](Event const &event) { sendAutotuneResult(); });
-
-    // Subscribe to Bluetooth scale weight updates
-    pluginManager->on("controller:volumetric-measurement:bluetooth:change",
-                      [this](Event const &event) { this->currentBluetoothWeight = event.getFloat("value"); });
+    pluginManager->on("controller:autotune:result"_ev, [this](Event const &event) { sendAutotuneResult(); });
 
     setupServer();
 }
 
 void WebUIPlugin::loop() {
     if (updating) {
-        pluginManager->trigger("ota:update:start");
+        pluginManager->trigger("ota:update:start"_ev);
         ota->update(updateComponent != "display", updateComponent != "controller");
-        pluginManager->trigger("ota:update:end");
+        pluginManager->trigger("ota:update:end"_ev);
         updating = false;
     }
     if (!serverRunning) {
@@ -72,19 +68,21 @@ void WebUIPlugin::loop() {
     const long now = millis();
     if ((lastUpdateCheck == 0 || now > lastUpdateCheck + UPDATE_CHECK_INTERVAL)) {
         ota->checkForUpdates();
-        pluginManager->trigger("ota:update:status", "value", ota->isUpdateAvailable());
+        pluginManager->trigger("ota:update:status"_ev, "value"_ev, ota->isUpdateAvailable());
         lastUpdateCheck = now;
         updateOTAStatus(ota->getCurrentVersion());
     }
     if (now > lastStatus + STATUS_PERIOD) {
         lastStatus = now;
+        TelemetrySample telemetry{};
+        controller->getTelemetry().latest(telemetry);
         JsonDocument doc;
         doc["tp"] = "evt:status";
-        doc["ct"] = controller->getCurrentTemp();
+        doc["ct"] = telemetry.temperature;
         doc["tt"] = controller->getTargetTemp();
-        doc["pr"] = controller->getCurrentPressure();
-        doc["fl"] = controller->getCurrentPumpFlow();
-        doc["pt"] = controller->getTargetPressure();
+        doc["pr"] = telemetry.pressure;
+        doc["fl"] = telemetry.pumpFlow;
+        doc["pt"] = telemetry.targetPressure;
         doc["m"] = controller->getMode();
         doc["p"] = controller->getProfileManager()->getSelectedProfile().label;
         doc["puid"] = controller->getProfileManager()->getSelectedProfile().id;
@@ -101,10 +99,11 @@ void WebUIPlugin::loop() {
         doc["gact"] = controller->isGrindActive() ? 1 : 0;
 
         bool bleConnected = BLEScales.isConnected();
+        float bluetoothWeight = bleConnected ? controller->getBluetoothWeight() : 0.0f;
         // Add Bluetooth scale weight information
-        doc["bw"] = bleConnected ? this->currentBluetoothWeight : 0; // current bluetooth weight
-        doc["cw"] = bleConnected ? this->currentBluetoothWeight : 0; // Use 'currentWeight' for forward compatbility
-        doc["bc"] = bleConnected;                                    // bluetooth scale connected status
+        doc["bw"] = bluetoothWeight; // current bluetooth weight
+        doc["cw"] = bluetoothWeight; // Use 'currentWeight' for forward compatbility
+        doc["bc"] = bleConnected;    // bluetooth scale connected status
 
         Process *process = controller->getProcess();
         if (process == nullptr) {
@@ -116,15 +115,14 @@ void WebUIPlugin::loop() {
             if (process->getType() == MODE_BREW) {
                 auto *brew = static_cast<BrewProcess *>(process);
                 unsigned long ts = brew->isActive() && controller->isActive() ? millis() : brew->finished;
-                pObj["s"] = brew->currentPhase.phase == PhaseType::PHASE_TYPE_BREW ? "brew" : "infusion";
-                pObj["l"] = brew->isActive() ? brew->currentPhase.name.c_str() : "Finished";
+                pObj["s"] = brew->currentPhase().phase == PhaseType::PHASE_TYPE_BREW ? "brew" : "infusion";
+                pObj["l"] = brew->isActive() ? brew->currentPhase().name : "Finished";
                 pObj["e"] = ts - brew->processStarted;
-                const bool isVolumetric = brew->target == ProcessTarget::VOLUMETRIC && brew->currentPhase.hasVolumetricTarget() &&
+                const bool isVolumetric = brew->target == ProcessTarget::VOLUMETRIC && brew->currentPhase().volumetric &&
                                           controller->isVolumetricAvailable();
                 pObj["tt"] = isVolumetric ? "volumetric" : "time";
                 if (isVolumetric) {
-                    Target t = brew->currentPhase.getVolumetricTarget();
-                    pObj["pt"] = t.value;
+                    pObj["pt"] = brew->currentPhase().volumetricTarget;
                     pObj["pp"] = brew->currentVolume;
                 } else {
                     pObj["pt"] = brew->getPhaseDuration();
@@ -194,6 +192,9 @@ void WebUIPlugin::setupServer() {
     if (controller->isSDCard()) {
         fs = &SD_MMC;
     }
+    // Downsampled curves share the prefix with the raw files, so register them first and only claim requests with ?points=
+    server.on("/api/history/*", HTTP_GET, [this](AsyncWebServerRequest *request) { handleHistoryCurve(request); })
+        .setFilter([](AsyncWebServerRequest *request) { return request->hasParam("points"); });
     server.serveStatic("/api/history/", *fs, "/h/").setCacheControl("no-store");
     server.on("/api/history/index.bin", HTTP_GET, [this, fs](AsyncWebServerRequest *request) {
         // Serve the binary index file directly
@@ -204,6 +205,15 @@ void WebUIPlugin::setupServer() {
         }
     });
     server.on("/api/core-dump", HTTP_GET, [this](AsyncWebServerRequest *request) { handleCoreDumpDownload(request); });
+#ifdef GAGGIMATE_EVENT_STATS
+    server.on("/api/events/stats", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        JsonDocument doc;
+        writeEventStats(doc);
+        serializeJson(doc, *response);
+        request->send(response);
+    });
+#endif
     server.onNotFound([](AsyncWebServerRequest *request) { request->send(SPIFFS, "/w/index.html"); });
     server.serveStatic("/", SPIFFS, "/w").setDefaultFile("index.html").setCacheControl("max-age=0");
     ws.onEvent(
@@ -327,6 +337,10 @@ void WebUIPlugin::handleWebSocketData(AsyncWebSocket *server, AsyncWebSocketClie
                     client->text(buffer);
                 } else if (msgType == "req:flush:start") {
                     handleFlushStart(client->id(), doc);
+#ifdef GAGGIMATE_EVENT_STATS
+                } else if (msgType == "req:events:stats") {
+                    handleEventStats(client->id(), doc);
+#endif
                 }
             }
         }
@@ -512,6 +526,20 @@ void WebUIPlugin::handleSettings(AsyncWebServerRequest *request) const {
                 settings->setEmptyTankDistance(request->arg("emptyTankDistance").toInt());
             if (request->hasArg("fullTankDistance"))
                 settings->setFullTankDistance(request->arg("fullTankDistance").toInt());
+            if (request->hasArg("historySampleInterval"))
+                settings->setHistorySampleInterval(request->arg("historySampleInterval").toInt());
+            if (request->hasArg("historyRetentionCount"))
+                settings->setHistoryRetentionCount(request->arg("historyRetentionCount").toInt());
+            if (request->hasArg("historyRetentionSize"))
+                settings->setHistoryRetentionSize(request->arg("historyRetentionSize").toInt());
+            if (request->hasArg("historyRetentionDays"))
+                settings->setHistoryRetentionDays(request->arg("historyRetentionDays").toInt());
+            if (request->hasArg("historySdRetentionCount"))
+                settings->setHistorySdRetentionCount(request->arg("historySdRetentionCount").toInt());
+            if (request->hasArg("historySdRetentionSize"))
+                settings->setHistorySdRetentionSize(request->arg("historySdRetentionSize").toInt());
+            if (request->hasArg("historySdRetentionDays"))
+                settings->setHistorySdRetentionDays(request->arg("historySdRetentionDays").toInt());
             if (request->hasArg("altRelayFunction"))
                 settings->setAltRelayFunction(request->arg("altRelayFunction").toInt());
             settings->setAutoWakeupEnabled(request->hasArg("autowakeupEnabled"));
@@ -559,7 +587,7 @@ void WebUIPlugin::handleSettings(AsyncWebServerRequest *request) const {
             }
             settings->save(true);
         });
-        pluginManager->trigger("settings:changed");
+        pluginManager->trigger("settings:changed"_ev);
         controller->setTargetTemp(controller->getTargetTemp());
         controller->setPumpModelCoeffs();
     }
@@ -611,6 +639,13 @@ void WebUIPlugin::handleSettings(AsyncWebServerRequest *request) const {
     doc["emptyTankDistance"] = settings.getEmptyTankDistance();
     doc["fullTankDistance"] = settings.getFullTankDistance();
     doc["altRelayFunction"] = settings.getAltRelayFunction();
+    doc["historySampleInterval"] = settings.getHistorySampleInterval();
+    doc["historyRetentionCount"] = settings.getHistoryRetentionCount();
+    doc["historyRetentionSize"] = settings.getHistoryRetentionSize();
+    doc["historyRetentionDays"] = settings.getHistoryRetentionDays();
+    doc["historySdRetentionCount"] = settings.getHistorySdRetentionCount();
+    doc["historySdRetentionSize"] = settings.getHistorySdRetentionSize();
+    doc["historySdRetentionDays"] = settings.getHistorySdRetentionDays();
     // Add auto-wakeup settings to response
     doc["autowakeupEnabled"] = settings.isAutoWakeupEnabled();
 
@@ -757,6 +792,98 @@ void WebUIPlugin::handleFlushStart(uint32_t clientId, JsonDocument &request) {
     ws.text(clientId, msg);
 }
 
+#ifdef GAGGIMATE_EVENT_STATS
+void WebUIPlugin::handleEventStats(uint32_t clientId, JsonDocument &request) {
+    JsonDocument response;
+    response["tp"] = "res:events:stats";
+    response["rid"] = request["rid"];
+    writeEventStats(response);
+
+    String msg;
+    serializeJson(response, msg);
+    ws.text(clientId, msg);
+}
+
+void WebUIPlugin::writeEventStats(JsonDocument &doc) const {
+    static const char *const deliveryNames[] = {"sync", "high", "normal", "low"};
+    JsonArray events = doc["events"].to<JsonArray>();
+    pluginManager->forEachListeners([&events](const EventListeners &entry) {
+        JsonObject event = events.add<JsonObject>();
+        event["id"] = entry.name;
+        event["triggers"] = entry.triggers;
+        event["listeners"] = entry.callbacks.size();
+        uint64_t totalUs = 0;
+        uint32_t maxUs = 0;
+        int slowest = -1;
+        for (size_t i = 0; i < entry.callbacks.size(); i++) {
+            const EventListenerStats &stats = entry.callbacks[i]->stats;
+            totalUs += stats.totalUs;
+            if (slowest < 0 || stats.maxUs > maxUs) {
+                maxUs = stats.maxUs;
+                slowest = static_cast<int>(i);
+            }
+        }
+        event["totalUs"] = totalUs;
+        event["maxUs"] = maxUs;
+        if (slowest >= 0) {
+            // Listeners are anonymous, so identify the slowest one by registration order and delivery mode
+            const EventListener &listener = *entry.callbacks[slowest];
+            JsonObject slowestListener = event["slowest"].to<JsonObject>();
+            slowestListener["index"] = slowest;
+            slowestListener["delivery"] = deliveryNames[static_cast<size_t>(listener.delivery)];
+            slowestListener["calls"] = listener.stats.calls;
+            slowestListener["totalUs"] = listener.stats.totalUs;
+            slowestListener["maxUs"] = listener.stats.maxUs;
+        }
+    });
+    JsonArray queues = doc["queues"].to<JsonArray>();
+    for (auto delivery : {EventDelivery::ASYNC_HIGH, EventDelivery::ASYNC, EventDelivery::ASYNC_LOW}) {
+        const EventQueueStats &stats = pluginManager->getQueueStats(delivery);
+        JsonObject queue = queues.add<JsonObject>();
+        queue["priority"] = deliveryNames[static_cast<size_t>(delivery)];
+        queue["delivered"] = stats.delivered;
+        queue["dropped"] = stats.dropped;
+        queue["maxDepth"] = stats.maxDepth;
+        queue["maxLatencyUs"] = stats.maxLatencyUs;
+        queue["avgLatencyUs"] = stats.delivered > 0 ? stats.totalLatencyUs / stats.delivered : 0;
+    }
+}
+#endif
+
+void WebUIPlugin::handleHistoryCurve(AsyncWebServerRequest *request) {
+    // /api/history/<id>[.slog]?points=N[&fields=cp,fl,v]
+    String id = request->url().substring(strlen("/api/history/"));
+    if (id.endsWith(".slog")) {
+        id = id.substring(0, id.length() - 5);
+    }
+    bool numeric = !id.isEmpty();
+    for (size_t i = 0; i < id.length(); i++) {
+        numeric = numeric && isDigit(id[i]);
+    }
+    if (!numeric) {
+        request->send(400, "text/plain", "Invalid shot id");
+        return;
+    }
+    long points = request->getParam("points")->value().toInt();
+    if (points <= 0) {
+        request->send(400, "text/plain", "Invalid points");
+        return;
+    }
+    String fields = request->hasParam("fields") ? request->getParam("fields")->value() : "";
+
+    std::shared_ptr<ShotLogDownsampler> curve =
+        ShotHistory.openDownsampled(id.toInt(), std::min<long>(points, UINT16_MAX), fields);
+    if (!curve) {
+        request->send(404, "text/plain", "Shot not found");
+        return;
+    }
+    // Produced while the response is sent, a few points per TCP window, instead of building the body up front
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/json", [curve](uint8_t *buffer, size_t maxLen, size_t) { return curve->read(buffer, maxLen); });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
 void WebUIPlugin::handleCoreDumpDownload(AsyncWebServerRequest *request) {
     // Check if core dump is available
     size_t coreAddr, coreSize;
@@ -39,6 +39,10 @@ class WebUIPlugin : public Plugin {
     void handleAutotuneStart(uint32_t clientId, JsonDocument &request);
     void handleProfileRequest(uint32_t clientId, JsonDocument &request);
     void handleFlushStart(uint32_t clientId, JsonDocument &request);
+#ifdef GAGGIMATE_EVENT_STATS
+    void handleEventStats(uint32_t clientId, JsonDocument &request);
+    void writeEventStats(JsonDocument &doc) const;
+#endif
 
     // HTTP handlers
     void handleSettings(AsyncWebServerRequest *request) const;
@@ -46,6 +50,7 @@ class WebUIPlugin : public Plugin {
     void handleBLEScaleScan(AsyncWebServerRequest *request);
     void handleBLEScaleConnect(AsyncWebServerRequest *request);
     void handleBLEScaleInfo(AsyncWebServerRequest *request);
+    void handleHistoryCurve(AsyncWebServerRequest *request);
     void updateOTAStatus(const String &version);
     void updateOTAProgress(uint8_t phase, int progress);
     void sendAutotuneResult();
@@ -69,7 +74,6 @@ class WebUIPlugin : public Plugin {
     bool apMode = false;
     bool serverRunning = false;
     String updateComponent = "";
-    float currentBluetoothWeight = 0.0f;
 };
 
 #endif // WEBUIPLUGIN_H
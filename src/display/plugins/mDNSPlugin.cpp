@@ -6,10 +6,10 @@
 
 void mDNSPlugin::setup(Controller *controller, PluginManager *pluginManager) {
     this->controller = controller;
-    pluginManager->on("controller:wifi:connect", [this](Event const &event) { start(event); });
+    pluginManager->on("controller:wifi:connect"_ev, [this](Event const &event) { start(event); });
 }
 void mDNSPlugin::start(Event const &event) const {
-    const int apMode = event.getInt("AP");
+    const int apMode = event.getInt("AP"_ev);
     if (apMode)
         return;
     if (!MDNS.begin(controller->getSettings().getMdnsName().c_str())) {
@@ -23,37 +23,31 @@ int16_t calculate_angle(int set_temp, int range, int offset) {
     return (percentage * ((double)range)) - range / 2 - offset;
 }
 
-void DefaultUI::updateTempHistory() {
-    if (currentTemp > 0) {
-        tempHistory[tempHistoryIndex] = currentTemp;
-        tempHistoryIndex += 1;
-    }
-
-    if (tempHistoryIndex > TEMP_HISTORY_LENGTH) {
-        tempHistoryIndex = 0;
-        isTempHistoryInitialized = true;
-    }
-
-    if (tempHistoryIndex % 4 == 0) {
-        heatingFlash = !heatingFlash;
-        rerender = true;
-    }
-}
-
 void DefaultUI::updateTempStableFlag() {
-    if (isTempHistoryInitialized) {
+    // Judge stability on the controller's telemetry once it covers the whole window
+    const TelemetryBuffer &telemetry = controller->getTelemetry();
+    const unsigned long now = millis();
+    TelemetrySample oldest{};
+    if (telemetry.read(telemetry.oldest(), oldest) && now - oldest.timestamp >= TEMP_STABILITY_WINDOW) {
         float totalError = 0.0f;
         float maxError = 0.0f;
-        for (uint16_t i = 0; i < TEMP_HISTORY_LENGTH; i++) {
-            float error = abs(tempHistory[i] - targetTemp);
+        size_t samples = 0;
+        telemetry.forEach(now - TEMP_STABILITY_WINDOW, now, [&](const TelemetrySample &sample) {
+            if (sample.temperature <= 0.0f) {
+                return;
+            }
+            float error = abs(static_cast<int>(sample.temperature) - targetTemp);
             totalError += error;
             maxError = error > maxError ? error : maxError;
-        }
+            samples++;
+        });
 
-        const float avgError = totalError / TEMP_HISTORY_LENGTH;
-        const float errorMargin = max(2.0f, static_cast<float>(targetTemp) * 0.02f);
+        if (samples > 0) {
+            const float avgError = totalError / samples;
+            const float errorMargin = max(2.0f, static_cast<float>(targetTemp) * 0.02f);
 
-        isTemperatureStable = avgError < errorMargin && maxError <= errorMargin;
+            isTemperatureStable = avgError < errorMargin && maxError <= errorMargin;
+        }
     }
 
     // instantly reset stability if setpoint has changed
@@ -80,47 +74,48 @@ DefaultUI::DefaultUI(Controller *controller, Driver *driver, PluginManager *plug
 
 void DefaultUI::init() {
     auto triggerRender = [this](Event const &) { rerender = true; };
-    pluginManager->on("boiler:currentTemperature:change", [=](Event const &event) {
-        int newTemp = static_cast<int>(event.getFloat("value"));
+    pluginManager->on("controller:sensor:update"_ev, [=](Event const &event) {
+        SensorSnapshot snapshot{};
+        if (!event.getPayload(snapshot)) {
+            return;
+        }
+        int newTemp = static_cast<int>(snapshot.temperature);
         if (newTemp != currentTemp) {
             currentTemp = newTemp;
             rerender = true;
         }
-    });
-    pluginManager->on("boiler:pressure:change", [=](Event const &event) {
-        float newPressure = event.getFloat("value");
-        if (round(newPressure * 10.0f) != round(pressure * 10.0f)) {
-            pressure = newPressure;
+        if (round(snapshot.pressure * 10.0f) != round(pressure * 10.0f)) {
+            pressure = snapshot.pressure;
             rerender = true;
         }
     });
-    pluginManager->on("boiler:targetTemperature:change", [=](Event const &event) {
-        int newTemp = static_cast<int>(event.getFloat("value"));
+    pluginManager->on("boiler:targetTemperature:change"_ev, [=](Event const &event) {
+        int newTemp = static_cast<int>(event.getFloat("value"_ev));
         if (newTemp != targetTemp) {
             targetTemp = newTemp;
             rerender = true;
         }
     });
-    pluginManager->on("controller:targetVolume:change", [=](Event const &event) {
-        targetVolume = event.getFloat("value");
+    pluginManager->on("controller:targetVolume:change"_ev, [=](Event const &event) {
+        targetVolume = event.getFloat("value"_ev);
         rerender = true;
     });
-    pluginManager->on("controller:targetDuration:change", [=](Event const &event) {
-        targetDuration = event.getFloat("value");
+    pluginManager->on("controller:targetDuration:change"_ev, [=](Event const &event) {
+        targetDuration = event.getFloat("value"_ev);
         rerender = true;
     });
-    pluginManager->on("controller:grindDuration:change", [=](Event const &event) {
-        grindDuration = event.getInt("value");
+    pluginManager->on("controller:grindDuration:change"_ev, [=](Event const &event) {
+        grindDuration = event.getInt("value"_ev);
         rerender = true;
     });
-    pluginManager->on("controller:grindVolume:change", [=](Event const &event) {
-        grindVolume = event.getFloat("value");
+    pluginManager->on("controller:grindVolume:change"_ev, [=](Event const &event) {
+        grindVolume = event.getFloat("value"_ev);
         rerender = true;
     });
-    pluginManager->on("controller:process:end", triggerRender);
-    pluginManager->on("controller:process:start", triggerRender);
-    pluginManager->on("controller:mode:change", [this](Event const &event) {
-        mode = event.getInt("value");
+    pluginManager->on("controller:process:end"_ev, triggerRender);
+    pluginManager->on("controller:process:start"_ev, triggerRender);
+    pluginManager->on("controller:mode:change"_ev, [this](Event const &event) {
+        mode = event.getInt("value"_ev);
         switch (mode) {
         case MODE_STANDBY:
             changeScreen(&ui_StandbyScreen, &ui_StandbyScreen_screen_init);
@@ -141,14 +136,14 @@ void DefaultUI::init() {
             break;
         };
     });
-    pluginManager->on("controller:brew:start",
+    pluginManager->on("controller:brew:start"_ev,
                       [this](Event const &event) { changeScreen(&ui_StatusScreen, &ui_StatusScreen_screen_init); });
-    pluginManager->on("controller:brew:clear", [this](Event const &event) {
+    pluginManager->on("controller:brew:clear"_ev, [this](Event const &event) {
         if (lv_scr_act() == ui_StatusScreen) {
             changeScreen(&ui_BrewScreen, &ui_BrewScreen_screen_init);
         }
     });
-    pluginManager->on("controller:bluetooth:connect", [this](Event const &) {
+    pluginManager->on("controller:bluetooth:connect"_ev, [this](Event const &) {
         rerender = true;
         if (lv_scr_act() == ui_InitScreen) {
             Settings &settings = controller->getSettings();
@@ -157,42 +152,42 @@ void DefaultUI::init() {
         }
         pressureAvailable = controller->getSystemInfo().capabilities.pressure;
     });
-    pluginManager->on("controller:wifi:connect", [this](Event const &event) {
+    pluginManager->on("controller:wifi:connect"_ev, [this](Event const &event) {
         rerender = true;
-        apActive = event.getInt("AP");
+        apActive = event.getInt("AP"_ev);
     });
-    pluginManager->on("ota:update:start", [this](Event const &) {
+    pluginManager->on("ota:update:start"_ev, [this](Event const &) {
         updateActive = true;
         rerender = true;
         changeScreen(&ui_InitScreen, &ui_InitScreen_screen_init);
     });
-    pluginManager->on("ota:update:end", [this](Event const &) {
+    pluginManager->on("ota:update:end"_ev, [this](Event const &) {
         updateActive = false;
         rerender = true;
         changeScreen(&ui_InitScreen, &ui_InitScreen_screen_init);
     });
-    pluginManager->on("ota:update:status", [this](Event const &event) {
+    pluginManager->on("ota:update:status"_ev, [this](Event const &event) {
         rerender = true;
-        updateAvailable = event.getInt("value");
+        updateAvailable = event.getInt("value"_ev);
     });
-    pluginManager->on("controller:error", [this](Event const &) {
+    pluginManager->on("controller:error"_ev, [this](Event const &) {
         rerender = true;
         changeScreen(&ui_InitScreen, &ui_InitScreen_screen_init);
     });
-    pluginManager->on("controller:autotune:start",
+    pluginManager->on("controller:autotune:start"_ev,
                       [this](Event const &) { changeScreen(&ui_InitScreen, &ui_InitScreen_screen_init); });
-    pluginManager->on("controller:autotune:result",
+    pluginManager->on("controller:autotune:result"_ev,
                       [this](Event const &) { changeScreen(&ui_StandbyScreen, &ui_StandbyScreen_screen_init); });
 
-    pluginManager->on("profiles:profile:select", [this](Event const &event) {
+    pluginManager->on("profiles:profile:select"_ev, [this](Event const &event) {
         profileManager->loadSelectedProfile(selectedProfile);
-        selectedProfileId = event.getString("id");
+        selectedProfileId = event.getString("id"_ev);
         targetDuration = profileManager->getSelectedProfile().getTotalDuration();
         targetVolume = profileManager->getSelectedProfile().getTotalVolume();
         rerender = true;
     });
-    pluginManager->on("controller:volumetric-measurement:bluetooth:change", [=](Event const &event) {
-        double newWeight = event.getFloat("value");
+    pluginManager->on("controller:volumetric-measurement:bluetooth:change"_ev, [=](Event const &event) {
+        double newWeight = event.getFloat("value"_ev);
         if (round(newWeight * 10.0) != round(bluetoothWeight * 10.0)) {
             bluetoothWeight = newWeight;
             rerender = true;
@@ -210,9 +205,10 @@ void DefaultUI::loop() {
     const unsigned long now = millis();
     const unsigned long diff = now - lastRender;
 
-    if (now - lastTempLog > TEMP_HISTORY_INTERVAL) {
-        updateTempHistory();
-        lastTempLog = now;
+    if (now - lastHeatingFlash > HEATING_FLASH_INTERVAL) {
+        heatingFlash = !heatingFlash;
+        rerender = true;
+        lastHeatingFlash = now;
     }
 
     if ((controller->isActive() && diff > RERENDER_INTERVAL_ACTIVE) || diff > RERENDER_INTERVAL_IDLE) {
@@ -713,9 +709,9 @@ void DefaultUI::updateStatusScreen() const {
 
     // Validate the brewProcess object before accessing its members
     // Check if the object is in a reasonable state by validating key fields
-    if (brewProcess->profile.phases.empty() || brewProcess->phaseIndex >= brewProcess->profile.phases.size()) {
-        ESP_LOGE("DefaultUI", "brewProcess phaseIndex out of bounds: %u >= %zu", brewProcess->phaseIndex,
-                 brewProcess->profile.phases.size());
+    if (brewProcess->plan.phaseCount == 0 || brewProcess->phaseIndex >= brewProcess->plan.phaseCount) {
+        ESP_LOGE("DefaultUI", "brewProcess phaseIndex out of bounds: %u >= %u", brewProcess->phaseIndex,
+                 brewProcess->plan.phaseCount);
         return;
     }
 
@@ -725,7 +721,7 @@ void DefaultUI::updateStatusScreen() const {
         return;
     }
 
-    const auto phase = brewProcess->currentPhase;
+    const PhasePlan &phase = brewProcess->currentPhase();
 
     unsigned long now = millis();
     if (!process->isActive()) {
@@ -736,7 +732,7 @@ void DefaultUI::updateStatusScreen() const {
     }
 
     lv_label_set_text(ui_StatusScreen_stepLabel, phase.phase == PhaseType::PHASE_TYPE_BREW ? "BREW" : "INFUSION");
-    lv_label_set_text(ui_StatusScreen_phaseLabel, brewProcess && brewProcess->isActive() ? phase.name.c_str() : "Finished");
+    lv_label_set_text(ui_StatusScreen_phaseLabel, brewProcess && brewProcess->isActive() ? phase.name : "Finished");
 
     // Add bounds check for processStarted timestamp
     if (brewProcess && brewProcess->processStarted > 0 && now >= brewProcess->processStarted) {
@@ -749,11 +745,10 @@ void DefaultUI::updateStatusScreen() const {
         lv_label_set_text_fmt(ui_StatusScreen_currentDuration, "00:00");
     }
 
-    if (brewProcess && brewProcess->target == ProcessTarget::VOLUMETRIC && phase.hasVolumetricTarget()) {
-        Target target = phase.getVolumetricTarget();
+    if (brewProcess && brewProcess->target == ProcessTarget::VOLUMETRIC && phase.volumetric) {
         lv_bar_set_value(ui_StatusScreen_brewBar, brewProcess->currentVolume * 10.0, LV_ANIM_OFF);
-        lv_bar_set_range(ui_StatusScreen_brewBar, 0, target.value * 10.0 + 1.0);
-        lv_label_set_text_fmt(ui_StatusScreen_brewLabel, "%.1fg", target.value);
+        lv_bar_set_range(ui_StatusScreen_brewBar, 0, phase.volumetricTarget * 10.0 + 1.0);
+        lv_label_set_text_fmt(ui_StatusScreen_brewLabel, "%.1fg", phase.volumetricTarget);
     } else if (brewProcess) {
         // Add bounds check for currentPhaseStarted timestamp
         if (brewProcess->currentPhaseStarted > 0 && now >= brewProcess->currentPhaseStarted) {
@@ -14,8 +14,8 @@ class Controller;
 constexpr int RERENDER_INTERVAL_IDLE = 2500;
 constexpr int RERENDER_INTERVAL_ACTIVE = 100;
 
-constexpr int TEMP_HISTORY_INTERVAL = 250;
-constexpr int TEMP_HISTORY_LENGTH = 20 * 1000 / TEMP_HISTORY_INTERVAL;
+constexpr int HEATING_FLASH_INTERVAL = 1000;
+constexpr unsigned long TEMP_STABILITY_WINDOW = 20 * 1000; // telemetry span the stability check looks at
 
 int16_t calculate_angle(int set_temp, int range, int offset);
 
@@ -62,14 +62,10 @@ class DefaultUI {
     void adjustTempTarget(lv_obj_t *dials);
     void adjustTarget(lv_obj_t *obj, double percentage, double start, double range) const;
 
-    int tempHistory[TEMP_HISTORY_LENGTH] = {0};
-    int tempHistoryIndex = 0;
     int prevTargetTemp = 0;
-    bool isTempHistoryInitialized = false;
     int isTemperatureStable = false;
-    unsigned long lastTempLog = 0;
+    unsigned long lastHeatingFlash = 0;
 
-    void updateTempHistory();
     void updateTempStableFlag();
     void adjustHeatingIndicator(lv_obj_t *contentPanel);
 
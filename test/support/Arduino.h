@@ -0,0 +1,55 @@
+// Host stand-in for the parts of the Arduino core that the tested modules use
+#ifndef TEST_SUPPORT_ARDUINO_H
+#define TEST_SUPPORT_ARDUINO_H
+
+#include "esp_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector> // pulled in by the ESP32 core headers on the device
+
+class String {
+  public:
+    String() = default;
+    String(const char *value) : value(value != nullptr ? value : "") {}
+    String(const std::string &value) : value(value) {}
+    String(int value) : value(std::to_string(value)) {}
+    String(unsigned int value) : value(std::to_string(value)) {}
+    String(long value) : value(std::to_string(value)) {}
+    String(unsigned long value) : value(std::to_string(value)) {}
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    String &operator+=(const String &other) {
+        value += other.value;
+        return *this;
+    }
+    bool operator==(const String &other) const { return value == other.value; }
+    bool operator!=(const String &other) const { return value != other.value; }
+
+    friend String operator+(String left, const String &right) { return left += right; }
+
+  private:
+    std::string value;
+};
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+#endif // TEST_SUPPORT_ARDUINO_H
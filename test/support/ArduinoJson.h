@@ -0,0 +1,29 @@
+// Host stand-in for the ArduinoJson declarations models/profile.h compiles against. Every read yields the default
+// value and every write is dropped: host tests build their profiles in code and never parse or serialize JSON.
+#ifndef TEST_SUPPORT_ARDUINOJSON_H
+#define TEST_SUPPORT_ARDUINOJSON_H
+
+#include <Arduino.h>
+
+class JsonObject;
+
+class JsonVariant {
+  public:
+    template <typename T> T as() const { return T(); }
+    template <typename T> bool is() const { return false; }
+    template <typename T> T to() { return T(); }
+    template <typename T> T add() { return T(); }
+    template <typename T> JsonVariant &operator=(const T &) { return *this; }
+    template <typename T> T operator|(const T &fallback) const { return fallback; }
+    JsonVariant operator[](const char *) const { return JsonVariant(); }
+};
+
+class JsonObject : public JsonVariant {};
+
+class JsonArray : public JsonVariant {
+  public:
+    const JsonObject *begin() const { return nullptr; }
+    const JsonObject *end() const { return nullptr; }
+};
+
+#endif // TEST_SUPPORT_ARDUINOJSON_H
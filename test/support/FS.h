@@ -0,0 +1,67 @@
+#ifndef TEST_SUPPORT_FS_H
+#define TEST_SUPPORT_FS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+// Memory backed file. Every File constructed from the same contents is an independently positioned handle, copies of
+// a File share the position like copies of a handle on the device do.
+class File {
+  public:
+    File() = default;
+    explicit File(std::shared_ptr<std::vector<uint8_t>> contents) : handle(std::make_shared<Handle>(Handle{contents, 0})) {}
+
+    size_t read(uint8_t *buffer, size_t size) {
+        size_t available = handle->contents->size() > handle->offset ? handle->contents->size() - handle->offset : 0;
+        size_t count = std::min(size, available);
+        memcpy(buffer, handle->contents->data() + handle->offset, count);
+        handle->offset += count;
+        return count;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) {
+        std::vector<uint8_t> &contents = *handle->contents;
+        if (contents.size() < handle->offset + size) {
+            contents.resize(handle->offset + size);
+        }
+        memcpy(contents.data() + handle->offset, buffer, size);
+        handle->offset += size;
+        return size;
+    }
+
+    // Like LittleFS, seeking past the end is allowed and the next write fills the gap with zeros
+    bool seek(uint32_t position, SeekMode mode = SeekSet) {
+        size_t base = mode == SeekSet ? 0 : mode == SeekCur ? handle->offset : handle->contents->size();
+        handle->offset = base + position;
+        return true;
+    }
+
+    size_t position() const { return handle->offset; }
+    size_t size() const { return handle->contents->size(); }
+    void close() { handle.reset(); }
+    explicit operator bool() const { return handle != nullptr; }
+
+  private:
+    struct Handle {
+        std::shared_ptr<std::vector<uint8_t>> contents;
+        size_t offset;
+    };
+    std::shared_ptr<Handle> handle;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif // TEST_SUPPORT_FS_H
@@ -0,0 +1,13 @@
+#ifndef TEST_SUPPORT_ESP_LOG_H
+#define TEST_SUPPORT_ESP_LOG_H
+
+#include <cstdio>
+
+// Errors and warnings show up in the test output, everything else is dropped
+#define ESP_LOGE(tag, format, ...) printf("E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) printf("W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
+
+#endif // TEST_SUPPORT_ESP_LOG_H
@@ -0,0 +1,33 @@
+// Assertions shared by the tests of the fixed point wire formats
+#ifndef TEST_SUPPORT_FIXED_POINT_ASSERTS_H
+#define TEST_SUPPORT_FIXED_POINT_ASSERTS_H
+
+#include <ControlFrame.h>
+#include <SensorFrame.h>
+
+#include <cmath>
+#include <unity.h>
+
+// Random frames and noise buffers fed through each decoder
+constexpr int FUZZ_ROUNDS = 200000;
+
+// Half a step of a channel, plus the float rounding of the scaled value
+inline float tolerance(float step, float value) { return step / 2.0f + std::fabs(value) * 1e-6f; }
+
+// Values inside a channel's range come back within half a step
+inline void assertChannels(const SensorFrame &expected, const SensorFrame &actual) {
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.01f, expected.temperature), expected.temperature, actual.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.001f, expected.pressure), expected.pressure, actual.pressure);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.001f, expected.puckFlow), expected.puckFlow, actual.puckFlow);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.001f, expected.pumpFlow), expected.pumpFlow, actual.pumpFlow);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.01f, expected.puckResistance), expected.puckResistance, actual.puckResistance);
+}
+
+inline void assertSetpoints(const ControlFrame &expected, const ControlFrame &actual) {
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.01f, expected.boilerSetpoint), expected.boilerSetpoint, actual.boilerSetpoint);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.01f, expected.pumpSetpoint), expected.pumpSetpoint, actual.pumpSetpoint);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.001f, expected.pressure), expected.pressure, actual.pressure);
+    TEST_ASSERT_FLOAT_WITHIN(tolerance(0.001f, expected.flow), expected.flow, actual.flow);
+}
+
+#endif // TEST_SUPPORT_FIXED_POINT_ASSERTS_H
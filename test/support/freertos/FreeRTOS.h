@@ -0,0 +1,20 @@
+// Host stand-in for the FreeRTOS API used by the tested modules. Tasks are threads, queues are mutex guarded deques.
+#ifndef TEST_SUPPORT_FREERTOS_H
+#define TEST_SUPPORT_FREERTOS_H
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMINIMAL_STACK_SIZE 768
+
+#endif // TEST_SUPPORT_FREERTOS_H
@@ -0,0 +1,55 @@
+#ifndef TEST_SUPPORT_FREERTOS_TASK_H
+#define TEST_SUPPORT_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+};
+typedef HostTask *TaskHandle_t;
+typedef TaskHandle_t xTaskHandle;
+
+inline HostTask *&hostCurrentTask() {
+    thread_local HostTask *task = nullptr;
+    return task;
+}
+
+// Tasks run detached until the test process exits, like tasks that never delete themselves
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *, uint32_t, void *arg, UBaseType_t,
+                                          TaskHandle_t *handle, BaseType_t) {
+    auto *task = new HostTask();
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    std::thread([function, arg, task] {
+        hostCurrentTask() = task;
+        function(arg);
+    }).detach();
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    HostTask *task = hostCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->notified.wait_for(lock, std::chrono::milliseconds(ticks), [task] { return task->notifications > 0; });
+    uint32_t value = task->notifications;
+    task->notifications = clear == pdTRUE ? 0 : (value > 0 ? value - 1 : 0);
+    return value;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notifications++;
+    task->notified.notify_all();
+    return pdPASS;
+}
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+#endif // TEST_SUPPORT_FREERTOS_TASK_H
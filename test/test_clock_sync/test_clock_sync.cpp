@@ -0,0 +1,184 @@
+#include <ClockSync.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+constexpr int SIMULATED_LINKS = 500;
+
+// A controller clock running offset ms ahead of ours and drift faster, both read with millis() resolution
+class SimulatedLink {
+  public:
+    SimulatedLink(double offset, double drift, double start) : offset(offset), drift(drift), now(start) {}
+
+    static uint32_t clock(double ms) { return static_cast<uint32_t>(static_cast<uint64_t>(std::floor(ms))); }
+    uint32_t local() const { return clock(now); }
+    uint32_t remote(double at) const { return clock(std::fmod(offset + at * (1.0 + drift), 4294967296.0)); }
+    uint32_t remote() const { return remote(now); }
+
+    // One request and reply taking up and down ms on the air and the controller processing ms to answer
+    void exchange(ClockSync &sync, double up, double processing, double down) {
+        sync.addExchange(local(), remote(now + up), remote(now + up + processing), clock(now + up + processing + down));
+        now += up + processing + down;
+    }
+
+    void advance(double ms) { now += ms; }
+
+  private:
+    double offset;
+    double drift;
+    double now;
+};
+
+struct SimulationResult {
+    int errorP50;
+    int errorP95;
+    float driftP95;
+};
+
+// Links with random offsets and drifts of up to 50 ppm, both directions delayed by 4ms plus exponential jitter
+SimulationResult simulate(double jitterMeanMs, int exchanges, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::exponential_distribution<double> jitter(1.0 / jitterMeanMs);
+    std::vector<int> errors;
+    std::vector<float> drifts;
+    for (int run = 0; run < SIMULATED_LINKS; run++) {
+        const double drift = (static_cast<int>(random() % 101) - 50) * 1e-6;
+        SimulatedLink link(static_cast<double>(random()), drift, 1e6);
+        ClockSync sync;
+        for (int i = 0; i < exchanges; i++) {
+            link.advance(CLOCK_SYNC_INTERVAL_MS + random() % 50);
+            link.exchange(sync, 4.0 + jitter(random), random() % 3, 4.0 + jitter(random));
+        }
+        errors.push_back(std::abs(static_cast<int32_t>(sync.toLocal(link.remote()) - link.local())));
+        drifts.push_back(std::fabs(sync.getStats().driftPpm - static_cast<float>(drift * 1e6)));
+    }
+    std::sort(errors.begin(), errors.end());
+    std::sort(drifts.begin(), drifts.end());
+    return {errors[SIMULATED_LINKS / 2], errors[SIMULATED_LINKS * 95 / 100], drifts[SIMULATED_LINKS * 95 / 100]};
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_request_round_trip() {
+    ClockSyncRequest request{65535, 0xFFFFFFFE};
+    uint8_t buffer[CLOCK_SYNC_REQUEST_SIZE];
+    TEST_ASSERT_EQUAL(CLOCK_SYNC_REQUEST_SIZE, encodeClockSyncRequest(request, buffer, sizeof(buffer)));
+    ClockSyncRequest decoded{};
+    TEST_ASSERT_TRUE(decodeClockSyncRequest(buffer, sizeof(buffer), decoded));
+    TEST_ASSERT_EQUAL(request.sequence, decoded.sequence);
+    TEST_ASSERT_EQUAL(request.sent, decoded.sent);
+
+    TEST_ASSERT_EQUAL(0, encodeClockSyncRequest(request, buffer, CLOCK_SYNC_REQUEST_SIZE - 1));
+    TEST_ASSERT_FALSE(decodeClockSyncRequest(nullptr, sizeof(buffer), decoded));
+    TEST_ASSERT_FALSE(decodeClockSyncRequest(buffer, CLOCK_SYNC_REQUEST_SIZE - 1, decoded));
+    const uint8_t ping[] = {'1'}; // plain pings share the characteristic
+    TEST_ASSERT_FALSE(decodeClockSyncRequest(ping, sizeof(ping), decoded));
+    buffer[0] = CLOCK_SYNC_VERSION + 1;
+    TEST_ASSERT_FALSE(decodeClockSyncRequest(buffer, sizeof(buffer), decoded));
+}
+
+void test_reply_round_trip() {
+    ClockSyncReply reply{7, 1000, 0xFFFFFFF0, 5};
+    uint8_t buffer[CLOCK_SYNC_REPLY_SIZE];
+    TEST_ASSERT_EQUAL(CLOCK_SYNC_REPLY_SIZE, encodeClockSyncReply(reply, buffer, sizeof(buffer)));
+    ClockSyncReply decoded{};
+    TEST_ASSERT_TRUE(decodeClockSyncReply(buffer, sizeof(buffer), decoded));
+    TEST_ASSERT_EQUAL(reply.sequence, decoded.sequence);
+    TEST_ASSERT_EQUAL(reply.sent, decoded.sent);
+    TEST_ASSERT_EQUAL(reply.received, decoded.received);
+    TEST_ASSERT_EQUAL(reply.replied, decoded.replied);
+
+    TEST_ASSERT_EQUAL(0, encodeClockSyncReply(reply, buffer, CLOCK_SYNC_REPLY_SIZE - 1));
+    TEST_ASSERT_FALSE(decodeClockSyncReply(nullptr, sizeof(buffer), decoded));
+    TEST_ASSERT_FALSE(decodeClockSyncReply(buffer, CLOCK_SYNC_REPLY_SIZE - 1, decoded));
+    buffer[0] = CLOCK_SYNC_VERSION + 1;
+    TEST_ASSERT_FALSE(decodeClockSyncReply(buffer, sizeof(buffer), decoded));
+}
+
+// Symmetric delays recover the offset to the millisecond, across either clock wrapping
+void test_symmetric_link_is_exact() {
+    const double offsets[] = {123456.0, 4294967296.0 - 3000.0};
+    const double starts[] = {1e6, 4294967296.0 - 20000.0};
+    for (double offset : offsets) {
+        for (double start : starts) {
+            SimulatedLink link(offset, 0.0, start);
+            ClockSync sync;
+            TEST_ASSERT_FALSE(sync.isSynced());
+            for (int i = 0; i < 10; i++) {
+                link.exchange(sync, 6.0, 2.0, 6.0);
+                link.advance(CLOCK_SYNC_INTERVAL_MS);
+            }
+            TEST_ASSERT_TRUE(sync.isSynced());
+            TEST_ASSERT_INT32_WITHIN(1, 0, static_cast<int32_t>(sync.toRemote(link.local()) - link.remote()));
+            TEST_ASSERT_INT32_WITHIN(1, 0, static_cast<int32_t>(sync.toLocal(link.remote()) - link.local()));
+        }
+    }
+}
+
+// Round trips leave out the time the controller took to answer
+void test_stats_track_round_trips() {
+    SimulatedLink link(5000.0, 0.0, 1e6);
+    ClockSync sync;
+    const double delays[] = {5.0, 15.0, 10.0};
+    for (double delay : delays) {
+        link.exchange(sync, delay, 7.0, delay);
+        link.advance(CLOCK_SYNC_INTERVAL_MS);
+    }
+    const ClockSyncStats &stats = sync.getStats();
+    TEST_ASSERT_EQUAL(3, stats.exchanges);
+    TEST_ASSERT_UINT_WITHIN(1, 20, stats.rttMs);
+    TEST_ASSERT_UINT_WITHIN(1, 10, stats.minRttMs);
+    TEST_ASSERT_UINT_WITHIN(1, 30, stats.maxRttMs);
+    TEST_ASSERT_UINT_WITHIN(1, 5, stats.oneWayMs);
+    TEST_ASSERT_INT32_WITHIN(1, 5000, stats.offsetMs);
+
+    sync.reset();
+    TEST_ASSERT_FALSE(sync.isSynced());
+    TEST_ASSERT_EQUAL(0, sync.getStats().exchanges);
+}
+
+// One exchange stuck behind a connection event on the way out must not pull the offset
+void test_slow_exchange_is_ignored() {
+    SimulatedLink link(-20000.0, 0.0, 1e6);
+    ClockSync sync;
+    for (int i = 0; i < 8; i++) {
+        link.exchange(sync, 5.0, 1.0, 5.0);
+        link.advance(CLOCK_SYNC_INTERVAL_MS);
+    }
+    link.exchange(sync, 90.0, 1.0, 5.0);
+    TEST_ASSERT_INT32_WITHIN(1, 0, static_cast<int32_t>(sync.toLocal(link.remote()) - link.local()));
+}
+
+// The error budget the shot graphs rely on: controller timestamps land within a few ms of our clock
+void test_jitter_simulation() {
+    const double jitters[] = {2.0, 10.0, 30.0};
+    for (double jitter : jitters) {
+        SimulationResult result = simulate(jitter, 200, 5);
+        char message[128];
+        snprintf(message, sizeof(message), "%.0f ms jitter: error p50 %d ms, p95 %d ms, drift p95 %.1f ppm", jitter,
+                 result.errorP50, result.errorP95, result.driftP95);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_LESS_OR_EQUAL(static_cast<int>(jitter / 4) + 2, result.errorP95);
+        TEST_ASSERT_TRUE(result.driftP95 <= jitter);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_request_round_trip);
+    RUN_TEST(test_reply_round_trip);
+    RUN_TEST(test_symmetric_link_is_exact);
+    RUN_TEST(test_stats_track_round_trips);
+    RUN_TEST(test_slow_exchange_is_ignored);
+    RUN_TEST(test_jitter_simulation);
+    return UNITY_END();
+}
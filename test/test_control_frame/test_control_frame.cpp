@@ -0,0 +1,145 @@
+#include <ControlFrame.h>
+#include <fixed_point_asserts.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+ControlFrame makeFrame(OutputMode mode) {
+    ControlFrame frame{};
+    frame.sequence = 4242;
+    frame.mode = mode;
+    frame.valve = true;
+    frame.boilerSetpoint = 93.5f;
+    frame.pumpSetpoint = 87.25f;
+    frame.pressure = 9.123f;
+    frame.flow = 2.456f;
+    return frame;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_round_trip() {
+    const OutputMode modes[] = {OutputMode::POWER, OutputMode::PRESSURE, OutputMode::FLOW};
+    for (OutputMode mode : modes) {
+        for (bool valve : {false, true}) {
+            ControlFrame frame = makeFrame(mode);
+            frame.valve = valve;
+            uint8_t buffer[CONTROL_FRAME_SIZE];
+            TEST_ASSERT_EQUAL(CONTROL_FRAME_SIZE, encodeControlFrame(frame, buffer, sizeof(buffer)));
+            TEST_ASSERT_EQUAL(CONTROL_FRAME_VERSION, buffer[0]);
+
+            ControlFrame decoded{};
+            TEST_ASSERT_TRUE(decodeControlFrame(buffer, sizeof(buffer), decoded));
+            TEST_ASSERT_TRUE(frame.mode == decoded.mode);
+            TEST_ASSERT_EQUAL(frame.valve, decoded.valve);
+            TEST_ASSERT_EQUAL(frame.sequence, decoded.sequence);
+            assertSetpoints(frame, decoded);
+        }
+    }
+}
+
+// The display only resends a command whose bytes changed, so equal commands have to encode to equal bytes
+void test_equal_commands_encode_identically() {
+    ControlFrame frame = makeFrame(OutputMode::PRESSURE);
+    uint8_t first[CONTROL_FRAME_SIZE];
+    uint8_t second[CONTROL_FRAME_SIZE];
+    encodeControlFrame(frame, first, sizeof(first));
+    encodeControlFrame(frame, second, sizeof(second));
+    TEST_ASSERT_EQUAL(0, memcmp(first, second, CONTROL_FRAME_SIZE));
+
+    frame.pressure += 0.0004f; // below the resolution
+    encodeControlFrame(frame, second, sizeof(second));
+    TEST_ASSERT_EQUAL(0, memcmp(first, second, CONTROL_FRAME_SIZE));
+
+    frame.pressure += 0.001f;
+    encodeControlFrame(frame, second, sizeof(second));
+    TEST_ASSERT_NOT_EQUAL(0, memcmp(first, second, CONTROL_FRAME_SIZE));
+}
+
+void test_frame_saturates_and_keeps_nan() {
+    ControlFrame frame = makeFrame(OutputMode::FLOW);
+    frame.boilerSetpoint = 500.0f; // beyond 327.67 °C
+    frame.pumpSetpoint = -1000.0f; // below the range, must not turn into the NaN marker
+    frame.pressure = NAN;
+    frame.flow = INFINITY;
+    uint8_t buffer[CONTROL_FRAME_SIZE];
+    encodeControlFrame(frame, buffer, sizeof(buffer));
+    ControlFrame decoded{};
+    TEST_ASSERT_TRUE(decodeControlFrame(buffer, sizeof(buffer), decoded));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 327.67f, decoded.boilerSetpoint);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, -327.67f, decoded.pumpSetpoint);
+    TEST_ASSERT_FLOAT_IS_NAN(decoded.pressure);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 32.767f, decoded.flow);
+}
+
+void test_frame_rejects_malformed_input() {
+    ControlFrame frame = makeFrame(OutputMode::POWER);
+    uint8_t buffer[CONTROL_FRAME_SIZE + 4] = {};
+    TEST_ASSERT_EQUAL(0, encodeControlFrame(frame, buffer, CONTROL_FRAME_SIZE - 1));
+    encodeControlFrame(frame, buffer, sizeof(buffer));
+
+    ControlFrame decoded{};
+    TEST_ASSERT_FALSE(decodeControlFrame(nullptr, CONTROL_FRAME_SIZE, decoded));
+    TEST_ASSERT_FALSE(decodeControlFrame(buffer, CONTROL_FRAME_SIZE - 1, decoded));
+    TEST_ASSERT_TRUE(decodeControlFrame(buffer, sizeof(buffer), decoded)); // appended fields are ignored
+    buffer[1] = static_cast<uint8_t>(OutputMode::FLOW) + 1;
+    TEST_ASSERT_FALSE(decodeControlFrame(buffer, sizeof(buffer), decoded));
+    buffer[1] = static_cast<uint8_t>(OutputMode::POWER);
+    buffer[0] = CONTROL_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(decodeControlFrame(buffer, sizeof(buffer), decoded));
+}
+
+// Random frames round trip, random bytes of any length never crash the decoder or read past their end
+void test_frame_fuzz() {
+    std::mt19937 random(23);
+    std::uniform_real_distribution<float> setpoint(-30.0f, 30.0f);
+    for (int i = 0; i < FUZZ_ROUNDS; i++) {
+        ControlFrame frame{};
+        frame.sequence = static_cast<uint16_t>(random());
+        frame.mode = static_cast<OutputMode>(random() % 3);
+        frame.valve = random() % 2 == 0;
+        frame.boilerSetpoint = setpoint(random) * 5.0f + 150.0f;
+        frame.pumpSetpoint = std::fabs(setpoint(random)) * 3.0f;
+        frame.pressure = setpoint(random);
+        frame.flow = setpoint(random);
+        uint8_t buffer[CONTROL_FRAME_SIZE];
+        encodeControlFrame(frame, buffer, sizeof(buffer));
+        ControlFrame decoded{};
+        TEST_ASSERT_TRUE(decodeControlFrame(buffer, sizeof(buffer), decoded));
+        TEST_ASSERT_TRUE(frame.mode == decoded.mode);
+        TEST_ASSERT_EQUAL(frame.valve, decoded.valve);
+        TEST_ASSERT_EQUAL(frame.sequence, decoded.sequence);
+        assertSetpoints(frame, decoded);
+
+        std::vector<uint8_t> noise(random() % (CONTROL_FRAME_SIZE + 8));
+        for (uint8_t &byte : noise) {
+            byte = static_cast<uint8_t>(random());
+        }
+        if (noise.size() >= 2 && random() % 2 == 0) {
+            noise[0] = CONTROL_FRAME_VERSION;
+            noise[1] = static_cast<uint8_t>(random() % 4);
+        }
+        bool accepted = decodeControlFrame(noise.data(), noise.size(), decoded);
+        TEST_ASSERT_EQUAL(noise.size() >= CONTROL_FRAME_SIZE && noise[0] == CONTROL_FRAME_VERSION &&
+                              noise[1] <= static_cast<uint8_t>(OutputMode::FLOW),
+                          accepted);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_equal_commands_encode_identically);
+    RUN_TEST(test_frame_saturates_and_keeps_nan);
+    RUN_TEST(test_frame_rejects_malformed_input);
+    RUN_TEST(test_frame_fuzz);
+    return UNITY_END();
+}
@@ -0,0 +1,285 @@
+#include <display/core/PluginManager.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+// Literal ids are hashed by the compiler, not on every trigger()
+static_assert(EventId("controller:ready"_ev).hash == eventHash("controller:ready"), "literal hash differs");
+static_assert(EventKey("value"_ev) == EventKey("value"_ev), "literal keys differ");
+
+namespace {
+
+// Roughly the number of events the display registers listeners for
+constexpr int BENCHMARK_EVENTS = 64;
+constexpr int BENCHMARK_TRIGGERS = 1000000;
+
+// The bus before event ids were hashed, kept as the benchmark reference: listeners in a std::map keyed by name,
+// payload values in a vector keyed by String, both copied or compared on every trigger
+struct BaselineEvent {
+    struct Entry {
+        String key;
+        int intValue;
+    };
+    String id;
+    std::vector<Entry> data;
+    bool stopPropagation = false;
+
+    int getInt(const String &key) const {
+        for (const auto &entry : data) {
+            if (entry.key == key) {
+                return entry.intValue;
+            }
+        }
+        return 0;
+    }
+};
+
+class BaselineBus {
+  public:
+    void on(const String &eventId, const std::function<void(BaselineEvent &)> &callback) {
+        listeners[std::string(eventId.c_str())].push_back(callback);
+    }
+
+    BaselineEvent trigger(const String &eventId, const String &key, int value) {
+        BaselineEvent event;
+        event.id = eventId;
+        event.data.push_back({key, value});
+        if (listeners.count(std::string(event.id.c_str()))) {
+            for (auto const &callback : listeners[std::string(event.id.c_str())]) {
+                callback(event);
+                if (event.stopPropagation) {
+                    break;
+                }
+            }
+        }
+        return event;
+    }
+
+  private:
+    std::map<std::string, std::vector<std::function<void(BaselineEvent &)>>> listeners;
+};
+
+bool waitFor(const std::atomic<int> &counter, int expected) {
+    for (int i = 0; i < 1000 && counter.load() < expected; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return counter.load() >= expected;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_sync_delivery_reads_values() {
+    PluginManager manager;
+    int delivered = 0;
+    float value = 0.0f;
+    manager.on("boiler:currentTemperature:change"_ev, [&](Event &event) {
+        delivered++;
+        value = event.getFloat("value"_ev);
+    });
+    manager.trigger("boiler:currentTemperature:change"_ev, "value"_ev, 93.5f);
+    manager.trigger("boiler:targetTemperature:change"_ev, "value"_ev, 94.0f);
+    TEST_ASSERT_EQUAL(1, delivered);
+    TEST_ASSERT_EQUAL_FLOAT(93.5f, value);
+    TEST_ASSERT_TRUE(manager.hasListeners("boiler:currentTemperature:change"_ev));
+    TEST_ASSERT_FALSE(manager.hasListeners("boiler:targetTemperature:change"_ev));
+}
+
+void test_callback_may_register_listeners() {
+    PluginManager manager;
+    int late = 0;
+    manager.on("controller:ready"_ev, [&](Event &) {
+        manager.on("controller:ready"_ev, [&](Event &) { late++; });
+        manager.on("controller:mode:change"_ev, [&](Event &) { late++; });
+    });
+    manager.trigger("controller:ready"_ev);
+    TEST_ASSERT_EQUAL(0, late);
+    manager.trigger("controller:mode:change"_ev, "value"_ev, 1);
+    TEST_ASSERT_EQUAL(1, late);
+}
+
+void test_registration_while_triggering() {
+    PluginManager manager;
+    std::atomic<int> delivered{0};
+    std::atomic<bool> done{false};
+    manager.on("controller:sensor:update"_ev, [&](Event &) { delivered++; });
+    std::thread publisher([&] {
+        while (!done.load()) {
+            manager.trigger("controller:sensor:update"_ev);
+        }
+    });
+    TEST_ASSERT_TRUE(waitFor(delivered, 1));
+    for (int i = 0; i < 1000; i++) {
+        manager.on(String(("test:late:" + std::to_string(i)).c_str()), [](Event &) {});
+    }
+    int afterRegistration = delivered.load();
+    TEST_ASSERT_TRUE(waitFor(delivered, afterRegistration + 1));
+    done.store(true);
+    publisher.join();
+    TEST_ASSERT_TRUE(manager.hasListeners("test:late:999"));
+}
+
+// Plugins written against the String based bus still compile and reach the same listeners as "name"_ev
+void test_string_signatures_still_work() {
+    PluginManager manager;
+    int ready = 0;
+    float temperature = 0.0f;
+    int mode = -1;
+    String profile;
+    manager.on("controller:ready", [&](Event &) { ready++; });
+    manager.on(String("boiler:currentTemperature:") + "change", [&](Event &event) {
+        temperature = event.getFloat("value");
+        mode = event.getInt(String("mode"));
+    });
+    manager.on("profiles:profile:select"_ev, [&](Event &event) { profile = event.getString("id"); });
+
+    manager.trigger("controller:ready");
+    manager.trigger("controller:ready"_ev);
+    Event event;
+    event.id = String("boiler:currentTemperature:change");
+    event.setFloat("value", 92.5f);
+    event.setInt(String("mode"), 2);
+    manager.trigger(event);
+    manager.trigger(String("profiles:profile:select"), String("id"), String("classic"));
+
+    TEST_ASSERT_EQUAL(2, ready);
+    TEST_ASSERT_EQUAL_FLOAT(92.5f, temperature);
+    TEST_ASSERT_EQUAL(2, mode);
+    TEST_ASSERT_TRUE(profile == String("classic"));
+    TEST_ASSERT_EQUAL_STRING("boiler:currentTemperature:change", event.id.name); // the manager's copy
+}
+
+// Two names with the same 32 bit hash would share one listener list, the second registration is refused
+void test_colliding_ids_are_rejected() {
+    PluginManager manager;
+    int first = 0;
+    int second = 0;
+    TEST_ASSERT_TRUE(EventId("plugin:event:94152") == EventId("plugin:event:635410"));
+    manager.on("plugin:event:94152", [&](Event &) { first++; });
+    manager.on("plugin:event:635410", [&](Event &) { second++; });
+
+    manager.trigger("plugin:event:94152");
+    TEST_ASSERT_EQUAL(1, first);
+    TEST_ASSERT_EQUAL(0, second);
+}
+
+void test_change_policy_filters_small_changes() {
+    PluginManager manager;
+    int every = 0;
+    std::vector<float> changes;
+    manager.on("boiler:currentTemperature:change"_ev, [&](Event &) { every++; });
+    manager.on("boiler:currentTemperature:change"_ev, [&](Event &event) { changes.push_back(event.getFloat("value"_ev)); },
+               EventDelivery::SYNC, EventPolicy::onChange(0.1f));
+    const float temperatures[] = {93.0f, 93.05f, 93.08f, 93.2f, 93.25f, 92.9f};
+    for (float temperature : temperatures) {
+        manager.trigger("boiler:currentTemperature:change"_ev, "value"_ev, temperature);
+    }
+    TEST_ASSERT_EQUAL(6, every);
+    TEST_ASSERT_EQUAL(3, changes.size());
+    TEST_ASSERT_EQUAL_FLOAT(93.2f, changes[1]);
+    TEST_ASSERT_EQUAL_FLOAT(92.9f, changes[2]);
+}
+
+// A SYNC listener with a stateful policy triggered from two tasks at once, run under TSan to check the state
+void test_policy_state_shared_between_tasks() {
+    PluginManager manager;
+    std::atomic<int> delivered{0};
+    manager.on("boiler:currentTemperature:change"_ev, [&](Event &) { delivered++; }, EventDelivery::SYNC,
+               EventPolicy::onChange(0.5f));
+    auto publish = [&](float offset) {
+        for (int i = 0; i < 20000; i++) {
+            manager.trigger("boiler:currentTemperature:change"_ev, "value"_ev, offset + (i % 2));
+        }
+    };
+    std::thread first(publish, 90.0f);
+    std::thread second(publish, 95.0f);
+    first.join();
+    second.join();
+    TEST_ASSERT_GREATER_THAN(0, delivered.load());
+}
+
+void test_async_delivery_copies_strings() {
+    // The dispatcher task never ends, so the manager has to outlive the test like it outlives the firmware
+    static PluginManager manager;
+    manager.setup(nullptr);
+    std::atomic<int> delivered{0};
+    String received;
+    manager.on(
+        "profiles:profile:select"_ev,
+        [&](Event &event) {
+            received = event.getString("id"_ev);
+            delivered++;
+        },
+        EventDelivery::ASYNC);
+    manager.trigger("profiles:profile:select"_ev, "id"_ev, String("9f3c2a1e-profile"));
+    TEST_ASSERT_TRUE(waitFor(delivered, 1));
+    TEST_ASSERT_TRUE(received == String("9f3c2a1e-profile"));
+
+    // Too long for the queued copy: dropped and counted, never delivered in place
+    std::string tooLong(EVENT_QUEUED_STRING_CAPACITY + 1, 'x');
+    manager.trigger("profiles:profile:select"_ev, "id"_ev, String(tooLong));
+    TEST_ASSERT_EQUAL(1, delivered.load());
+    TEST_ASSERT_EQUAL(1, manager.getQueueStats(EventDelivery::ASYNC).dropped);
+}
+
+// Same listeners and triggers on the String keyed baseline and on the hashed bus, reported side by side
+void test_benchmark_sync_trigger() {
+    char names[BENCHMARK_EVENTS][24];
+    for (int i = 0; i < BENCHMARK_EVENTS; i++) {
+        snprintf(names[i], sizeof(names[i]), "benchmark:event:%d", i);
+    }
+
+    BaselineBus baseline;
+    uint32_t baselineSink = 0;
+    for (int i = 0; i < BENCHMARK_EVENTS; i++) {
+        baseline.on(names[i], [&](BaselineEvent &event) { baselineSink += event.getInt("value"); });
+    }
+    baseline.on("controller:sensor:update", [&](BaselineEvent &event) { baselineSink += event.getInt("value"); });
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_TRIGGERS; i++) {
+        baseline.trigger("controller:sensor:update", "value", i & 1);
+    }
+    std::chrono::duration<double> baselineElapsed = std::chrono::steady_clock::now() - start;
+
+    PluginManager manager;
+    uint32_t sink = 0;
+    for (int i = 0; i < BENCHMARK_EVENTS; i++) {
+        manager.on(names[i], [&](Event &event) { sink += event.getInt("value"_ev); });
+    }
+    manager.on("controller:sensor:update"_ev, [&](Event &event) { sink += event.getInt("value"_ev); });
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_TRIGGERS; i++) {
+        manager.trigger("controller:sensor:update"_ev, "value"_ev, i & 1);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "sync trigger with %d registered events: %.0f events/s with String ids, %.0f events/s with hashed ids",
+             BENCHMARK_EVENTS + 1, BENCHMARK_TRIGGERS / baselineElapsed.count(), BENCHMARK_TRIGGERS / elapsed.count());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(BENCHMARK_TRIGGERS / 2, baselineSink);
+    TEST_ASSERT_EQUAL(BENCHMARK_TRIGGERS / 2, sink);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sync_delivery_reads_values);
+    RUN_TEST(test_callback_may_register_listeners);
+    RUN_TEST(test_registration_while_triggering);
+    RUN_TEST(test_string_signatures_still_work);
+    RUN_TEST(test_colliding_ids_are_rejected);
+    RUN_TEST(test_change_policy_filters_small_changes);
+    RUN_TEST(test_policy_state_shared_between_tasks);
+    RUN_TEST(test_async_delivery_copies_strings);
+    RUN_TEST(test_benchmark_sync_trigger);
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+#include <display/models/profile_plan.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unity.h>
+
+namespace {
+
+constexpr int EQUIVALENCE_PROFILES = 5000;
+constexpr int EQUIVALENCE_INPUTS = 50; // random sensor states per phase
+constexpr int BENCHMARK_TICKS = 1000000;
+
+class RandomProfiles {
+  public:
+    explicit RandomProfiles(uint32_t seed) : random(seed) {}
+
+    Profile next() {
+        Profile profile;
+        profile.label = "random";
+        profile.type = chance(0.5f) ? "standard" : "pro";
+        profile.utility = chance(0.1f);
+        profile.temperature = uniform(85.0f, 96.0f);
+        int phases = 1 + random() % 8;
+        for (int i = 0; i < phases; i++) {
+            profile.phases.push_back(nextPhase(i));
+        }
+        return profile;
+    }
+
+    float uniform(float low, float high) { return std::uniform_real_distribution<float>(low, high)(random); }
+    bool chance(float probability) { return uniform(0.0f, 1.0f) < probability; }
+
+  private:
+    Phase nextPhase(int index) {
+        Phase phase;
+        phase.name = chance(0.2f) ? "A phase name well beyond the thirty one characters kept" : "Phase";
+        phase.phase = index == 0 && chance(0.5f) ? PhaseType::PHASE_TYPE_PREINFUSION : PhaseType::PHASE_TYPE_BREW;
+        phase.valve = chance(0.8f) ? 1 : 0;
+        phase.duration = chance(0.1f) ? 0.0f : uniform(0.5f, 40.0f);
+        phase.pumpIsSimple = chance(0.4f);
+        phase.pumpSimple = random() % 101;
+        phase.temperature = chance(0.5f) ? 0.0f : uniform(80.0f, 98.0f);
+        phase.transition.type = static_cast<TransitionType>(random() % 5);
+        phase.transition.duration = chance(0.3f) ? 0.0f : uniform(0.1f, 10.0f);
+        phase.transition.adaptive = chance(0.5f);
+        phase.pumpAdvanced.target = chance(0.5f) ? PumpTarget::PUMP_TARGET_PRESSURE : PumpTarget::PUMP_TARGET_FLOW;
+        phase.pumpAdvanced.pressure = chance(0.2f) ? -1.0f : uniform(0.0f, 12.0f);
+        phase.pumpAdvanced.flow = chance(0.2f) ? -1.0f : uniform(0.0f, 8.0f);
+        int targets = random() % 4;
+        for (int i = 0; i < targets; i++) {
+            Target target{};
+            target.type = static_cast<TargetType>(random() % 4);
+            target.operator_ = chance(0.5f) ? TargetOperator::GTE : TargetOperator::LTE;
+            target.value = chance(0.1f) ? 0.0f : uniform(0.0f, 50.0f);
+            phase.targets.push_back(target);
+        }
+        return phase;
+    }
+
+    std::mt19937 random;
+};
+
+// BrewProcess before profiles were compiled, kept here as the reference
+float referenceAlpha(const Phase &phase, unsigned long elapsedMs) {
+    float duration = phase.transition.duration;
+    if (duration <= 0.0f) {
+        duration = phase.duration;
+    }
+    if (phase.transition.type == TransitionType::INSTANT || duration <= 0.0f) {
+        return 1.0f;
+    }
+    float t = float(elapsedMs) / (duration * 1000.0f);
+    if (t <= 0.0f)
+        return 0.0f;
+    if (t >= 1.0f)
+        return 1.0f;
+    switch (phase.transition.type) {
+    case TransitionType::LINEAR:
+        return easing::linear(t);
+    case TransitionType::EASE_IN:
+        return easing::in(t);
+    case TransitionType::EASE_OUT:
+        return easing::out(t);
+    case TransitionType::EASE_IN_OUT:
+        return easing::inOut(t);
+    default:
+        return 1.0f;
+    }
+}
+
+double referenceBrewVolume(const Profile &profile) {
+    double brewVolume = 0;
+    for (const auto &phase : profile.phases) {
+        if (phase.hasVolumetricTarget()) {
+            brewVolume = phase.getVolumetricTarget().value;
+        }
+    }
+    return brewVolume;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// Everything the brew loop reads from the plan has to match what it used to compute from the Profile
+void test_plan_matches_profile() {
+    RandomProfiles profiles(20);
+    for (int p = 0; p < EQUIVALENCE_PROFILES; p++) {
+        Profile profile = profiles.next();
+        ProfilePlan plan{};
+        compileProfile(profile, plan);
+
+        TEST_ASSERT_EQUAL(profile.phases.size(), plan.phaseCount);
+        TEST_ASSERT_EQUAL(profile.utility, plan.utility);
+        TEST_ASSERT_EQUAL(static_cast<unsigned long>(profile.getTotalDuration() * 1000L), plan.totalDurationMs);
+        TEST_ASSERT_TRUE(referenceBrewVolume(profile) == plan.brewVolume);
+
+        for (uint8_t i = 0; i < plan.phaseCount; i++) {
+            const Phase &phase = profile.phases[i];
+            const PhasePlan &planned = plan.phases[i];
+            TEST_ASSERT_EQUAL(0, strncmp(phase.name.c_str(), planned.name, PROFILE_PLAN_NAME_LENGTH - 1));
+            TEST_ASSERT_TRUE(phase.phase == planned.phase);
+            TEST_ASSERT_EQUAL(static_cast<bool>(phase.valve), planned.valve);
+            TEST_ASSERT_EQUAL(!phase.pumpIsSimple, planned.advancedPump);
+            TEST_ASSERT_TRUE((phase.pumpIsSimple ? phase.pumpSimple : 100.0f) == planned.pumpValue);
+            TEST_ASSERT_TRUE((phase.temperature > 0.0f ? phase.temperature : profile.temperature) == planned.temperature);
+            TEST_ASSERT_EQUAL(static_cast<unsigned long>(static_cast<long>(phase.duration) * 1000L), planned.durationMs);
+            TEST_ASSERT_TRUE(phase.transition.adaptive == planned.adaptive);
+            TEST_ASSERT_TRUE(phase.pumpAdvanced.target == planned.pumpTarget);
+            TEST_ASSERT_TRUE(phase.pumpAdvanced.pressure == planned.pressure);
+            TEST_ASSERT_TRUE(phase.pumpAdvanced.flow == planned.flow);
+
+            const unsigned long transitionEnd = static_cast<unsigned long>(planned.transitionMs) + 1000;
+            for (int n = 0; n < EQUIVALENCE_INPUTS; n++) {
+                unsigned long elapsedMs = static_cast<unsigned long>(profiles.uniform(0.0f, transitionEnd));
+                TEST_ASSERT_TRUE(referenceAlpha(phase, elapsedMs) == planned.transitionAlpha(elapsedMs));
+
+                bool volumetric = profiles.chance(0.5f);
+                float volume = profiles.uniform(0.0f, 60.0f);
+                float timeInPhase = profiles.uniform(0.0f, 45.0f);
+                float flow = profiles.uniform(0.0f, 60.0f);
+                float pressure = profiles.uniform(0.0f, 60.0f);
+                float pumped = profiles.uniform(0.0f, 60.0f);
+                TEST_ASSERT_EQUAL(
+                    phase.isFinished(volumetric, volume, timeInPhase, flow, pressure, pumped, profile.type),
+                    plan.isPhaseFinished(planned, volumetric, volume, timeInPhase, flow, pressure, pumped));
+            }
+        }
+    }
+}
+
+void test_oversized_profile_is_truncated() {
+    Profile profile;
+    profile.label = "oversized";
+    profile.type = "pro";
+    profile.temperature = 93.0f;
+    for (int i = 0; i < PROFILE_PLAN_MAX_PHASES + 6; i++) {
+        Phase phase{};
+        phase.name = "Phase";
+        phase.duration = 1.0f;
+        phase.targets.assign(4, Target{TargetType::TARGET_TYPE_PRESSURE, TargetOperator::GTE, 9.0f});
+        profile.phases.push_back(phase);
+    }
+
+    ProfilePlan plan{};
+    compileProfile(profile, plan);
+    TEST_ASSERT_EQUAL(PROFILE_PLAN_MAX_PHASES, plan.phaseCount);
+    TEST_ASSERT_EQUAL(PROFILE_PLAN_MAX_TARGETS, plan.targetCount);
+    const PhasePlan &last = plan.phases[plan.phaseCount - 1];
+    TEST_ASSERT_EQUAL(PROFILE_PLAN_MAX_TARGETS, last.firstTarget + last.targetCount);
+    TEST_ASSERT_EQUAL(0, last.targetCount);
+}
+
+// The check the 100ms progress tick runs most, against the Profile walk it replaced
+void test_benchmark_phase_finished() {
+    RandomProfiles profiles(3);
+    Profile profile = profiles.next();
+    profile.type = "standard";
+    ProfilePlan plan{};
+    compileProfile(profile, plan);
+
+    uint32_t referenceHits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_TICKS; i++) {
+        const Phase &phase = profile.phases[i % profile.phases.size()];
+        referenceHits += phase.isFinished(true, i % 50, i % 40, 2.0f, 9.0f, i % 60, profile.type);
+    }
+    std::chrono::duration<double, std::nano> reference = std::chrono::steady_clock::now() - start;
+
+    uint32_t planHits = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_TICKS; i++) {
+        const PhasePlan &phase = plan.phases[i % plan.phaseCount];
+        planHits += plan.isPhaseFinished(phase, true, i % 50, i % 40, 2.0f, 9.0f, i % 60);
+    }
+    std::chrono::duration<double, std::nano> planned = std::chrono::steady_clock::now() - start;
+
+    char message[128];
+    snprintf(message, sizeof(message), "phase finished check: %.1f ns from the Profile, %.1f ns from the plan",
+             reference.count() / BENCHMARK_TICKS, planned.count() / BENCHMARK_TICKS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(referenceHits, planHits);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_plan_matches_profile);
+    RUN_TEST(test_oversized_profile_is_truncated);
+    RUN_TEST(test_benchmark_phase_finished);
+    return UNITY_END();
+}
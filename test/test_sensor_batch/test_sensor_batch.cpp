@@ -0,0 +1,198 @@
+#include <SensorFrame.h>
+#include <fixed_point_asserts.h>
+
+#include <cmath>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+constexpr size_t BATCH_BUFFER_SIZE = SENSOR_BATCH_HEADER_SIZE + SENSOR_BATCH_MAX_SAMPLES * SENSOR_BATCH_SAMPLE_SIZE;
+
+// Consecutive control cycles 25ms apart, all echoing control frame 9
+std::vector<SensorFrame> makeSamples(size_t count, uint16_t sequence, uint32_t timestamp) {
+    std::vector<SensorFrame> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        SensorFrame &sample = samples[i];
+        sample.sequence = static_cast<uint16_t>(sequence + i);
+        sample.timestamp = timestamp + static_cast<uint32_t>(i) * 25;
+        sample.temperature = 92.5f + i * 0.11f;
+        sample.pressure = 1.25f + i * 0.75f;
+        sample.puckFlow = 0.5f + i * 0.125f;
+        sample.pumpFlow = 1.75f + i * 0.25f;
+        sample.puckResistance = 1200.0f + i * 3.5f;
+        sample.controlSequence = 9;
+        sample.controlTimestamp = timestamp - 40;
+    }
+    return samples;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_batch_round_trip() {
+    std::vector<SensorFrame> samples = makeSamples(SENSOR_BATCH_MAX_SAMPLES, 65533, 0xFFFFFFC0); // both about to wrap
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    size_t encoded = 0;
+    TEST_ASSERT_EQUAL(sizeof(buffer), encodeSensorBatch(samples.data(), samples.size(), buffer, sizeof(buffer), encoded));
+    TEST_ASSERT_EQUAL(SENSOR_BATCH_MAX_SAMPLES, encoded);
+    TEST_ASSERT_EQUAL(SENSOR_BATCH_VERSION, buffer[0]);
+
+    SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES] = {};
+    TEST_ASSERT_EQUAL(SENSOR_BATCH_MAX_SAMPLES, decodeSensorBatch(buffer, sizeof(buffer), decoded, SENSOR_BATCH_MAX_SAMPLES));
+    for (size_t i = 0; i < SENSOR_BATCH_MAX_SAMPLES; i++) {
+        TEST_ASSERT_EQUAL(samples[i].sequence, decoded[i].sequence);
+        TEST_ASSERT_EQUAL(samples[i].timestamp, decoded[i].timestamp);
+        TEST_ASSERT_EQUAL(samples[i].controlSequence, decoded[i].controlSequence);
+        TEST_ASSERT_EQUAL(samples[i].controlTimestamp, decoded[i].controlTimestamp);
+        assertChannels(samples[i], decoded[i]);
+    }
+}
+
+// The control echo travels once per batch, taken from the last sample encoded
+void test_batch_echoes_last_control_frame() {
+    std::vector<SensorFrame> samples = makeSamples(3, 100, 5000);
+    samples[0].controlSequence = 7;
+    samples[2].controlSequence = 8;
+    samples[2].controlTimestamp = 5030;
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    size_t encoded = 0;
+    size_t length = encodeSensorBatch(samples.data(), samples.size(), buffer, sizeof(buffer), encoded);
+    SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES] = {};
+    TEST_ASSERT_EQUAL(3, decodeSensorBatch(buffer, length, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(8, decoded[i].controlSequence);
+        TEST_ASSERT_EQUAL(5030, decoded[i].controlTimestamp);
+    }
+}
+
+// A notification carries no more than MTU - 3 bytes, the encoder fills that and leaves the rest for the next one
+void test_batch_is_limited_by_buffer_size() {
+    std::vector<SensorFrame> samples = makeSamples(SENSOR_BATCH_MAX_SAMPLES + 4, 1, 1000);
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    const uint16_t mtus[] = {23, 27, 41, 64, 100, 128, 185, 247, 512};
+    for (uint16_t mtu : mtus) {
+        const size_t payload = mtu - 3;
+        const size_t size = payload < sizeof(buffer) ? payload : sizeof(buffer);
+        const size_t fit = size < SENSOR_BATCH_HEADER_SIZE ? 0 : (size - SENSOR_BATCH_HEADER_SIZE) / SENSOR_BATCH_SAMPLE_SIZE;
+        const size_t expected = fit < SENSOR_BATCH_MAX_SAMPLES ? fit : SENSOR_BATCH_MAX_SAMPLES;
+
+        size_t encoded = 99;
+        size_t length = encodeSensorBatch(samples.data(), samples.size(), buffer, size, encoded);
+        TEST_ASSERT_EQUAL(expected, encoded);
+        TEST_ASSERT_EQUAL(expected == 0 ? 0 : SENSOR_BATCH_HEADER_SIZE + expected * SENSOR_BATCH_SAMPLE_SIZE, length);
+        TEST_ASSERT_LESS_OR_EQUAL(size, length);
+    }
+
+    // Splitting a backlog over several notifications keeps every sample and its sequence
+    const size_t size = SENSOR_BATCH_HEADER_SIZE + 3 * SENSOR_BATCH_SAMPLE_SIZE;
+    std::vector<SensorFrame> received;
+    for (size_t sent = 0; sent < samples.size();) {
+        size_t encoded = 0;
+        size_t length = encodeSensorBatch(samples.data() + sent, samples.size() - sent, buffer, size, encoded);
+        TEST_ASSERT_GREATER_THAN(0, encoded);
+        SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES];
+        size_t count = decodeSensorBatch(buffer, length, decoded, SENSOR_BATCH_MAX_SAMPLES);
+        TEST_ASSERT_EQUAL(encoded, count);
+        received.insert(received.end(), decoded, decoded + count);
+        sent += encoded;
+    }
+    TEST_ASSERT_EQUAL(samples.size(), received.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        TEST_ASSERT_EQUAL(samples[i].sequence, received[i].sequence);
+        TEST_ASSERT_EQUAL(samples[i].timestamp, received[i].timestamp);
+    }
+}
+
+void test_batch_saturates_timestamp_offsets() {
+    std::vector<SensorFrame> samples = makeSamples(2, 1, 1000);
+    samples[1].timestamp = samples[0].timestamp + 70000;        // beyond the u16 offset
+    samples[1].controlTimestamp = samples[0].timestamp - 50000; // beyond the i16 offset
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    size_t encoded = 0;
+    size_t length = encodeSensorBatch(samples.data(), samples.size(), buffer, sizeof(buffer), encoded);
+    SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES];
+    TEST_ASSERT_EQUAL(2, decodeSensorBatch(buffer, length, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(samples[0].timestamp + UINT16_MAX, decoded[1].timestamp);
+    TEST_ASSERT_EQUAL(samples[0].timestamp + INT16_MIN, decoded[1].controlTimestamp);
+}
+
+void test_batch_rejects_malformed_input() {
+    std::vector<SensorFrame> samples = makeSamples(4, 1, 1000);
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    size_t encoded = 99;
+    TEST_ASSERT_EQUAL(0, encodeSensorBatch(samples.data(), 0, buffer, sizeof(buffer), encoded));
+    TEST_ASSERT_EQUAL(0, encoded);
+    TEST_ASSERT_EQUAL(0, encodeSensorBatch(samples.data(), samples.size(), buffer,
+                                           SENSOR_BATCH_HEADER_SIZE + SENSOR_BATCH_SAMPLE_SIZE - 1, encoded));
+    TEST_ASSERT_EQUAL(0, encoded);
+
+    const size_t length = encodeSensorBatch(samples.data(), samples.size(), buffer, sizeof(buffer), encoded);
+    SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES];
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(nullptr, length, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, SENSOR_BATCH_HEADER_SIZE - 1, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, length - 1, decoded, SENSOR_BATCH_MAX_SAMPLES)); // last sample cut
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, length, decoded, 3));                             // no room
+    TEST_ASSERT_EQUAL(4, decodeSensorBatch(buffer, length, decoded, 4));
+
+    buffer[1] = 0;
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, length, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    buffer[1] = 4;
+    buffer[0] = SENSOR_FRAME_VERSION; // a single frame is not a batch
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, length, decoded, SENSOR_BATCH_MAX_SAMPLES));
+}
+
+// Below the MTU a batch needs, the controller sends the latest sample as a frame cut to the payload instead
+void test_frame_fallback_at_default_mtu() {
+    std::vector<SensorFrame> samples = makeSamples(1, 300, 1000);
+    const size_t payload = 23 - 3;
+    uint8_t buffer[BATCH_BUFFER_SIZE];
+    size_t encoded = 0;
+    TEST_ASSERT_EQUAL(0, encodeSensorBatch(samples.data(), samples.size(), buffer, payload, encoded));
+
+    TEST_ASSERT_EQUAL(SENSOR_FRAME_SIZE, encodeSensorFrame(samples[0], buffer, sizeof(buffer)));
+    SensorFrame decoded[SENSOR_BATCH_MAX_SAMPLES];
+    TEST_ASSERT_EQUAL(0, decodeSensorBatch(buffer, payload, decoded, SENSOR_BATCH_MAX_SAMPLES));
+    TEST_ASSERT_TRUE(decodeSensorFrame(buffer, payload, decoded[0]));
+    TEST_ASSERT_EQUAL(samples[0].sequence, decoded[0].sequence);
+    TEST_ASSERT_EQUAL(samples[0].timestamp, decoded[0].timestamp);
+    TEST_ASSERT_EQUAL(0, decoded[0].controlSequence);
+    assertChannels(samples[0], decoded[0]);
+}
+
+// Random bytes of any length never crash the decoder or make it write past capacity
+void test_batch_fuzz() {
+    std::mt19937 random(22);
+    for (int i = 0; i < FUZZ_ROUNDS / 2; i++) { // buffers are up to a whole batch long
+        std::vector<uint8_t> noise(random() % (BATCH_BUFFER_SIZE + 16));
+        for (uint8_t &byte : noise) {
+            byte = static_cast<uint8_t>(random());
+        }
+        if (noise.size() >= 2 && random() % 2 == 0) {
+            noise[0] = SENSOR_BATCH_VERSION;
+            noise[1] = static_cast<uint8_t>(random() % (SENSOR_BATCH_MAX_SAMPLES + 2));
+        }
+        const size_t capacity = 1 + random() % SENSOR_BATCH_MAX_SAMPLES;
+        std::vector<SensorFrame> decoded(capacity);
+        size_t count = decodeSensorBatch(noise.data(), noise.size(), decoded.data(), capacity);
+
+        bool valid = noise.size() >= SENSOR_BATCH_HEADER_SIZE && noise[0] == SENSOR_BATCH_VERSION && noise[1] > 0 &&
+                     noise[1] <= capacity && noise.size() >= SENSOR_BATCH_HEADER_SIZE + noise[1] * SENSOR_BATCH_SAMPLE_SIZE;
+        TEST_ASSERT_EQUAL(valid ? noise[1] : 0, count);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_batch_round_trip);
+    RUN_TEST(test_batch_echoes_last_control_frame);
+    RUN_TEST(test_batch_is_limited_by_buffer_size);
+    RUN_TEST(test_batch_saturates_timestamp_offsets);
+    RUN_TEST(test_batch_rejects_malformed_input);
+    RUN_TEST(test_frame_fallback_at_default_mtu);
+    RUN_TEST(test_batch_fuzz);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <SensorFrame.h>
+#include <fixed_point_asserts.h>
+
+#include <cmath>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+SensorFrame makeFrame(uint16_t sequence, uint32_t timestamp) {
+    SensorFrame frame{};
+    frame.sequence = sequence;
+    frame.timestamp = timestamp;
+    frame.temperature = 93.27f;
+    frame.pressure = 8.912f;
+    frame.puckFlow = 1.874f;
+    frame.pumpFlow = 2.031f;
+    frame.puckResistance = 4.56f;
+    frame.controlSequence = 17;
+    frame.controlTimestamp = timestamp - 12;
+    return frame;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_round_trip() {
+    SensorFrame frame = makeFrame(40000, 0xFFFFFFF0); // timestamp about to wrap, control echo before it
+    uint8_t buffer[SENSOR_FRAME_SIZE];
+    TEST_ASSERT_EQUAL(SENSOR_FRAME_SIZE, encodeSensorFrame(frame, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(SENSOR_FRAME_VERSION, buffer[0]);
+
+    SensorFrame decoded{};
+    TEST_ASSERT_TRUE(decodeSensorFrame(buffer, sizeof(buffer), decoded));
+    TEST_ASSERT_EQUAL(frame.sequence, decoded.sequence);
+    TEST_ASSERT_EQUAL(frame.timestamp, decoded.timestamp);
+    TEST_ASSERT_EQUAL(frame.controlSequence, decoded.controlSequence);
+    TEST_ASSERT_EQUAL(frame.controlTimestamp, decoded.controlTimestamp);
+    assertChannels(frame, decoded);
+}
+
+void test_frame_saturates_and_keeps_nan() {
+    SensorFrame frame = makeFrame(1, 1000);
+    frame.temperature = NAN;
+    frame.pressure = 1000.0f;  // beyond 32.767 bar
+    frame.puckFlow = -1000.0f; // below the range, must not turn into the NaN marker
+    frame.pumpFlow = INFINITY;
+    frame.puckResistance = NAN;
+    frame.controlTimestamp = frame.timestamp + 100000; // beyond the i16 offset
+
+    uint8_t buffer[SENSOR_FRAME_SIZE];
+    encodeSensorFrame(frame, buffer, sizeof(buffer));
+    SensorFrame decoded{};
+    TEST_ASSERT_TRUE(decodeSensorFrame(buffer, sizeof(buffer), decoded));
+    TEST_ASSERT_FLOAT_IS_NAN(decoded.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 32.767f, decoded.pressure);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, -32.767f, decoded.puckFlow);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 32.767f, decoded.pumpFlow);
+    TEST_ASSERT_FLOAT_IS_INF(decoded.puckResistance);
+    TEST_ASSERT_EQUAL(frame.timestamp + INT16_MAX, decoded.controlTimestamp);
+}
+
+void test_frame_without_control_echo() {
+    SensorFrame frame = makeFrame(5, 2000);
+    uint8_t buffer[SENSOR_FRAME_SIZE];
+    encodeSensorFrame(frame, buffer, sizeof(buffer));
+    SensorFrame decoded{};
+    TEST_ASSERT_TRUE(decodeSensorFrame(buffer, SENSOR_FRAME_MIN_SIZE, decoded));
+    TEST_ASSERT_EQUAL(0, decoded.controlSequence);
+    TEST_ASSERT_EQUAL(0, decoded.controlTimestamp);
+    assertChannels(frame, decoded);
+}
+
+void test_frame_rejects_malformed_input() {
+    SensorFrame frame = makeFrame(5, 2000);
+    uint8_t buffer[SENSOR_FRAME_SIZE + 4] = {};
+    TEST_ASSERT_EQUAL(0, encodeSensorFrame(frame, buffer, SENSOR_FRAME_SIZE - 1));
+    encodeSensorFrame(frame, buffer, sizeof(buffer));
+
+    SensorFrame decoded{};
+    TEST_ASSERT_FALSE(decodeSensorFrame(nullptr, SENSOR_FRAME_SIZE, decoded));
+    TEST_ASSERT_FALSE(decodeSensorFrame(buffer, SENSOR_FRAME_MIN_SIZE - 1, decoded));
+    TEST_ASSERT_TRUE(decodeSensorFrame(buffer, sizeof(buffer), decoded)); // appended fields are ignored
+    buffer[0] = SENSOR_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(decodeSensorFrame(buffer, sizeof(buffer), decoded));
+}
+
+// Random frames round trip, random bytes of any length never crash the decoder or read past their end
+void test_frame_fuzz() {
+    std::mt19937 random(21);
+    std::uniform_real_distribution<float> channel(-30.0f, 30.0f);
+    for (int i = 0; i < FUZZ_ROUNDS; i++) {
+        SensorFrame frame{};
+        frame.sequence = static_cast<uint16_t>(random());
+        frame.timestamp = random();
+        frame.temperature = channel(random) + 60.0f;
+        frame.pressure = channel(random);
+        frame.puckFlow = channel(random);
+        frame.pumpFlow = channel(random);
+        frame.puckResistance = std::fabs(channel(random)) * 1000.0f;
+        frame.controlSequence = static_cast<uint16_t>(random());
+        frame.controlTimestamp = frame.timestamp - random() % 30000;
+        uint8_t buffer[SENSOR_FRAME_SIZE];
+        encodeSensorFrame(frame, buffer, sizeof(buffer));
+        SensorFrame decoded{};
+        TEST_ASSERT_TRUE(decodeSensorFrame(buffer, sizeof(buffer), decoded));
+        TEST_ASSERT_EQUAL(frame.sequence, decoded.sequence);
+        TEST_ASSERT_EQUAL(frame.controlTimestamp, decoded.controlTimestamp);
+        assertChannels(frame, decoded);
+
+        std::vector<uint8_t> noise(random() % (SENSOR_FRAME_SIZE + 8));
+        for (uint8_t &byte : noise) {
+            byte = static_cast<uint8_t>(random());
+        }
+        if (!noise.empty() && random() % 2 == 0) {
+            noise[0] = SENSOR_FRAME_VERSION;
+        }
+        bool accepted = decodeSensorFrame(noise.data(), noise.size(), decoded);
+        TEST_ASSERT_EQUAL(noise.size() >= SENSOR_FRAME_MIN_SIZE && noise[0] == SENSOR_FRAME_VERSION, accepted);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_frame_saturates_and_keeps_nan);
+    RUN_TEST(test_frame_without_control_echo);
+    RUN_TEST(test_frame_rejects_malformed_input);
+    RUN_TEST(test_frame_fuzz);
+    return UNITY_END();
+}
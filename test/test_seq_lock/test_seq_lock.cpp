@@ -0,0 +1,123 @@
+#include <display/core/SeqLock.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+constexpr int STRESS_READERS = 3;
+constexpr auto STRESS_DURATION = std::chrono::milliseconds(500);
+
+// Every field derives from the generation, so a copy mixing two stores cannot pass check()
+struct Snapshot {
+    uint32_t generation;
+    float temperature;
+    float pressure;
+    uint16_t flow;
+    uint8_t mode;
+    bool active;
+    double weight;
+};
+
+Snapshot makeSnapshot(uint32_t generation) {
+    return Snapshot{generation,
+                    generation * 0.5f,
+                    generation * 0.25f,
+                    static_cast<uint16_t>(generation * 3),
+                    static_cast<uint8_t>(generation % 5),
+                    (generation & 1) != 0,
+                    generation * 0.125};
+}
+
+bool check(const Snapshot &snapshot) {
+    Snapshot expected = makeSnapshot(snapshot.generation);
+    return snapshot.temperature == expected.temperature && snapshot.pressure == expected.pressure &&
+           snapshot.flow == expected.flow && snapshot.mode == expected.mode && snapshot.active == expected.active &&
+           snapshot.weight == expected.weight;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_starts_value_initialized() {
+    SeqLock<Snapshot> lock;
+    Snapshot snapshot = lock.load();
+    TEST_ASSERT_EQUAL(0, snapshot.generation);
+    TEST_ASSERT_TRUE(check(snapshot));
+    TEST_ASSERT_EQUAL(1, lock.version()); // the constructor stores once
+}
+
+void test_load_returns_last_store() {
+    SeqLock<Snapshot> lock;
+    uint32_t before = lock.version();
+    lock.store(makeSnapshot(41));
+    lock.store(makeSnapshot(42));
+    TEST_ASSERT_EQUAL(42, lock.load().generation);
+    TEST_ASSERT_TRUE(check(lock.load()));
+    TEST_ASSERT_EQUAL(before + 2, lock.version());
+}
+
+// One writer storing as fast as it can, several readers copying concurrently: no reader may see a torn value or go
+// back in time
+void test_concurrent_readers_never_see_torn_values() {
+    SeqLock<Snapshot> lock;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> backwards{0};
+    std::atomic<uint64_t> loads{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        readers.emplace_back([&] {
+            uint32_t last = 0;
+            uint64_t count = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                Snapshot snapshot = lock.load();
+                if (!check(snapshot)) {
+                    torn++;
+                }
+                if (snapshot.generation < last) {
+                    backwards++;
+                }
+                last = snapshot.generation;
+                count++;
+            }
+            loads += count;
+        });
+    }
+
+    uint32_t generation = 0;
+    auto end = std::chrono::steady_clock::now() + STRESS_DURATION;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 1000; i++) {
+            lock.store(makeSnapshot(++generation));
+        }
+    }
+    done.store(true);
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u stores, %llu loads across %d readers", static_cast<unsigned>(generation),
+             static_cast<unsigned long long>(loads.load()), STRESS_READERS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+    TEST_ASSERT_EQUAL(generation, lock.load().generation);
+    TEST_ASSERT_GREATER_THAN(0, loads.load());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_value_initialized);
+    RUN_TEST(test_load_returns_last_store);
+    RUN_TEST(test_concurrent_readers_never_see_torn_values);
+    return UNITY_END();
+}
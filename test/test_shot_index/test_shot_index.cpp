@@ -0,0 +1,257 @@
+#include <display/models/shot_index.h>
+
+#include <FS.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t BENCHMARK_ENTRIES = 1000; // a couple of years of daily shots
+constexpr int BENCHMARK_LOOKUPS = 100000;
+
+ShotIndexEntry makeEntry(uint32_t id, uint8_t flags = SHOT_FLAG_COMPLETED) {
+    ShotIndexEntry entry{};
+    entry.id = id;
+    entry.timestamp = 1700000000 + id * 3600;
+    entry.flags = flags;
+    snprintf(entry.profileName, sizeof(entry.profileName), "Profile %u", static_cast<unsigned>(id % 7));
+    return entry;
+}
+
+// What every lookup did before the cache: walk index.bin until the id turns up
+int scanIndexFile(File &indexFile, uint32_t id) {
+    indexFile.seek(SHOT_INDEX_HEADER_SIZE, SeekSet);
+    ShotIndexEntry entry;
+    for (int slot = 0; indexFile.read(reinterpret_cast<uint8_t *>(&entry), sizeof(entry)) == sizeof(entry); slot++) {
+        if (entry.id == id) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+ShotIndexHeader makeHeader(uint32_t entryCount, uint32_t generation) {
+    ShotIndexHeader header{};
+    header.magic = SHOT_INDEX_MAGIC;
+    header.version = SHOT_INDEX_VERSION;
+    header.entrySize = SHOT_INDEX_ENTRY_SIZE;
+    header.entryCount = entryCount;
+    header.nextId = entryCount + 1;
+    header.generation = generation;
+    return header;
+}
+
+// index.bin holding shots 1..count
+std::shared_ptr<std::vector<uint8_t>> makeIndexFile(uint32_t count) {
+    auto contents = std::make_shared<std::vector<uint8_t>>();
+    File indexFile(contents);
+    ShotIndexHeader header = makeHeader(count, count);
+    indexFile.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+    for (uint32_t id = 1; id <= count; id++) {
+        ShotIndexEntry entry = makeEntry(id);
+        indexFile.write(reinterpret_cast<const uint8_t *>(&entry), sizeof(entry));
+    }
+    return contents;
+}
+
+void appendRecord(std::vector<uint8_t> &journal, const ShotIndexJournalRecord &record) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&record);
+    journal.insert(journal.end(), bytes, bytes + sizeof(record));
+}
+
+ShotIndexEntry entryAt(const std::vector<uint8_t> &index, uint32_t slot) {
+    ShotIndexEntry entry;
+    memcpy(&entry, index.data() + SHOT_INDEX_HEADER_SIZE + slot * SHOT_INDEX_ENTRY_SIZE, sizeof(entry));
+    return entry;
+}
+
+ShotIndexHeader headerOf(const std::vector<uint8_t> &index) {
+    ShotIndexHeader header;
+    memcpy(&header, index.data(), sizeof(header));
+    return header;
+}
+
+uint32_t replay(const std::shared_ptr<std::vector<uint8_t>> &journal, const std::shared_ptr<std::vector<uint8_t>> &index) {
+    File journalFile(journal);
+    File indexFile(index);
+    return shot_index::replayJournal(journalFile, indexFile);
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_insert_and_find() {
+    ShotIndexCache<> cache;
+    for (uint32_t id = 1; id <= 50; id++) {
+        TEST_ASSERT_EQUAL(static_cast<int>(id - 1), cache.insert(makeEntry(id)));
+    }
+    TEST_ASSERT_EQUAL(50, cache.size());
+    TEST_ASSERT_EQUAL(24, cache.find(25));
+    TEST_ASSERT_EQUAL(25, cache[cache.find(25)].id);
+    TEST_ASSERT_EQUAL(-1, cache.find(51));
+}
+
+void test_live_duplicate_is_rejected_and_deleted_slot_recycled() {
+    ShotIndexCache<> cache;
+    cache.insert(makeEntry(1));
+    cache.insert(makeEntry(2));
+    TEST_ASSERT_EQUAL(-1, cache.insert(makeEntry(2)));
+
+    cache[1].flags |= SHOT_FLAG_DELETED;
+    ShotIndexEntry reused = makeEntry(2, 0);
+    TEST_ASSERT_EQUAL(1, cache.insert(reused));
+    TEST_ASSERT_EQUAL(2, cache.size());
+    TEST_ASSERT_EQUAL(0, cache[1].flags);
+}
+
+// Layouts older firmware could leave behind: the same id appended twice, live or after a deletion
+void test_reindex_retires_duplicates() {
+    ShotIndexCache<> cache;
+    ShotIndexEntry *entries = cache.prepare(6);
+    entries[0] = makeEntry(1);
+    entries[1] = makeEntry(2, SHOT_FLAG_DELETED);
+    entries[2] = makeEntry(1);
+    entries[3] = makeEntry(2);
+    entries[4] = makeEntry(3);
+    entries[5] = makeEntry(2);
+
+    std::vector<uint32_t> retired = cache.reindex();
+    TEST_ASSERT_EQUAL(2, retired.size());
+    TEST_ASSERT_EQUAL(2, retired[0]);
+    TEST_ASSERT_EQUAL(5, retired[1]);
+    TEST_ASSERT_TRUE(cache[2].flags & SHOT_FLAG_DELETED);
+    TEST_ASSERT_TRUE(cache[5].flags & SHOT_FLAG_DELETED);
+    TEST_ASSERT_EQUAL(0, cache.find(1));
+    TEST_ASSERT_EQUAL(3, cache.find(2)); // the live copy wins over the deleted one before it
+    TEST_ASSERT_EQUAL(4, cache.find(3));
+}
+
+void test_benchmark_lookup() {
+    ShotIndexCache<> cache;
+    auto contents = std::make_shared<std::vector<uint8_t>>(SHOT_INDEX_HEADER_SIZE, 0);
+    File indexFile(contents);
+    indexFile.seek(SHOT_INDEX_HEADER_SIZE, SeekSet);
+    for (uint32_t id = 1; id <= BENCHMARK_ENTRIES; id++) {
+        ShotIndexEntry entry = makeEntry(id);
+        cache.insert(entry);
+        indexFile.write(reinterpret_cast<const uint8_t *>(&entry), sizeof(entry));
+    }
+    std::mt19937 random(5);
+    std::vector<uint32_t> ids(BENCHMARK_LOOKUPS);
+    for (uint32_t &id : ids) {
+        id = 1 + random() % BENCHMARK_ENTRIES;
+    }
+
+    int64_t cachedSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t id : ids) {
+        cachedSum += cache.find(id);
+    }
+    std::chrono::duration<double, std::nano> cached = std::chrono::steady_clock::now() - start;
+
+    // The scan is slow enough that a hundredth of the lookups gives a stable figure
+    int64_t scannedSum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_LOOKUPS / 100; i++) {
+        scannedSum += scanIndexFile(indexFile, ids[i]);
+    }
+    std::chrono::duration<double, std::nano> scanned = std::chrono::steady_clock::now() - start;
+
+    char message[160];
+    snprintf(message, sizeof(message), "%u entries: %.0f ns per cached lookup, %.0f ns per file scan from RAM", BENCHMARK_ENTRIES,
+             cached.count() / BENCHMARK_LOOKUPS, scanned.count() / (BENCHMARK_LOOKUPS / 100));
+    TEST_MESSAGE(message);
+    int64_t expectedCached = 0;
+    int64_t expectedScanned = 0;
+    for (int i = 0; i < BENCHMARK_LOOKUPS; i++) {
+        expectedCached += ids[i] - 1; // ids were inserted in order, so id n sits in slot n - 1
+        expectedScanned += i < BENCHMARK_LOOKUPS / 100 ? ids[i] - 1 : 0;
+    }
+    TEST_ASSERT_EQUAL_INT64(expectedCached, cachedSum);
+    TEST_ASSERT_EQUAL_INT64(expectedScanned, scannedSum);
+}
+
+// Power lost after journaling an update and an append, before either reached index.bin
+void test_journal_replay_applies_lost_writes() {
+    auto index = makeIndexFile(3);
+    auto journal = std::make_shared<std::vector<uint8_t>>();
+    ShotIndexEntry rated = makeEntry(2);
+    rated.rating = 4;
+    appendRecord(*journal, shot_index::makeJournalRecord(1, makeHeader(3, 3), rated));
+    appendRecord(*journal, shot_index::makeJournalRecord(3, makeHeader(4, 4), makeEntry(4, 0)));
+
+    TEST_ASSERT_EQUAL(2, replay(journal, index));
+    TEST_ASSERT_EQUAL(SHOT_INDEX_HEADER_SIZE + 4 * SHOT_INDEX_ENTRY_SIZE, index->size());
+    TEST_ASSERT_EQUAL(4, headerOf(*index).entryCount);
+    TEST_ASSERT_EQUAL(4, headerOf(*index).generation);
+    TEST_ASSERT_EQUAL(4, entryAt(*index, 1).rating);
+    TEST_ASSERT_EQUAL(4, entryAt(*index, 3).id);
+    TEST_ASSERT_EQUAL(0, entryAt(*index, 3).flags);
+    TEST_ASSERT_EQUAL(1, entryAt(*index, 0).id);
+}
+
+// The records describe the final state of their slot, so a journal that was partly applied already replays the same
+void test_journal_replay_is_idempotent() {
+    auto journal = std::make_shared<std::vector<uint8_t>>();
+    ShotIndexEntry deleted = makeEntry(1, SHOT_FLAG_COMPLETED | SHOT_FLAG_DELETED);
+    appendRecord(*journal, shot_index::makeJournalRecord(0, makeHeader(2, 3), deleted));
+    appendRecord(*journal, shot_index::makeJournalRecord(1, makeHeader(2, 4), makeEntry(2, SHOT_FLAG_HAS_NOTES)));
+
+    auto once = makeIndexFile(2);
+    replay(journal, once);
+    auto twice = makeIndexFile(2);
+    replay(journal, twice);
+    replay(journal, twice);
+    TEST_ASSERT_TRUE(*once == *twice);
+}
+
+void test_journal_replay_stops_at_torn_record() {
+    auto index = makeIndexFile(3);
+    const std::vector<uint8_t> original = *index;
+    auto journal = std::make_shared<std::vector<uint8_t>>();
+    ShotIndexEntry rated = makeEntry(1);
+    rated.rating = 5;
+    appendRecord(*journal, shot_index::makeJournalRecord(0, makeHeader(3, 4), rated));
+    ShotIndexJournalRecord corrupt = shot_index::makeJournalRecord(1, makeHeader(3, 5), makeEntry(2, SHOT_FLAG_DELETED));
+    corrupt.entry.rating = 3; // changed after the CRC was taken, like a write that never completed
+    appendRecord(*journal, corrupt);
+    appendRecord(*journal, shot_index::makeJournalRecord(2, makeHeader(3, 6), makeEntry(3, SHOT_FLAG_DELETED)));
+
+    TEST_ASSERT_EQUAL(1, replay(journal, index));
+    TEST_ASSERT_EQUAL(5, entryAt(*index, 0).rating);
+    TEST_ASSERT_EQUAL(4, headerOf(*index).generation);
+    TEST_ASSERT_EQUAL_MEMORY(original.data() + SHOT_INDEX_HEADER_SIZE + SHOT_INDEX_ENTRY_SIZE,
+                             index->data() + SHOT_INDEX_HEADER_SIZE + SHOT_INDEX_ENTRY_SIZE, 2 * SHOT_INDEX_ENTRY_SIZE);
+
+    // A record cut off by the reset is not even read
+    auto truncated = std::make_shared<std::vector<uint8_t>>(journal->begin(), journal->begin() + sizeof(corrupt) / 2);
+    TEST_ASSERT_EQUAL(0, replay(truncated, index));
+}
+
+void test_journal_replay_rejects_slot_beyond_header() {
+    auto index = makeIndexFile(2);
+    const std::vector<uint8_t> original = *index;
+    auto journal = std::make_shared<std::vector<uint8_t>>();
+    appendRecord(*journal, shot_index::makeJournalRecord(5, makeHeader(2, 3), makeEntry(6)));
+    TEST_ASSERT_EQUAL(0, replay(journal, index));
+    TEST_ASSERT_TRUE(*index == original);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_insert_and_find);
+    RUN_TEST(test_live_duplicate_is_rejected_and_deleted_slot_recycled);
+    RUN_TEST(test_reindex_retires_duplicates);
+    RUN_TEST(test_benchmark_lookup);
+    RUN_TEST(test_journal_replay_applies_lost_writes);
+    RUN_TEST(test_journal_replay_is_idempotent);
+    RUN_TEST(test_journal_replay_stops_at_torn_record);
+    RUN_TEST(test_journal_replay_rejects_slot_beyond_header);
+    return UNITY_END();
+}
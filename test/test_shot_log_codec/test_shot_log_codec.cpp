@@ -0,0 +1,194 @@
+#include <display/models/shot_log_codec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+// A 40 s shot at 4 Hz: preinfusion, ramp and a pressure profile with sensor noise
+std::vector<ShotLogSample> makeShot(uint32_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> noise(-2, 2);
+    std::vector<ShotLogSample> samples;
+    for (uint32_t i = 0; i < count; i++) {
+        ShotLogSample sample{};
+        sample.t = static_cast<uint16_t>(i);
+        sample.tt = 930;
+        sample.ct = static_cast<uint16_t>(925 + noise(random));
+        sample.tp = i < 32 ? 30 : 90;
+        sample.cp = static_cast<uint16_t>(std::min<uint32_t>(sample.tp, i * 3) + noise(random));
+        sample.fl = static_cast<int16_t>(i < 32 ? 400 : 180 + noise(random) * 5);
+        sample.tf = 0;
+        sample.pf = static_cast<int16_t>(sample.fl - 30 + noise(random));
+        sample.vf = static_cast<int16_t>(i < 40 ? 0 : 190 + noise(random) * 3);
+        sample.v = static_cast<uint16_t>(i < 40 ? 0 : (i - 40) * 5);
+        sample.ev = sample.v;
+        sample.pr = static_cast<uint16_t>(i * 7);
+        sample.si = SYSTEM_INFO_SHOT_STARTED_VOLUMETRIC;
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+std::vector<uint8_t> encode(const std::vector<ShotLogSample> &samples, uint16_t keyframeInterval) {
+    std::vector<uint8_t> stream;
+    ShotLogEncoder encoder(keyframeInterval);
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (encoder.push(samples[i]) || (i + 1 == samples.size() && encoder.finish())) {
+            stream.insert(stream.end(), encoder.data(), encoder.data() + encoder.size());
+        }
+    }
+    return stream;
+}
+
+// Decodes every block of the stream, stops at the first malformed one
+bool decode(const std::vector<uint8_t> &stream, std::vector<ShotLogSample> &samples) {
+    samples.clear();
+    size_t offset = 0;
+    while (offset + SHOT_LOG_BLOCK_HEADER_SIZE <= stream.size()) {
+        uint16_t payloadLength;
+        uint8_t sampleCount;
+        if (!ShotLogDecoder::readBlockHeader(stream.data() + offset, payloadLength, sampleCount) ||
+            offset + SHOT_LOG_BLOCK_HEADER_SIZE + payloadLength > stream.size()) {
+            return false;
+        }
+        ShotLogDecoder decoder;
+        decoder.begin(stream.data() + offset + SHOT_LOG_BLOCK_HEADER_SIZE, payloadLength, sampleCount);
+        ShotLogSample sample;
+        while (decoder.next(sample)) {
+            samples.push_back(sample);
+        }
+        if (decoder.failed() || !decoder.done()) {
+            return false;
+        }
+        offset += SHOT_LOG_BLOCK_HEADER_SIZE + payloadLength;
+    }
+    return offset == stream.size();
+}
+
+bool equal(const ShotLogSample &a, const ShotLogSample &b) { return memcmp(&a, &b, sizeof(ShotLogSample)) == 0; }
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_zigzag_round_trip() {
+    TEST_ASSERT_EQUAL_UINT16(0, shot_log::zigzag(0));
+    TEST_ASSERT_EQUAL_UINT16(1, shot_log::zigzag(-1));
+    TEST_ASSERT_EQUAL_UINT16(2, shot_log::zigzag(1));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, shot_log::zigzag(INT16_MIN));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFE, shot_log::zigzag(INT16_MAX));
+    for (int32_t value = INT16_MIN; value <= INT16_MAX; value++) {
+        TEST_ASSERT_EQUAL_INT16(value, shot_log::unzigzag(shot_log::zigzag(static_cast<int16_t>(value))));
+    }
+}
+
+void test_varint_round_trip() {
+    const uint32_t values[] = {0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, 0xFFFF, 0x1FFFFF, 0xFFFFFFFF};
+    for (uint32_t value : values) {
+        uint8_t buffer[5];
+        size_t length = shot_log::putVarint(buffer, value);
+        const uint8_t *p = buffer;
+        uint32_t decoded;
+        TEST_ASSERT_TRUE(shot_log::getVarint(p, buffer + length, decoded));
+        TEST_ASSERT_EQUAL_UINT32(value, decoded);
+        TEST_ASSERT_EQUAL_PTR(buffer + length, p);
+    }
+    const uint8_t truncated[] = {0x80, 0x80};
+    const uint8_t *p = truncated;
+    uint32_t decoded;
+    TEST_ASSERT_FALSE(shot_log::getVarint(p, truncated + sizeof(truncated), decoded));
+}
+
+void test_shot_round_trip() {
+    const uint16_t intervals[] = {1, 7, SHOT_LOG_KEYFRAME_INTERVAL, SHOT_LOG_MAX_KEYFRAME_INTERVAL};
+    std::vector<ShotLogSample> samples = makeShot(163, 1);
+    for (uint16_t interval : intervals) {
+        std::vector<ShotLogSample> decoded;
+        TEST_ASSERT_TRUE(decode(encode(samples, interval), decoded));
+        TEST_ASSERT_EQUAL(samples.size(), decoded.size());
+        for (size_t i = 0; i < samples.size(); i++) {
+            TEST_ASSERT_TRUE(equal(samples[i], decoded[i]));
+        }
+    }
+}
+
+// Deltas wrap modulo 2^16, so any pair of values has to survive, including jumps across the whole range
+void test_extreme_values_round_trip() {
+    std::mt19937 random(7);
+    std::vector<ShotLogSample> samples;
+    for (uint16_t i = 0; i < 500; i++) {
+        uint16_t fields[SHOT_LOG_FIELD_COUNT];
+        for (uint16_t &field : fields) {
+            switch (random() % 4) {
+            case 0:
+                field = 0;
+                break;
+            case 1:
+                field = 0xFFFF;
+                break;
+            case 2:
+                field = 0x8000;
+                break;
+            default:
+                field = static_cast<uint16_t>(random());
+            }
+        }
+        ShotLogSample sample;
+        shot_log::fromFields(fields, sample);
+        samples.push_back(sample);
+    }
+    std::vector<ShotLogSample> decoded;
+    TEST_ASSERT_TRUE(decode(encode(samples, SHOT_LOG_KEYFRAME_INTERVAL), decoded));
+    TEST_ASSERT_EQUAL(samples.size(), decoded.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        TEST_ASSERT_TRUE(equal(samples[i], decoded[i]));
+    }
+}
+
+void test_corrupt_block_is_rejected() {
+    std::vector<uint8_t> stream = encode(makeShot(40, 3), SHOT_LOG_KEYFRAME_INTERVAL);
+    std::vector<ShotLogSample> decoded;
+
+    std::vector<uint8_t> truncated(stream.begin(), stream.end() - 1);
+    TEST_ASSERT_FALSE(decode(truncated, decoded));
+
+    std::vector<uint8_t> badMask = stream;
+    badMask[SHOT_LOG_BLOCK_HEADER_SIZE] = 0xFF; // continuation bits into a mask wider than the sample
+    badMask[SHOT_LOG_BLOCK_HEADER_SIZE + 1] = 0xFF;
+    TEST_ASSERT_FALSE(decode(badMask, decoded));
+
+    std::vector<uint8_t> noSamples = stream;
+    noSamples[2] = 0;
+    TEST_ASSERT_FALSE(decode(noSamples, decoded));
+}
+
+void test_compression_ratio() {
+    std::vector<ShotLogSample> samples = makeShot(160, 11);
+    size_t raw = samples.size() * SHOT_LOG_SAMPLE_SIZE;
+    size_t encoded = encode(samples, SHOT_LOG_KEYFRAME_INTERVAL).size();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u samples: %u bytes raw, %u bytes encoded (%.1fx)",
+             static_cast<unsigned>(samples.size()), static_cast<unsigned>(raw), static_cast<unsigned>(encoded),
+             static_cast<double>(raw) / encoded);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(raw / 2, encoded); // noisy sensors on every channel, real shots do better
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_zigzag_round_trip);
+    RUN_TEST(test_varint_round_trip);
+    RUN_TEST(test_shot_round_trip);
+    RUN_TEST(test_extreme_values_round_trip);
+    RUN_TEST(test_corrupt_block_is_rejected);
+    RUN_TEST(test_compression_ratio);
+    return UNITY_END();
+}
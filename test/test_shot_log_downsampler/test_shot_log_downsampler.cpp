@@ -0,0 +1,198 @@
+#include <display/models/shot_log_downsampler.h>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t SAMPLE_INTERVAL_MS = 250;
+
+ShotLogSample makeSample(uint16_t tick) {
+    ShotLogSample sample{};
+    sample.t = tick;
+    sample.tt = 930;
+    sample.ct = static_cast<uint16_t>(900 + 30 * std::sin(tick * 0.05));
+    sample.tp = tick < 40 ? 30 : 90;
+    sample.cp = static_cast<uint16_t>(sample.tp + 5 * std::sin(tick * 0.31));
+    sample.fl = static_cast<int16_t>(200 + 150 * std::sin(tick * 0.11));
+    sample.pf = static_cast<int16_t>(sample.fl - 20);
+    sample.v = static_cast<uint16_t>(tick * 2);
+    return sample;
+}
+
+std::vector<ShotLogSample> makeShot(uint32_t count) {
+    std::vector<ShotLogSample> samples;
+    for (uint32_t i = 0; i < count; i++) {
+        samples.push_back(makeSample(static_cast<uint16_t>(i)));
+    }
+    return samples;
+}
+
+// Writes a v6 file the way the shot history writer does: header, then encoded blocks
+std::shared_ptr<std::vector<uint8_t>> encodeShot(const std::vector<ShotLogSample> &samples) {
+    auto contents = std::make_shared<std::vector<uint8_t>>();
+    ShotLogHeader header{};
+    header.magic = SHOT_LOG_MAGIC;
+    header.version = SHOT_LOG_VERSION;
+    header.headerSize = SHOT_LOG_HEADER_SIZE;
+    header.sampleInterval = SAMPLE_INTERVAL_MS;
+    header.reserved1 = SHOT_LOG_KEYFRAME_INTERVAL;
+    header.sampleCount = samples.size();
+    const auto *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+    contents->insert(contents->end(), headerBytes, headerBytes + sizeof(header));
+    ShotLogEncoder encoder;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (encoder.push(samples[i]) || (i + 1 == samples.size() && encoder.finish())) {
+            contents->insert(contents->end(), encoder.data(), encoder.data() + encoder.size());
+        }
+    }
+    return contents;
+}
+
+std::string downsample(const std::shared_ptr<std::vector<uint8_t>> &contents, uint16_t points, const char *fields,
+                       size_t chunkSize) {
+    auto curve = std::unique_ptr<ShotLogDownsampler>(new ShotLogDownsampler());
+    if (!curve->begin(File(contents), File(contents), "000042", points, fields)) {
+        return "";
+    }
+    std::string document;
+    std::vector<uint8_t> chunk(chunkSize);
+    while (size_t length = curve->read(chunk.data(), chunk.size())) {
+        document.append(reinterpret_cast<const char *>(chunk.data()), length);
+    }
+    return document;
+}
+
+// Times in ms of the points of a document
+std::vector<uint32_t> pointTimes(const std::string &document) {
+    std::vector<uint32_t> times;
+    size_t position = document.find("\"points\":[") + strlen("\"points\":");
+    while ((position = document.find('[', position + 1)) != std::string::npos) {
+        times.push_back(std::stoul(document.substr(position + 1)));
+    }
+    return times;
+}
+
+// Plain in-memory LTTB over the selected values, the reference the streamed version has to match
+std::vector<uint32_t> referenceTimes(const std::vector<ShotLogSample> &samples, uint16_t points) {
+    auto values = [](const ShotLogSample &sample) { return std::vector<float>{float(sample.cp), float(sample.fl)}; };
+    std::vector<float> minValue = values(samples[0]);
+    std::vector<float> maxValue = minValue;
+    for (const ShotLogSample &sample : samples) {
+        std::vector<float> current = values(sample);
+        for (size_t f = 0; f < current.size(); f++) {
+            minValue[f] = std::min(minValue[f], current[f]);
+            maxValue[f] = std::max(maxValue[f], current[f]);
+        }
+    }
+    std::vector<uint32_t> times{0};
+    const uint32_t total = samples.size();
+    const float every = static_cast<float>(total - 2) / (points - 2);
+    ShotLogSample anchor = samples[0];
+    for (uint32_t bucket = 0; bucket < static_cast<uint32_t>(points - 2); bucket++) {
+        uint32_t averageStart = static_cast<uint32_t>((bucket + 1) * every) + 1;
+        uint32_t averageEnd = std::min<uint32_t>(static_cast<uint32_t>((bucket + 2) * every) + 1, total);
+        float averageTick = 0.0f;
+        std::vector<float> average(2, 0.0f);
+        for (uint32_t i = averageStart; i < averageEnd; i++) {
+            averageTick += samples[i].t;
+            for (size_t f = 0; f < 2; f++) {
+                average[f] += values(samples[i])[f];
+            }
+        }
+        if (averageEnd > averageStart) {
+            averageTick /= averageEnd - averageStart;
+            for (float &value : average) {
+                value /= averageEnd - averageStart;
+            }
+        }
+        float bestArea = -1.0f;
+        ShotLogSample best{};
+        uint32_t bucketEnd = static_cast<uint32_t>((bucket + 1) * every) + 1;
+        for (uint32_t i = static_cast<uint32_t>(bucket * every) + 1; i < bucketEnd; i++) {
+            float area = 0.0f;
+            for (size_t f = 0; f < 2; f++) {
+                float range = maxValue[f] > minValue[f] ? maxValue[f] - minValue[f] : 1.0f;
+                float anchorValue = values(anchor)[f];
+                area += std::fabs((float(anchor.t) - averageTick) * (values(samples[i])[f] - anchorValue) -
+                                  (float(anchor.t) - samples[i].t) * (average[f] - anchorValue)) /
+                        range;
+            }
+            if (area > bestArea) {
+                bestArea = area;
+                best = samples[i];
+            }
+        }
+        times.push_back(best.t * SAMPLE_INTERVAL_MS);
+        anchor = best;
+    }
+    times.push_back(samples.back().t * SAMPLE_INTERVAL_MS);
+    return times;
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_short_shot_is_passed_through() {
+    auto samples = makeShot(20);
+    std::string document = downsample(encodeShot(samples), 100, "cp,v", 4096);
+    const std::string prefix =
+        "{\"id\":\"000042\",\"interval\":250,\"samples\":20,\"fields\":[\"t\",\"cp\",\"v\"],\"points\":[[0,3.0,0.0],[250,";
+    TEST_ASSERT_EQUAL_STRING(prefix.c_str(), document.substr(0, prefix.size()).c_str());
+    TEST_ASSERT_EQUAL(20, pointTimes(document).size());
+    TEST_ASSERT_EQUAL('}', document.back());
+}
+
+void test_matches_reference_lttb() {
+    auto samples = makeShot(1237);
+    std::vector<uint32_t> times = pointTimes(downsample(encodeShot(samples), 150, "cp,fl", 4096));
+    std::vector<uint32_t> expected = referenceTimes(samples, 150);
+    TEST_ASSERT_EQUAL(150, times.size());
+    TEST_ASSERT_TRUE(times == expected);
+}
+
+void test_output_does_not_depend_on_chunk_size() {
+    auto contents = encodeShot(makeShot(900));
+    std::string whole = downsample(contents, 200, "", 65536);
+    TEST_ASSERT_TRUE(whole == downsample(contents, 200, "", 1));
+    TEST_ASSERT_TRUE(whole == downsample(contents, 200, "", 1436));
+}
+
+void test_missing_file_is_rejected() {
+    ShotLogDownsampler curve;
+    TEST_ASSERT_FALSE(curve.begin(File(), File(), "000001", 100, ""));
+    auto empty = std::make_shared<std::vector<uint8_t>>(16, 0);
+    TEST_ASSERT_FALSE(curve.begin(File(empty), File(empty), "000001", 100, ""));
+}
+
+void test_benchmark_downsampling() {
+    constexpr int runs = 20;
+    auto contents = encodeShot(makeShot(12000)); // 50 minutes at 4 Hz, far beyond any real shot
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        bytes = downsample(contents, 500, "", 1436).size();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    char message[128];
+    snprintf(message, sizeof(message), "12000 samples to 500 points, all fields: %.0f us per curve, %u bytes",
+             elapsed.count() / runs, static_cast<unsigned>(bytes));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0, bytes);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_short_shot_is_passed_through);
+    RUN_TEST(test_matches_reference_lttb);
+    RUN_TEST(test_output_does_not_depend_on_chunk_size);
+    RUN_TEST(test_missing_file_is_rejected);
+    RUN_TEST(test_benchmark_downsampling);
+    return UNITY_END();
+}
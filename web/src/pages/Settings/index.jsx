@@ -401,6 +401,130 @@ export function Settings() {
                 />
               </label>
             </div>
+
+            <div className='divider'>Shot history</div>
+            <div className='form-control'>
+              <label htmlFor='historySampleInterval' className='mb-2 block text-sm font-medium'>
+                Recording rate
+              </label>
+              <div className='mb-2 text-xs opacity-70'>
+                Higher rates capture fast pressure changes but produce larger shot logs.
+              </div>
+              <select
+                id='historySampleInterval'
+                name='historySampleInterval'
+                className='select select-bordered w-full'
+                value={
+                  formData.historySampleInterval !== undefined ? formData.historySampleInterval : 250
+                }
+                onChange={onChange('historySampleInterval')}
+              >
+                <option value={250}>4 Hz</option>
+                <option value={100}>10 Hz</option>
+                <option value={0}>Every sensor update</option>
+              </select>
+            </div>
+
+            <div className='mt-2 text-xs opacity-70'>
+              Oldest shots are removed once any limit is exceeded. Use 0 to disable a limit; storage
+              is never filled beyond 90%.
+            </div>
+            <div className='mt-2 text-sm font-medium'>Internal storage</div>
+            <div className='grid grid-cols-3 gap-4'>
+              <div className='form-control'>
+                <label htmlFor='historyRetentionCount' className='mb-2 block text-sm font-medium'>
+                  Shots
+                </label>
+                <input
+                  id='historyRetentionCount'
+                  name='historyRetentionCount'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historyRetentionCount}
+                  onChange={onChange('historyRetentionCount')}
+                />
+              </div>
+              <div className='form-control'>
+                <label htmlFor='historyRetentionSize' className='mb-2 block text-sm font-medium'>
+                  Size (KB)
+                </label>
+                <input
+                  id='historyRetentionSize'
+                  name='historyRetentionSize'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historyRetentionSize}
+                  onChange={onChange('historyRetentionSize')}
+                />
+              </div>
+              <div className='form-control'>
+                <label htmlFor='historyRetentionDays' className='mb-2 block text-sm font-medium'>
+                  Age (days)
+                </label>
+                <input
+                  id='historyRetentionDays'
+                  name='historyRetentionDays'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historyRetentionDays}
+                  onChange={onChange('historyRetentionDays')}
+                />
+              </div>
+            </div>
+            <div className='mt-2 text-sm font-medium'>SD card</div>
+            <div className='grid grid-cols-3 gap-4'>
+              <div className='form-control'>
+                <label htmlFor='historySdRetentionCount' className='mb-2 block text-sm font-medium'>
+                  Shots
+                </label>
+                <input
+                  id='historySdRetentionCount'
+                  name='historySdRetentionCount'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historySdRetentionCount}
+                  onChange={onChange('historySdRetentionCount')}
+                />
+              </div>
+              <div className='form-control'>
+                <label htmlFor='historySdRetentionSize' className='mb-2 block text-sm font-medium'>
+                  Size (KB)
+                </label>
+                <input
+                  id='historySdRetentionSize'
+                  name='historySdRetentionSize'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historySdRetentionSize}
+                  onChange={onChange('historySdRetentionSize')}
+                />
+              </div>
+              <div className='form-control'>
+                <label htmlFor='historySdRetentionDays' className='mb-2 block text-sm font-medium'>
+                  Age (days)
+                </label>
+                <input
+                  id='historySdRetentionDays'
+                  name='historySdRetentionDays'
+                  type='number'
+                  min='0'
+                  className='input input-bordered w-full'
+                  placeholder='0'
+                  value={formData.historySdRetentionDays}
+                  onChange={onChange('historySdRetentionDays')}
+                />
+              </div>
+            </div>
           </Card>
 
           <Card sm={10} lg={5} title='Web Settings'>
@@ -50,7 +50,7 @@ function getChartData(shot) {
   if (shot.version >= 5 && shot.phaseTransitions) {
     // Use phase transitions directly from header
     phaseTransitions = shot.phaseTransitions.map(t => ({
-      time: (t.sampleIndex * (shot.sampleInterval || 250)) / 1000.0,
+      time: t.t / 1000.0,
       phaseNumber: t.phaseNumber,
       phaseDisplayNumber: t.phaseNumber + 1,
       phaseName: t.phaseName,
@@ -9,8 +9,26 @@ const INDEX_MAGIC = 0x58444953; // 'SIDX'
 const SHOT_FLAG_COMPLETED = 0x01;
 const SHOT_FLAG_DELETED = 0x02;
 const SHOT_FLAG_HAS_NOTES = 0x04;
+const SHOT_FLAG_HAS_SUMMARY = 0x08;
 
 const WEIGHT_SCALE = 10;
+const PRESSURE_SCALE = 10;
+const TEMP_SCALE = 10;
+const FLOW_SCALE = 100;
+
+// ShotSummary, stored at offset 96 of each entry
+function parseSummary(view, base) {
+  const firstDripMs = view.getUint32(base + 8, true);
+  return {
+    peakPressure: view.getUint16(base + 0, true) / PRESSURE_SCALE,
+    meanPressure: view.getUint16(base + 2, true) / PRESSURE_SCALE,
+    meanFlow: view.getInt16(base + 4, true) / FLOW_SCALE,
+    meanTempError: view.getInt16(base + 6, true) / TEMP_SCALE,
+    firstDrip: firstDripMs > 0 ? firstDripMs : null,
+    preinfusion: view.getUint32(base + 12, true),
+    waterPumped: view.getUint16(base + 16, true) / WEIGHT_SCALE,
+  };
+}
 
 function decodeCString(bytes) {
   let out = '';
@@ -75,6 +93,7 @@ export function parseBinaryIndex(arrayBuffer) {
 
     // Convert volume from scaled integer to float
     const volumeFloat = volume > 0 ? volume / WEIGHT_SCALE : null;
+    const summary = flags & SHOT_FLAG_HAS_SUMMARY ? parseSummary(view, base + 96) : null;
 
     entries.push({
       id,
@@ -85,6 +104,7 @@ export function parseBinaryIndex(arrayBuffer) {
       flags,
       profileId,
       profileName,
+      summary,
       // Computed flags
       completed: !!(flags & SHOT_FLAG_COMPLETED),
       deleted: !!(flags & SHOT_FLAG_DELETED),
@@ -123,6 +143,7 @@ export function indexToShotList(indexData) {
       volume: entry.volume,
       rating: entry.rating > 0 ? entry.rating : null, // Only include rating if > 0
       incomplete: entry.incomplete,
+      summary: entry.summary,
       notes: null,
       loaded: false,
       data: null,
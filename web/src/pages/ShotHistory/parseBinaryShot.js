@@ -1,11 +1,13 @@
 // Parser for .slog binary shot files
 // Mirrors shot_log_format.h (keep in sync)
 // Header: v4=128 bytes, v5+=512 bytes
+// Samples: fixed records up to v5, delta/varint encoded blocks from v6 (mirrors shot_log_codec.h)
 // Dynamic field parsing based on fieldsMask for future extensibility
 
 const HEADER_SIZE_V4 = 128;
 const HEADER_SIZE_V5 = 512;
 const MAGIC = 0x544f4853; // 'SHOT' - matches backend SHOT_LOG_MAGIC
+const BLOCK_HEADER_SIZE = 3; // payloadLength(uint16) + sampleCount(uint8), v6+
 
 const TEMP_SCALE = 10;
 const PRESSURE_SCALE = 10;
@@ -84,22 +86,99 @@ function countSetBits(n) {
   return count;
 }
 
+// Decode v6+ sample blocks into raw uint16 field arrays. Each block starts with a keyframe
+// (fields predicted as 0); later samples are predicted from the previous one with tick + 1.
+function decodeSampleBlocks(view, offset, fieldCount, maxSamples) {
+  const rawSamples = [];
+  let pos = offset;
+  let corrupt = false;
+
+  while (pos + BLOCK_HEADER_SIZE <= view.byteLength && rawSamples.length < maxSamples) {
+    const payloadLength = view.getUint16(pos, true);
+    const count = view.getUint8(pos + 2);
+    const end = pos + BLOCK_HEADER_SIZE + payloadLength;
+    if (count === 0 || end > view.byteLength) break; // partially written block
+
+    let p = pos + BLOCK_HEADER_SIZE;
+    const readVarint = () => {
+      let value = 0;
+      for (let shift = 0; shift < 35; shift += 7) {
+        if (p >= end) throw new Error('Truncated varint');
+        const byte = view.getUint8(p++);
+        value += (byte & 0x7f) * 2 ** shift;
+        if (!(byte & 0x80)) return value;
+      }
+      throw new Error('Varint too long');
+    };
+
+    try {
+      let previous = null;
+      for (let i = 0; i < count && rawSamples.length < maxSamples; i++) {
+        const fields = previous ? previous.slice() : new Array(fieldCount).fill(0);
+        if (previous) fields[0] = (fields[0] + 1) & 0xffff;
+        const mask = readVarint();
+        for (let f = 0; f < fieldCount; f++) {
+          if (mask & (1 << f)) {
+            const zigzag = readVarint();
+            const delta = zigzag & 1 ? -((zigzag + 1) / 2) : zigzag / 2;
+            fields[f] = (fields[f] + delta) & 0xffff;
+          }
+        }
+        rawSamples.push(fields);
+        previous = fields;
+      }
+    } catch {
+      corrupt = true;
+      break;
+    }
+    pos = end;
+  }
+
+  return { rawSamples, trailingBytes: view.byteLength - pos, corrupt };
+}
+
+// Read fixed-size sample records (v5 and earlier) into raw uint16 field arrays
+function readFixedSamples(view, offset, fieldCount, sampleSize, sampleCountHeader) {
+  const dataBytes = view.byteLength - offset;
+  if (dataBytes < 0) {
+    throw new Error('Data size misaligned');
+  }
+  const fullSampleBytes = Math.floor(dataBytes / sampleSize) * sampleSize;
+  const inferredSamples = fullSampleBytes / sampleSize;
+  const maxSamples = sampleCountHeader
+    ? Math.min(sampleCountHeader, inferredSamples)
+    : inferredSamples;
+
+  const rawSamples = [];
+  for (let i = 0; i < maxSamples; i++) {
+    const base = offset + i * sampleSize;
+    const fields = new Array(fieldCount);
+    for (let f = 0; f < fieldCount; f++) {
+      fields[f] = view.getUint16(base + f * 2, true); // Each field is 2 bytes
+    }
+    rawSamples.push(fields);
+  }
+
+  return { rawSamples, trailingBytes: dataBytes - fullSampleBytes, corrupt: false };
+}
+
 // Parse phase transitions from v5+ headers
-function parsePhaseTransitions(view, transitionCount) {
+function parsePhaseTransitions(view, transitionCount, version) {
   const transitions = [];
   const baseOffset = 110; // Offset after existing header fields
 
   for (let i = 0; i < transitionCount && i < 12; i++) {
     const offset = baseOffset + i * 29; // Each PhaseTransition is 29 bytes
 
-    const sampleIndex = view.getUint16(offset, true);
+    // v6+ stores the tick of the first sample of the phase, v5 its sample index
+    const position = view.getUint16(offset, true);
     const phaseNumber = view.getUint8(offset + 2);
     // Skip reserved byte at offset + 3
     const phaseNameBytes = new Uint8Array(view.buffer, view.byteOffset + offset + 4, 25);
     const phaseName = decodeCString(phaseNameBytes);
 
     transitions.push({
-      sampleIndex,
+      ...(version >= 6 ? { tick: position } : { sampleIndex: position }),
       phaseNumber,
       phaseName,
     });
@@ -159,7 +238,7 @@ export function parseBinaryShot(arrayBuffer, id) {
   let phaseTransitions = [];
   if (version >= 5) {
     const transitionCount = view.getUint8(110 + 12 * 29); // After 12 PhaseTransitions
-    phaseTransitions = parsePhaseTransitions(view, transitionCount);
+    phaseTransitions = parsePhaseTransitions(view, transitionCount, version);
   }
 
   // Calculate expected sample size from fieldsMask
@@ -194,32 +273,22 @@ export function parseBinaryShot(arrayBuffer, id) {
   }
 
   const samples = [];
-  const dataBytes = view.byteLength - headerSize;
-  if (dataBytes < 0) {
-    throw new Error('Data size misaligned');
-  }
-  const sampleSize = deviceSampleSize;
-  const fullSampleBytes = Math.floor(dataBytes / sampleSize) * sampleSize;
-  const trailingBytes = dataBytes - fullSampleBytes;
-  const inferredSamples = fullSampleBytes / sampleSize;
-  const maxSamples = sampleCountHeader
-    ? Math.min(sampleCountHeader, inferredSamples)
-    : inferredSamples;
+  const { rawSamples, trailingBytes, corrupt } =
+    version >= 6
+      ? decodeSampleBlocks(view, headerSize, fieldLayout.length, sampleCountHeader || Infinity)
+      : readFixedSamples(view, headerSize, fieldLayout.length, deviceSampleSize, sampleCountHeader);
 
-  for (let i = 0; i < maxSamples; i++) {
-    const base = headerSize + i * sampleSize;
+  for (let i = 0; i < rawSamples.length; i++) {
+    const fields = rawSamples[i];
     const sample = {};
 
     // Parse each field dynamically
     for (let fieldIdx = 0; fieldIdx < fieldLayout.length; fieldIdx++) {
       const field = fieldLayout[fieldIdx];
-      const offset = base + fieldIdx * 2; // Each field is 2 bytes
 
-      let rawValue;
-      if (field.type === 'int16') {
-        rawValue = view.getInt16(offset, true);
-      } else {
-        rawValue = view.getUint16(offset, true);
+      let rawValue = fields[fieldIdx];
+      if (field.type === 'int16' && rawValue > 0x7fff) {
+        rawValue -= 0x10000;
       }
 
       let finalValue;
@@ -241,7 +310,11 @@ export function parseBinaryShot(arrayBuffer, id) {
       let phaseName = 'Phase 1';
 
       for (let t = 0; t < phaseTransitions.length; t++) {
-        if (i >= phaseTransitions[t].sampleIndex) {
+        const reached =
+          version >= 6
+            ? sample.t >= phaseTransitions[t].tick * sampleInterval
+            : i >= phaseTransitions[t].sampleIndex;
+        if (reached) {
           currentPhase = phaseTransitions[t].phaseNumber;
           phaseName = phaseTransitions[t].phaseName;
         } else {
@@ -257,10 +330,22 @@ export function parseBinaryShot(arrayBuffer, id) {
     samples.push(sample);
   }
 
+  // Start of every phase in ms, v5 positions are looked up since samples are not evenly spaced
+  for (const transition of phaseTransitions) {
+    if (version >= 6) {
+      transition.t = transition.tick * sampleInterval;
+    } else {
+      const start = samples[Math.min(transition.sampleIndex, samples.length - 1)];
+      transition.t = start ? start.t : transition.sampleIndex * sampleInterval;
+    }
+  }
+
   const lastT = samples.length ? samples[samples.length - 1].t : 0;
   const headerIncomplete = sampleCountHeader === 0;
   const inferredIncomplete =
-    trailingBytes !== 0 || (sampleCountHeader && sampleCountHeader > inferredSamples);
+    corrupt ||
+    (version < 6 && trailingBytes !== 0) ||
+    (sampleCountHeader && sampleCountHeader > rawSamples.length);
   const incomplete = headerIncomplete || inferredIncomplete;
   const effectiveDuration = !incomplete && durationHeader ? durationHeader : lastT;
 